@@ -0,0 +1,1455 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "OwnedObject.h"
+#include "RBTree.h"
+#include "s21_vector.h"
+
+// A B-tree with the interface of RBTree, so the containers may be built on
+// either (see s21_btree.h). Every node keeps up to kSlots values in order in
+// one block of memory sized to a few cache lines, and an inner node also has
+// count + 1 children, the values of children[i] ordering between values
+// i - 1 and i of the node. A search so touches one block per level instead
+// of one node per comparison.
+//
+// Values are kept in the inner nodes as well, there are no key copies, so
+// any movable type may be stored; rebalancing moves values between nodes,
+// which is why insert and erase invalidate iterators and references to the
+// other elements, unlike in RBTree.
+template <typename Type, typename Allocator = std::allocator<Type>,
+          typename KeyOfValue = Identity, typename Compare = std::less<>>
+class BTree : private KeyCompare<Compare> {
+  using KeyCompare<Compare>::Comp;
+
+  static_assert(std::is_nothrow_move_constructible_v<Type>,
+                "values are moved between nodes while rebalancing");
+
+ public:
+  using KeyType = std::decay_t<std::invoke_result_t<KeyOfValue, const Type &>>;
+
+  // values per node: as many as fill kNodeBytes next to the links, a leaf
+  // takes exactly that much; an inner node adds the child pointers
+  static constexpr size_t kNodeBytes = 256;
+  static constexpr size_t kSlots = std::clamp<size_t>(
+      (kNodeBytes - 3 * sizeof(void *)) / sizeof(Type), 3, 255);
+  // a node below this many values is refilled from or merged with a sibling
+  static constexpr size_t kMinSlots = (kSlots - 1) / 2;
+
+ private:
+  struct Leaf {
+    Leaf() : parent(nullptr), size(0), position(0), count(0), leaf(true) {}
+
+    Leaf *parent;           // nullptr for the root
+    size_t size;            // values in the subtree
+    std::uint8_t position;  // index among the children of parent
+    std::uint8_t count;     // values in the node
+    bool leaf;
+    alignas(Type) unsigned char slots[kSlots * sizeof(Type)];
+  };
+
+  struct Inner : Leaf {
+    Inner() { this->leaf = false; }
+
+    Leaf *children[kSlots + 1];
+  };
+
+ public:
+  class BIterator {
+    friend class BTree;
+
+   public:
+    BIterator() = delete;
+    BIterator(Leaf *node, size_t pos) : node_(node), pos_(pos) {}
+    BIterator(const BIterator &iter) : node_(iter.node_), pos_(iter.pos_) {}
+
+   public:
+    Type &operator*() noexcept { return *Slot(node_, pos_); }
+    const Type &operator*() const noexcept { return *Slot(node_, pos_); }
+    Type *operator->() noexcept { return Slot(node_, pos_); }
+    const Type *operator->() const noexcept { return Slot(node_, pos_); }
+    void operator=(const BIterator &iter) const noexcept {
+      node_ = iter.node_;
+      pos_ = iter.pos_;
+    }
+    bool operator==(const BIterator &r) const noexcept {
+      return r.node_ == node_ && r.pos_ == pos_;
+    }
+    bool operator!=(const BIterator &r) const noexcept {
+      return !((*this) == r);
+    }
+    operator bool() const noexcept { return node_ && pos_ < node_->count; }
+
+    BIterator operator++(int) const {
+      BIterator res(*this);
+      ++(*this);
+
+      return res;
+    }
+
+    BIterator operator++() const {
+      if (node_) Next();
+
+      return *this;
+    }
+
+    BIterator operator--(int) const {
+      BIterator res(*this);
+      --(*this);
+
+      return res;
+    }
+
+    BIterator operator--() const {
+      if (node_) Prev();
+
+      return *this;
+    }
+
+   private:
+    // ++end() stays at end(), as RBIterator does
+    void Next() const {
+      if (!node_->leaf) {
+        node_ = Child(node_, pos_ + 1);
+        while (!node_->leaf) node_ = Child(node_, 0);
+        pos_ = 0;
+      } else if (++pos_ >= node_->count) {
+        Leaf *node = node_;
+        size_t pos = pos_;
+        while (pos >= node->count && node->parent) {
+          pos = node->position;
+          node = node->parent;
+        }
+        if (pos < node->count) {
+          node_ = node;
+          pos_ = pos;
+        } else  // past the last value
+          pos_ = node_->count;
+      }
+    }
+
+    // --begin() gives end(), as RBIterator does
+    void Prev() const {
+      if (!node_->leaf) {
+        node_ = Child(node_, pos_);
+        while (!node_->leaf) node_ = Child(node_, node_->count);
+        pos_ = node_->count - 1;
+      } else if (pos_)
+        --pos_;
+      else {
+        while (!pos_ && node_->parent) {
+          pos_ = node_->position;
+          node_ = node_->parent;
+        }
+        if (pos_)
+          --pos_;
+        else {  // before the first value, node_ is the root
+          while (!node_->leaf) node_ = Child(node_, node_->count);
+          pos_ = node_->count;
+        }
+      }
+    }
+
+    mutable Leaf *node_;
+    mutable size_t pos_;
+  };
+
+  using Iterator = BIterator;
+
+ public:
+  BTree() = default;
+  explicit BTree(const Allocator &alloc);
+  BTree(const Compare &comp, const Allocator &alloc);
+  ~BTree();
+  BTree(const BTree &m);
+
+ public:
+  void operator=(const BTree &m);
+  void operator=(BTree &&m);
+
+ public:
+  bool operator==(const BTree &m);
+  bool operator!=(const BTree &m);
+
+ public:
+  template <typename... Args>
+  s21::vector<std::pair<BIterator, bool>> insert_many(Args &&...args) {
+    s21::vector<std::pair<BIterator, bool>> result;
+    InsertManyRec(result, std::forward<Args>(args)...);
+    return result;
+  }
+
+ private:
+  template <typename T0, typename... Args>
+  void InsertManyRec(s21::vector<std::pair<BIterator, bool>> &vec, T0 &&v0,
+                     Args &&...args) {
+    // hinting with the successor of the previous value makes ascending
+    // arguments take the constant time path; as every insert invalidates
+    // iterators, only the last of the results stays usable
+    BIterator hint = vec.empty() ? end() : ++BIterator(vec.back().first);
+    vec.push_back(Insert(hint, Type(std::forward<T0>(v0))));
+    if constexpr (sizeof...(args) != 0)
+      InsertManyRec(vec, std::forward<Args>(args)...);
+  }
+
+ public:
+  template <typename V>
+  std::pair<BIterator, bool> Insert(V &&val);
+  template <typename V>
+  std::pair<BIterator, bool> InsertUnique(V &&val);
+  template <typename V>
+  std::pair<BIterator, bool> Insert(BIterator hint, V &&val);
+  template <typename V>
+  std::pair<BIterator, bool> InsertUnique(BIterator hint, V &&val);
+
+ public:
+  template <typename... Args>
+  std::pair<BIterator, bool> Emplace(Args &&...args);
+  template <typename... Args>
+  std::pair<BIterator, bool> EmplaceUnique(Args &&...args);
+  template <typename... Args>
+  std::pair<BIterator, bool> EmplaceHint(BIterator hint, Args &&...args);
+  template <typename... Args>
+  std::pair<BIterator, bool> EmplaceHintUnique(BIterator hint,
+                                               Args &&...args);
+
+ public:
+  void Erase(const Type &val);
+  void Erase(BIterator pos);
+  bool Empty() const noexcept;
+  size_t Size() const noexcept;
+  template <typename K>
+  bool Contains(const K &key) const;
+  template <typename K>
+  size_t Count(const K &key) const;
+  template <typename K>
+  BIterator Find(const K &key) const;
+  template <typename ForwardIt>
+  void FindMany(ForwardIt first, ForwardIt last,
+                s21::vector<BIterator> &out) const;
+  void Clear();
+  void Swap(BTree &other);
+  Allocator GetAllocator() const noexcept;
+  Compare GetCompare() const;
+
+ public:
+  template <typename InputIt, typename Same>
+  void AssignSorted(InputIt first, InputIt last, Same same);
+
+ public:
+  template <typename K>
+  void Split(const K &key, BTree &right);
+  void Join(BTree &other);
+
+ public:
+  // there are no nodes to hand over, so a value taken out by Extract is
+  // moved into a handle of its own
+  using NodeHandle = OwnedObject<Type, Allocator>;
+
+  NodeHandle Extract(BIterator pos);
+  std::pair<BIterator, bool> InsertNode(NodeHandle &node);
+  std::pair<BIterator, bool> InsertNodeUnique(NodeHandle &node);
+  std::pair<BIterator, bool> InsertNode(BIterator hint, NodeHandle &node);
+  std::pair<BIterator, bool> InsertNodeUnique(BIterator hint,
+                                              NodeHandle &node);
+  void Merge(BTree &other);
+  void MergeUnique(BTree &other);
+
+ public:
+  BIterator Nth(size_t k) const noexcept;
+  template <typename K>
+  size_t Rank(const K &key) const;
+  template <typename K>
+  size_t CountRange(const K &lo, const K &hi) const;
+
+ public:
+  template <typename K>
+  std::pair<BIterator, BIterator> equal_range(const K &key) const;
+  template <typename K>
+  BIterator lower_bound(const K &key) const;
+  template <typename K>
+  BIterator upper_bound(const K &key) const;
+
+ public:
+  BIterator begin() const;
+  BIterator end() const;
+
+ private:
+  using LeafAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Leaf>;
+  using InnerAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Inner>;
+
+  // what a search for K compares the keys of the values with
+  template <typename K>
+  using Probe =
+      std::conditional_t<IsTransparent<Compare>::value, K, KeyType>;
+
+  static Type *Slot(Leaf *node, size_t i) noexcept;
+  static Leaf *&Child(Leaf *node, size_t i) noexcept;
+  static const KeyType &KeyOf(Leaf *node, size_t i) noexcept;
+  static void Transfer(Type *dst, Type *src) noexcept;
+
+  template <typename K>
+  size_t LowerIndex(Leaf *node, const K &key) const;
+  template <typename K>
+  size_t UpperIndex(Leaf *node, const K &key) const;
+  size_t Index(Leaf *node, size_t pos) const noexcept;
+
+ private:
+  Leaf *NewLeaf();
+  Leaf *NewInner();
+  void FreeNode(Leaf *node) noexcept;
+  void DestroyNodes(Leaf *node) noexcept;
+  Leaf *Clone(Leaf *src, Leaf *parent);
+  void CopyFrom(const BTree &other);
+
+ private:
+  // the leaf slot a new value takes, unless a unique insert met an equal
+  // value, which is then at node and pos
+  struct InsertPos {
+    Leaf *node;
+    size_t pos;
+    bool equal;
+  };
+
+  InsertPos FindPos(const KeyType &key) const;
+  InsertPos FindUniquePos(const KeyType &key) const;
+  InsertPos FindHintPos(BIterator hint, const KeyType &key) const;
+  InsertPos FindUniqueHintPos(BIterator hint, const KeyType &key) const;
+  InsertPos LeafBefore(BIterator pos) const;
+  InsertPos EndPos() const noexcept;
+
+ private:
+  template <typename V>
+  std::pair<BIterator, bool> InsertAt(InsertPos pos, V &&val);
+  // how many times this tree may hold the values of the other one and
+  // still be merged with it in one walk over both, rather than by a
+  // search for each value of the other
+  static constexpr size_t kMergeRatio = 3;
+  template <bool kUnique>
+  void MergeValues(BTree &other);
+  void Split(Leaf *node, size_t pos);
+  void EraseAt(Leaf *node, size_t pos);
+  void Rebalance(Leaf *node);
+  void Merge(Leaf *left);
+  void MoveLeft(Leaf *left, size_t k);
+  void MoveRight(Leaf *left, size_t k);
+
+ private:
+  Allocator alloc_{};
+  Leaf *root_ = nullptr;
+  Leaf *leftmost_ = nullptr;
+  Leaf *rightmost_ = nullptr;
+};
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+BTree<Type, Allocator, KeyOfValue, Compare>::BTree(const Allocator &alloc)
+    : alloc_(alloc) {}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+BTree<Type, Allocator, KeyOfValue, Compare>::BTree(const Compare &comp,
+                                                   const Allocator &alloc)
+    : KeyCompare<Compare>(comp), alloc_(alloc) {}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+BTree<Type, Allocator, KeyOfValue, Compare>::~BTree() {
+  Clear();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+BTree<Type, Allocator, KeyOfValue, Compare>::BTree(const BTree &m)
+    : KeyCompare<Compare>(m.Comp()),
+      alloc_(std::allocator_traits<Allocator>::
+                 select_on_container_copy_construction(m.alloc_)) {
+  CopyFrom(m);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::operator=(const BTree &m) {
+  if (this != &m) {
+    Clear();
+    Comp() = m.Comp();
+    CopyFrom(m);
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::operator=(BTree &&m) {
+  if (this == &m) return;
+
+  Comp() = m.Comp();  // m stays usable, so it is not moved
+  Clear();
+  if (alloc_ == m.alloc_) {
+    root_ = std::exchange(m.root_, nullptr);
+    leftmost_ = std::exchange(m.leftmost_, nullptr);
+    rightmost_ = std::exchange(m.rightmost_, nullptr);
+  } else {  // nodes of a foreign allocator can not be adopted
+    for (auto it = m.begin(); it != m.end(); ++it) Insert(end(), *it);
+    m.Clear();
+  }
+}
+
+// trees are the same when they share the root, as in RBTree
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool BTree<Type, Allocator, KeyOfValue, Compare>::operator==(const BTree &m) {
+  return root_ == m.root_;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool BTree<Type, Allocator, KeyOfValue, Compare>::operator!=(const BTree &m) {
+  return root_ != m.root_;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Type *BTree<Type, Allocator, KeyOfValue, Compare>::Slot(Leaf *node,
+                                                        size_t i) noexcept {
+  return reinterpret_cast<Type *>(node->slots) + i;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::Leaf *&
+BTree<Type, Allocator, KeyOfValue, Compare>::Child(Leaf *node,
+                                                   size_t i) noexcept {
+  return static_cast<Inner *>(node)->children[i];
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+const typename BTree<Type, Allocator, KeyOfValue, Compare>::KeyType &
+BTree<Type, Allocator, KeyOfValue, Compare>::KeyOf(Leaf *node,
+                                                   size_t i) noexcept {
+  return KeyOfValue()(*Slot(node, i));
+}
+
+// moves the value at src to the free slot dst, leaving src free
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Transfer(Type *dst,
+                                                           Type *src) noexcept {
+  new (dst) Type(std::move(*src));
+  src->~Type();
+}
+
+// first slot of node not less than key
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::LowerIndex(
+    Leaf *node, const K &key) const {
+  size_t lo = 0;
+  size_t hi = node->count;
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (Comp()(KeyOf(node, mid), key))
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+
+  return lo;
+}
+
+// first slot of node greater than key
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::UpperIndex(
+    Leaf *node, const K &key) const {
+  size_t lo = 0;
+  size_t hi = node->count;
+
+  while (lo < hi) {
+    size_t mid = (lo + hi) / 2;
+    if (Comp()(key, KeyOf(node, mid)))
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return lo;
+}
+
+// in-order position of the value at pos of node, Size() for end()
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::Index(
+    Leaf *node, size_t pos) const noexcept {
+  if (!node) return 0;
+
+  size_t result = pos;
+  if (!node->leaf)
+    for (size_t i = 0; i <= pos; ++i) result += Child(node, i)->size;
+  for (; node->parent; node = node->parent) {
+    result += node->position;
+    for (size_t i = 0; i < node->position; ++i)
+      result += Child(node->parent, i)->size;
+  }
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::Leaf *
+BTree<Type, Allocator, KeyOfValue, Compare>::NewLeaf() {
+  LeafAllocator alloc(alloc_);
+
+  return new (std::allocator_traits<LeafAllocator>::allocate(alloc, 1)) Leaf;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::Leaf *
+BTree<Type, Allocator, KeyOfValue, Compare>::NewInner() {
+  InnerAllocator alloc(alloc_);
+
+  return new (std::allocator_traits<InnerAllocator>::allocate(alloc, 1)) Inner;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::FreeNode(
+    Leaf *node) noexcept {
+  if (node->leaf) {
+    LeafAllocator alloc(alloc_);
+    std::allocator_traits<LeafAllocator>::deallocate(alloc, node, 1);
+  } else {
+    InnerAllocator alloc(alloc_);
+    std::allocator_traits<InnerAllocator>::deallocate(
+        alloc, static_cast<Inner *>(node), 1);
+  }
+}
+
+// destroys the values of the subtree and frees its nodes; the children of
+// a partly built inner node that are not there yet are nullptr
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::DestroyNodes(
+    Leaf *node) noexcept {
+  if (!node->leaf)
+    for (size_t i = 0; i <= node->count; ++i)
+      if (Child(node, i)) DestroyNodes(Child(node, i));
+  if constexpr (!std::is_trivially_destructible_v<Type>)
+    for (size_t i = 0; i < node->count; ++i) Slot(node, i)->~Type();
+  FreeNode(node);
+}
+
+// copies the subtree src under parent without comparing any values; a
+// throwing copy frees what it has built
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::Leaf *
+BTree<Type, Allocator, KeyOfValue, Compare>::Clone(Leaf *src, Leaf *parent) {
+  Leaf *node = src->leaf ? NewLeaf() : NewInner();
+  node->parent = parent;
+  node->position = src->position;
+  node->size = src->size;
+
+  try {
+    if (!src->leaf)
+      for (size_t i = 0; i <= src->count; ++i) Child(node, i) = nullptr;
+    for (size_t i = 0; i < src->count; ++i) {
+      if (!src->leaf) Child(node, i) = Clone(Child(src, i), node);
+      new (Slot(node, i)) Type(*Slot(src, i));
+      node->count = static_cast<std::uint8_t>(i + 1);
+    }
+    if (!src->leaf)
+      Child(node, src->count) = Clone(Child(src, src->count), node);
+  } catch (...) {
+    DestroyNodes(node);
+    throw;
+  }
+
+  return node;
+}
+
+// this tree must be empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::CopyFrom(
+    const BTree &other) {
+  if (!other.root_) return;
+
+  root_ = Clone(other.root_, nullptr);
+  for (leftmost_ = root_; !leftmost_->leaf;) leftmost_ = Child(leftmost_, 0);
+  for (rightmost_ = root_; !rightmost_->leaf;)
+    rightmost_ = Child(rightmost_, rightmost_->count);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Clear() {
+  if (root_) DestroyNodes(root_);
+  root_ = leftmost_ = rightmost_ = nullptr;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Swap(BTree &other) {
+  std::swap(root_, other.root_);
+  std::swap(leftmost_, other.leftmost_);
+  std::swap(rightmost_, other.rightmost_);
+  std::swap(Comp(), other.Comp());
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Allocator
+BTree<Type, Allocator, KeyOfValue, Compare>::GetAllocator() const noexcept {
+  return alloc_;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Compare BTree<Type, Allocator, KeyOfValue, Compare>::GetCompare() const {
+  return Comp();
+}
+
+// inserts a copy or move of val after the values equal to it
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::Insert(V &&val) {
+  return InsertAt(FindPos(KeyOfValue()(val)), std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertUnique(V &&val) {
+  return InsertAt(FindUniquePos(KeyOfValue()(val)), std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::Insert(BIterator hint, V &&val) {
+  return InsertAt(FindHintPos(hint, KeyOfValue()(val)), std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertUnique(BIterator hint,
+                                                          V &&val) {
+  return InsertAt(FindUniqueHintPos(hint, KeyOfValue()(val)),
+                  std::forward<V>(val));
+}
+
+// the Emplace family builds the value from args first and then moves it
+// into its slot, as a value can not be made in a node before its place is
+// known
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::Emplace(Args &&...args) {
+  return Insert(Type(std::forward<Args>(args)...));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::EmplaceUnique(Args &&...args) {
+  return InsertUnique(Type(std::forward<Args>(args)...));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::EmplaceHint(BIterator hint,
+                                                         Args &&...args) {
+  return Insert(hint, Type(std::forward<Args>(args)...));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::EmplaceHintUnique(
+    BIterator hint, Args &&...args) {
+  return InsertUnique(hint, Type(std::forward<Args>(args)...));
+}
+
+// replaces the contents with the sorted range [first, last), skipping the
+// values for which same(previous, value) holds. Every value is appended
+// after the last one without a search, and the appends fill the nodes
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename InputIt, typename Same>
+void BTree<Type, Allocator, KeyOfValue, Compare>::AssignSorted(
+    InputIt first, InputIt last, Same same) {
+  Clear();
+
+  try {
+    for (; first != last; ++first)
+      if (!root_ || !same(*Slot(rightmost_, rightmost_->count - 1), *first))
+        InsertAt(EndPos(), *first);
+  } catch (...) {
+    Clear();
+    throw;
+  }
+}
+
+// Moves the values not ordered before key to right, which must be empty.
+// Values do not keep their nodes here, so they are moved one by one, each
+// appended to right and then erased from the end of this tree
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Split(const K &key,
+                                                        BTree &right) {
+  const size_t keep = Rank(key);
+
+  for (BIterator it = Nth(keep); it; ++it)
+    right.InsertAt(right.EndPos(), std::move(*it));
+  while (Size() > keep) Erase(--end());
+}
+
+// appends the values of other, which must all order after the values of
+// this tree or together with the last of them, and leaves other empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Join(BTree &other) {
+  if (this == &other) return;
+
+  for (BIterator it = other.begin(); it; ++it)
+    InsertAt(EndPos(), std::move(*it));
+  other.Clear();
+}
+
+// moves the value at pos into the returned handle and erases it
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::NodeHandle
+BTree<Type, Allocator, KeyOfValue, Compare>::Extract(BIterator pos) {
+  NodeHandle handle(GetAllocator(), std::move(*pos));
+  Erase(pos);
+
+  return handle;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertNode(NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<BIterator, bool> result = Insert(std::move(*node.Get()));
+  node.Reset();
+
+  return result;
+}
+
+// a value that is present already stays in the handle, as InsertUnique
+// only moves from a value it inserts
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertNodeUnique(
+    NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<BIterator, bool> result = InsertUnique(std::move(*node.Get()));
+  if (result.second) node.Reset();
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertNode(BIterator hint,
+                                                        NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<BIterator, bool> result = Insert(hint, std::move(*node.Get()));
+  node.Reset();
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertNodeUnique(
+    BIterator hint, NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<BIterator, bool> result =
+      InsertUnique(hint, std::move(*node.Get()));
+  if (result.second) node.Reset();
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Merge(BTree &other) {
+  MergeValues<false>(other);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::MergeUnique(BTree &other) {
+  MergeValues<true>(other);
+}
+
+// Moves the values of other that kUnique lets in, equal values after the
+// ones of this tree, and rebuilds other from the ones left, which stay in
+// order. Trees of comparable sizes are merged in one walk over both that
+// appends every value to one of two new trees, which then take the place
+// of the two, in O(n + m); otherwise each value of other is inserted with
+// a search. After a throwing move or allocation in the walk the values
+// not yet walked through are moved to the new trees as well, this tree's
+// after the merged ones and other's after the ones it keeps
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <bool kUnique>
+void BTree<Type, Allocator, KeyOfValue, Compare>::MergeValues(BTree &other) {
+  if (this == &other) return;
+  if (Empty() && GetAllocator() == other.GetAllocator()) {
+    Swap(other);
+    return;
+  }
+
+  BTree rest(other.Comp(), other.GetAllocator());
+  if (Size() > other.Size() * kMergeRatio) {
+    for (BIterator it = other.begin(); it; ++it) {
+      if constexpr (kUnique) {
+        if (!InsertUnique(std::move(*it)).second)
+          rest.InsertAt(rest.EndPos(), std::move(*it));
+      } else {
+        Insert(std::move(*it));
+      }
+    }
+    other.Swap(rest);
+    return;
+  }
+
+  BTree merged(Comp(), GetAllocator());
+  BIterator a = begin();
+  BIterator b = other.begin();
+  // after a throw the values not yet walked through stay in their trees
+  auto finish = [&](bool stopped) {
+    for (; a; ++a) merged.InsertAt(merged.EndPos(), std::move(*a));
+    BTree &tail = stopped ? rest : merged;
+    for (; b; ++b) tail.InsertAt(tail.EndPos(), std::move(*b));
+    Swap(merged);
+    other.Swap(rest);
+  };
+
+  try {
+    while (a && b) {
+      if (Comp()(KeyOfValue()(*b), KeyOfValue()(*a))) {
+        merged.InsertAt(merged.EndPos(), std::move(*b));
+        ++b;
+        continue;
+      }
+      if (kUnique && !Comp()(KeyOfValue()(*a), KeyOfValue()(*b))) {
+        rest.InsertAt(rest.EndPos(), std::move(*b));
+        ++b;
+      }
+      merged.InsertAt(merged.EndPos(), std::move(*a));
+      ++a;
+    }
+  } catch (...) {
+    finish(true);
+    throw;
+  }
+  finish(false);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+bool BTree<Type, Allocator, KeyOfValue, Compare>::Contains(
+    const K &key) const {
+  return Find(key) != end();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::Count(const K &key) const {
+  std::pair<BIterator, BIterator> range = equal_range(key);
+
+  return Index(range.second.node_, range.second.pos_) -
+         Index(range.first.node_, range.first.pos_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator
+BTree<Type, Allocator, KeyOfValue, Compare>::Find(const K &key) const {
+  const Probe<K> &probe = key;
+
+  for (Leaf *node = root_; node;) {
+    size_t i = LowerIndex(node, probe);
+    if (i < node->count && !Comp()(probe, KeyOf(node, i)))
+      return BIterator(node, i);
+    node = node->leaf ? nullptr : Child(node, i);
+  }
+
+  return end();
+}
+
+// Appends the result of Find for every key of [first, last), the first of
+// the equal values for a multiset: Find stops at the first node holding
+// the key, which may have more of them in the child on its left, so the
+// keys are searched as lower bounds instead.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename ForwardIt>
+void BTree<Type, Allocator, KeyOfValue, Compare>::FindMany(
+    ForwardIt first, ForwardIt last, s21::vector<BIterator> &out) const {
+  using K = std::decay_t<decltype(*first)>;
+
+  for (; first != last; ++first) {
+    const Probe<K> &probe = *first;
+    BIterator lower = lower_bound<Probe<K>>(probe);
+    out.push_back(lower && !Comp()(probe, KeyOf(lower.node_, lower.pos_))
+                      ? lower
+                      : end());
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Erase(const Type &val) {
+  BIterator pos = Find(KeyOfValue()(val));
+
+  if (pos) EraseAt(pos.node_, pos.pos_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Erase(BIterator pos) {
+  if (pos) EraseAt(pos.node_, pos.pos_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool BTree<Type, Allocator, KeyOfValue, Compare>::Empty() const noexcept {
+  return root_ == nullptr;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::Size() const noexcept {
+  return root_ ? root_->size : 0;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator
+BTree<Type, Allocator, KeyOfValue, Compare>::Nth(size_t k) const noexcept {
+  if (k >= Size()) return end();
+
+  Leaf *node = root_;
+  while (!node->leaf) {
+    size_t i = 0;
+    for (; i < node->count; ++i) {
+      size_t childSize = Child(node, i)->size;
+      if (k < childSize) break;
+      if (k == childSize) return BIterator(node, i);
+      k -= childSize + 1;
+    }
+    node = Child(node, i);
+  }
+
+  return BIterator(node, k);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::Rank(const K &key) const {
+  const Probe<K> &probe = key;
+  size_t result = 0;
+
+  for (Leaf *node = root_; node;) {
+    size_t i = LowerIndex(node, probe);
+    result += i;
+    if (node->leaf) break;
+    for (size_t j = 0; j < i; ++j) result += Child(node, j)->size;
+    node = Child(node, i);
+  }
+
+  return result;
+}
+
+// number of elements in [lo, hi)
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t BTree<Type, Allocator, KeyOfValue, Compare>::CountRange(
+    const K &lo, const K &hi) const {
+  size_t loRank = Rank(lo);
+  size_t hiRank = Rank(hi);
+
+  return hiRank > loRank ? hiRank - loRank : 0;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator>
+BTree<Type, Allocator, KeyOfValue, Compare>::equal_range(const K &key) const {
+  const Probe<K> &probe = key;
+
+  return {lower_bound<Probe<K>>(probe), upper_bound<Probe<K>>(probe)};
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator
+BTree<Type, Allocator, KeyOfValue, Compare>::lower_bound(const K &key) const {
+  const Probe<K> &probe = key;
+  BIterator result = end();
+
+  for (Leaf *node = root_; node;) {
+    size_t i = LowerIndex(node, probe);
+    if (i < node->count) result = BIterator(node, i);
+    node = node->leaf ? nullptr : Child(node, i);
+  }
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator
+BTree<Type, Allocator, KeyOfValue, Compare>::upper_bound(const K &key) const {
+  const Probe<K> &probe = key;
+  BIterator result = end();
+
+  for (Leaf *node = root_; node;) {
+    size_t i = UpperIndex(node, probe);
+    if (i < node->count) result = BIterator(node, i);
+    node = node->leaf ? nullptr : Child(node, i);
+  }
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator
+BTree<Type, Allocator, KeyOfValue, Compare>::begin() const {
+  return BIterator(leftmost_, 0);
+}
+
+// the slot past the last value of the rightmost leaf
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator
+BTree<Type, Allocator, KeyOfValue, Compare>::end() const {
+  return BIterator(rightmost_, rightmost_ ? rightmost_->count : 0);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+BTree<Type, Allocator, KeyOfValue, Compare>::FindPos(
+    const KeyType &key) const {
+  Leaf *node = root_;
+  if (!node) return {nullptr, 0, false};
+
+  for (;;) {
+    size_t i = UpperIndex(node, key);
+    if (node->leaf) return {node, i, false};
+    node = Child(node, i);
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+BTree<Type, Allocator, KeyOfValue, Compare>::FindUniquePos(
+    const KeyType &key) const {
+  Leaf *node = root_;
+  if (!node) return {nullptr, 0, false};
+
+  for (;;) {
+    size_t i = LowerIndex(node, key);
+    if (i < node->count && !Comp()(key, KeyOf(node, i))) return {node, i, true};
+    if (node->leaf) return {node, i, false};
+    node = Child(node, i);
+  }
+}
+
+// hint is the position the value is expected to precede; it is only
+// trusted when the value fits between hint and its predecessor
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+BTree<Type, Allocator, KeyOfValue, Compare>::FindHintPos(
+    BIterator hint, const KeyType &key) const {
+  if (hint == end()) {
+    if (root_ && !(Comp()(key, KeyOf(rightmost_, rightmost_->count - 1))))
+      return LeafBefore(hint);
+  } else if (!(Comp()(KeyOf(hint.node_, hint.pos_), key))) {
+    if (hint == begin()) return LeafBefore(hint);
+    BIterator before = --BIterator(hint);
+    if (!(Comp()(key, KeyOf(before.node_, before.pos_))))
+      return LeafBefore(hint);
+  } else {
+    BIterator after = ++BIterator(hint);
+    if (after == end() || !(Comp()(KeyOf(after.node_, after.pos_), key)))
+      return LeafBefore(after);
+  }
+
+  return FindPos(key);
+}
+
+// as FindHintPos, but stops at a value equal to key
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+BTree<Type, Allocator, KeyOfValue, Compare>::FindUniqueHintPos(
+    BIterator hint, const KeyType &key) const {
+  if (hint == end()) {
+    if (root_ && Comp()(KeyOf(rightmost_, rightmost_->count - 1), key))
+      return LeafBefore(hint);
+  } else if (Comp()(key, KeyOf(hint.node_, hint.pos_))) {
+    if (hint == begin()) return LeafBefore(hint);
+    BIterator before = --BIterator(hint);
+    if (Comp()(KeyOf(before.node_, before.pos_), key)) return LeafBefore(hint);
+  } else if (Comp()(KeyOf(hint.node_, hint.pos_), key)) {
+    BIterator after = ++BIterator(hint);
+    if (after == end() || Comp()(key, KeyOf(after.node_, after.pos_)))
+      return LeafBefore(after);
+  } else
+    return {hint.node_, hint.pos_, true};
+
+  return FindUniquePos(key);
+}
+
+// the slot after the last value, where a value ordering after all of
+// them is appended
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+BTree<Type, Allocator, KeyOfValue, Compare>::EndPos() const noexcept {
+  return root_ ? InsertPos{rightmost_, rightmost_->count, false}
+               : InsertPos{nullptr, 0, false};
+}
+
+// the leaf slot right before pos: pos itself in a leaf, otherwise the end
+// of the rightmost leaf under the child left of pos
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename BTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+BTree<Type, Allocator, KeyOfValue, Compare>::LeafBefore(BIterator pos) const {
+  if (pos.node_->leaf) return {pos.node_, pos.pos_, false};
+
+  Leaf *node = Child(pos.node_, pos.pos_);
+  while (!node->leaf) node = Child(node, node->count);
+
+  return {node, node->count, false};
+}
+
+// puts val in the leaf slot pos, splitting the full nodes on the way up
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename BTree<Type, Allocator, KeyOfValue, Compare>::BIterator,
+          bool>
+BTree<Type, Allocator, KeyOfValue, Compare>::InsertAt(InsertPos pos,
+                                                      V &&val) {
+  if (pos.equal) return {BIterator(pos.node, pos.pos), false};
+
+  if constexpr (!std::is_same_v<V, Type>) {
+    // val is made first: it may throw, or refer to a value about to move
+    return InsertAt(pos, Type(std::forward<V>(val)));
+  } else {
+    Leaf *node = pos.node;
+    size_t i = pos.pos;
+    if (!node)
+      node = root_ = leftmost_ = rightmost_ = NewLeaf();
+    else if (node->count == kSlots) {
+      Split(node, i);
+      if (i > node->count) {
+        i -= node->count + 1;
+        node = Child(node->parent, node->position + 1);
+      }
+    }
+
+    for (size_t j = node->count; j > i; --j)
+      Transfer(Slot(node, j), Slot(node, j - 1));
+    new (Slot(node, i)) Type(std::move(val));
+    ++node->count;
+    for (Leaf *up = node; up; up = up->parent) ++up->size;
+
+    return {BIterator(node, i), true};
+  }
+}
+
+// Splits the full node in two around a middle value that moves up into the
+// parent, splitting the parent first when it is full too. pos is where a
+// value is about to go; at either end of the node the split leaves that
+// side nearly empty, so that ascending or descending inserts fill the
+// nodes instead of leaving them half full.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Split(Leaf *node,
+                                                        size_t pos) {
+  if (node->parent && node->parent->count == kSlots)
+    Split(node->parent, node->position);
+
+  Leaf *sibling = node->leaf ? NewLeaf() : NewInner();
+  Leaf *parent = node->parent;
+  if (!parent) {  // the tree grows a level
+    try {
+      parent = NewInner();
+    } catch (...) {
+      FreeNode(sibling);
+      throw;
+    }
+    parent->size = node->size;
+    Child(parent, 0) = node;
+    node->parent = parent;
+    node->position = 0;
+    root_ = parent;
+  }
+
+  size_t count = node->count;
+  size_t mid = pos == count ? count - 1 : pos == 0 ? 0 : count / 2;
+  size_t moved = count - mid - 1;
+  for (size_t i = 0; i < moved; ++i)
+    Transfer(Slot(sibling, i), Slot(node, mid + 1 + i));
+  sibling->size = moved;
+  if (!node->leaf)
+    for (size_t i = 0; i <= moved; ++i) {
+      Leaf *child = Child(sibling, i) = Child(node, mid + 1 + i);
+      child->parent = sibling;
+      child->position = static_cast<std::uint8_t>(i);
+      sibling->size += child->size;
+    }
+  sibling->count = static_cast<std::uint8_t>(moved);
+  sibling->parent = parent;
+  node->count = static_cast<std::uint8_t>(mid);
+  node->size -= sibling->size + 1;
+
+  // the middle value goes up in front of the new sibling
+  size_t at = node->position;
+  for (size_t i = parent->count; i > at; --i)
+    Transfer(Slot(parent, i), Slot(parent, i - 1));
+  Transfer(Slot(parent, at), Slot(node, mid));
+  for (size_t i = parent->count + 1; i > at + 1; --i) {
+    Child(parent, i) = Child(parent, i - 1);
+    Child(parent, i)->position = static_cast<std::uint8_t>(i);
+  }
+  Child(parent, at + 1) = sibling;
+  sibling->position = static_cast<std::uint8_t>(at + 1);
+  ++parent->count;
+  if (node == rightmost_) rightmost_ = sibling;
+}
+
+// a value of an inner node is replaced by its predecessor, which always
+// lies in a leaf, so the slot is only ever removed from a leaf
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::EraseAt(Leaf *node,
+                                                          size_t pos) {
+  Slot(node, pos)->~Type();
+  if (!node->leaf) {
+    Leaf *leaf = Child(node, pos);
+    while (!leaf->leaf) leaf = Child(leaf, leaf->count);
+    Transfer(Slot(node, pos), Slot(leaf, leaf->count - 1));
+    node = leaf;
+    pos = leaf->count - 1;
+  }
+
+  for (size_t i = pos + 1; i < node->count; ++i)
+    Transfer(Slot(node, i - 1), Slot(node, i));
+  --node->count;
+  for (Leaf *up = node; up; up = up->parent) --up->size;
+
+  Rebalance(node);
+}
+
+// refills the nodes left below kMinSlots values from a sibling, or merges
+// them with one, up the tree; an empty root gives way to its only child
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Rebalance(Leaf *node) {
+  while (node != root_ && node->count < kMinSlots) {
+    Leaf *parent = node->parent;
+    size_t at = node->position;
+    Leaf *left = at ? Child(parent, at - 1) : nullptr;
+    Leaf *right = at < parent->count ? Child(parent, at + 1) : nullptr;
+
+    if (left && left->count + node->count < kSlots)
+      Merge(left);
+    else if (right && node->count + right->count < kSlots)
+      Merge(node);
+    else {
+      if (left && (!right || left->count >= right->count))
+        MoveRight(left, (left->count - node->count) / 2);
+      else
+        MoveLeft(node, (right->count - node->count) / 2);
+      break;
+    }
+    node = parent;
+  }
+
+  if (!root_->count) {
+    Leaf *old = root_;
+    if (old->leaf)
+      root_ = leftmost_ = rightmost_ = nullptr;
+    else {
+      root_ = Child(old, 0);
+      root_->parent = nullptr;
+      root_->position = 0;
+    }
+    FreeNode(old);
+  }
+}
+
+// moves the separating value of the parent and the right sibling of left
+// into left, then frees the sibling
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::Merge(Leaf *left) {
+  Leaf *parent = left->parent;
+  size_t at = left->position;
+  Leaf *right = Child(parent, at + 1);
+  size_t count = left->count;
+
+  Transfer(Slot(left, count), Slot(parent, at));
+  for (size_t i = 0; i < right->count; ++i)
+    Transfer(Slot(left, count + 1 + i), Slot(right, i));
+  if (!left->leaf)
+    for (size_t i = 0; i <= right->count; ++i) {
+      Leaf *child = Child(left, count + 1 + i) = Child(right, i);
+      child->parent = left;
+      child->position = static_cast<std::uint8_t>(count + 1 + i);
+    }
+  left->count = static_cast<std::uint8_t>(count + 1 + right->count);
+  left->size += right->size + 1;
+
+  for (size_t i = at + 1; i < parent->count; ++i)
+    Transfer(Slot(parent, i - 1), Slot(parent, i));
+  for (size_t i = at + 2; i <= parent->count; ++i) {
+    Child(parent, i - 1) = Child(parent, i);
+    Child(parent, i - 1)->position = static_cast<std::uint8_t>(i - 1);
+  }
+  --parent->count;
+
+  if (right == rightmost_) rightmost_ = left;
+  FreeNode(right);
+}
+
+// moves k values from the right sibling of left into left, rotating them
+// through the separating value of the parent
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::MoveLeft(Leaf *left,
+                                                           size_t k) {
+  Leaf *parent = left->parent;
+  size_t at = left->position;
+  Leaf *right = Child(parent, at + 1);
+  size_t count = left->count;
+  size_t moved = k;
+
+  Transfer(Slot(left, count), Slot(parent, at));
+  for (size_t i = 0; i + 1 < k; ++i)
+    Transfer(Slot(left, count + 1 + i), Slot(right, i));
+  Transfer(Slot(parent, at), Slot(right, k - 1));
+  for (size_t i = k; i < right->count; ++i)
+    Transfer(Slot(right, i - k), Slot(right, i));
+
+  if (!left->leaf) {
+    for (size_t i = 0; i < k; ++i) {
+      Leaf *child = Child(left, count + 1 + i) = Child(right, i);
+      child->parent = left;
+      child->position = static_cast<std::uint8_t>(count + 1 + i);
+      moved += child->size;
+    }
+    for (size_t i = k; i <= right->count; ++i) {
+      Child(right, i - k) = Child(right, i);
+      Child(right, i - k)->position = static_cast<std::uint8_t>(i - k);
+    }
+  }
+
+  left->count = static_cast<std::uint8_t>(count + k);
+  right->count = static_cast<std::uint8_t>(right->count - k);
+  left->size += moved;
+  right->size -= moved;
+}
+
+// moves k values from left into its right sibling, the mirror of MoveLeft
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void BTree<Type, Allocator, KeyOfValue, Compare>::MoveRight(Leaf *left,
+                                                            size_t k) {
+  Leaf *parent = left->parent;
+  size_t at = left->position;
+  Leaf *right = Child(parent, at + 1);
+  size_t count = left->count;
+  size_t moved = k;
+
+  for (size_t i = right->count; i > 0; --i)
+    Transfer(Slot(right, i - 1 + k), Slot(right, i - 1));
+  Transfer(Slot(right, k - 1), Slot(parent, at));
+  for (size_t i = 0; i + 1 < k; ++i)
+    Transfer(Slot(right, i), Slot(left, count - k + 1 + i));
+  Transfer(Slot(parent, at), Slot(left, count - k));
+
+  if (!left->leaf) {
+    for (size_t i = right->count + 1; i > 0; --i) {
+      Child(right, i - 1 + k) = Child(right, i - 1);
+      Child(right, i - 1 + k)->position = static_cast<std::uint8_t>(i - 1 + k);
+    }
+    for (size_t i = 0; i < k; ++i) {
+      Leaf *child = Child(right, i) = Child(left, count - k + 1 + i);
+      child->parent = right;
+      child->position = static_cast<std::uint8_t>(i);
+      moved += child->size;
+    }
+  }
+
+  left->count = static_cast<std::uint8_t>(count - k);
+  right->count = static_cast<std::uint8_t>(right->count + k);
+  left->size -= moved;
+  right->size += moved;
+}
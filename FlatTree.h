@@ -0,0 +1,817 @@
+#pragma once
+
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "OwnedObject.h"
+#include "RBTree.h"
+#include "s21_vector.h"
+
+// A sorted s21::vector with the interface of RBTree, for the flat
+// containers of s21_flat.h. Lookups are binary searches over contiguous
+// values, without a pointer to follow, and the order statistics are plain
+// indices; an insert or erase shifts the values after it, so the layout
+// suits read-mostly containers built in bulk with from_sorted or a sorted
+// range. Iterators are positions in the vector, any insert or erase
+// invalidates the iterators and references past it.
+template <typename Type, typename Allocator = std::allocator<Type>,
+          typename KeyOfValue = Identity, typename Compare = std::less<>>
+class FlatTree : private KeyCompare<Compare> {
+  using KeyCompare<Compare>::Comp;
+  using Values = s21::vector<Type, Allocator>;
+
+ public:
+  using KeyType = std::decay_t<std::invoke_result_t<KeyOfValue, const Type &>>;
+
+ public:
+  class FIterator {
+    friend class FlatTree;
+
+   public:
+    FIterator() = delete;
+    FIterator(Values *values, size_t pos) : values_(values), pos_(pos) {}
+    FIterator(const FIterator &iter) : values_(iter.values_), pos_(iter.pos_) {}
+
+   public:
+    Type &operator*() noexcept { return (*values_)[pos_]; }
+    const Type &operator*() const noexcept { return (*values_)[pos_]; }
+    Type *operator->() noexcept { return &(*values_)[pos_]; }
+    const Type *operator->() const noexcept { return &(*values_)[pos_]; }
+    void operator=(const FIterator &iter) const noexcept {
+      values_ = iter.values_;
+      pos_ = iter.pos_;
+    }
+    bool operator==(const FIterator &r) const noexcept {
+      return r.values_ == values_ && r.pos_ == pos_;
+    }
+    bool operator!=(const FIterator &r) const noexcept {
+      return !((*this) == r);
+    }
+    operator bool() const noexcept { return pos_ < values_->size(); }
+
+    FIterator operator++(int) const {
+      FIterator res(*this);
+      ++(*this);
+
+      return res;
+    }
+
+    // ++end() stays at end(), as RBIterator does
+    FIterator operator++() const {
+      if (pos_ < values_->size()) ++pos_;
+
+      return *this;
+    }
+
+    FIterator operator--(int) const {
+      FIterator res(*this);
+      --(*this);
+
+      return res;
+    }
+
+    // --begin() gives end(), as RBIterator does
+    FIterator operator--() const {
+      pos_ = pos_ ? pos_ - 1 : values_->size();
+
+      return *this;
+    }
+
+   private:
+    mutable Values *values_;
+    mutable size_t pos_;
+  };
+
+  using Iterator = FIterator;
+
+ public:
+  FlatTree() = default;
+  explicit FlatTree(const Allocator &alloc);
+  FlatTree(const Compare &comp, const Allocator &alloc);
+  FlatTree(const FlatTree &m) = default;
+
+ public:
+  void operator=(const FlatTree &m);
+  void operator=(FlatTree &&m);
+
+ public:
+  bool operator==(const FlatTree &m);
+  bool operator!=(const FlatTree &m);
+
+ public:
+  template <typename... Args>
+  s21::vector<std::pair<FIterator, bool>> insert_many(Args &&...args) {
+    s21::vector<std::pair<FIterator, bool>> result;
+    InsertManyRec(result, std::forward<Args>(args)...);
+    return result;
+  }
+
+ private:
+  template <typename T0, typename... Args>
+  void InsertManyRec(s21::vector<std::pair<FIterator, bool>> &vec, T0 &&v0,
+                     Args &&...args) {
+    // hinting with the successor of the previous value makes ascending
+    // arguments appends; as every insert shifts the values after it, the
+    // earlier results may no longer point at their values
+    FIterator hint = vec.empty() ? end() : ++FIterator(vec.back().first);
+    vec.push_back(Insert(hint, Type(std::forward<T0>(v0))));
+    if constexpr (sizeof...(args) != 0)
+      InsertManyRec(vec, std::forward<Args>(args)...);
+  }
+
+ public:
+  template <typename V>
+  std::pair<FIterator, bool> Insert(V &&val);
+  template <typename V>
+  std::pair<FIterator, bool> InsertUnique(V &&val);
+  template <typename V>
+  std::pair<FIterator, bool> Insert(FIterator hint, V &&val);
+  template <typename V>
+  std::pair<FIterator, bool> InsertUnique(FIterator hint, V &&val);
+
+ public:
+  template <typename... Args>
+  std::pair<FIterator, bool> Emplace(Args &&...args);
+  template <typename... Args>
+  std::pair<FIterator, bool> EmplaceUnique(Args &&...args);
+  template <typename... Args>
+  std::pair<FIterator, bool> EmplaceHint(FIterator hint, Args &&...args);
+  template <typename... Args>
+  std::pair<FIterator, bool> EmplaceHintUnique(FIterator hint,
+                                               Args &&...args);
+
+ public:
+  void Erase(const Type &val);
+  void Erase(FIterator pos);
+  bool Empty() const noexcept;
+  size_t Size() const noexcept;
+  template <typename K>
+  bool Contains(const K &key) const;
+  template <typename K>
+  size_t Count(const K &key) const;
+  template <typename K>
+  FIterator Find(const K &key) const;
+  template <typename ForwardIt>
+  void FindMany(ForwardIt first, ForwardIt last,
+                s21::vector<FIterator> &out) const;
+  void Clear();
+  void Swap(FlatTree &other);
+  Allocator GetAllocator() const noexcept;
+  Compare GetCompare() const;
+
+ public:
+  template <typename InputIt, typename Same>
+  void AssignSorted(InputIt first, InputIt last, Same same);
+
+ public:
+  template <typename K>
+  void Split(const K &key, FlatTree &right);
+  void Join(FlatTree &other);
+
+ public:
+  // there are no nodes to hand over, so a value taken out by Extract is
+  // moved into a handle of its own
+  using NodeHandle = OwnedObject<Type, Allocator>;
+
+  NodeHandle Extract(FIterator pos);
+  std::pair<FIterator, bool> InsertNode(NodeHandle &node);
+  std::pair<FIterator, bool> InsertNodeUnique(NodeHandle &node);
+  std::pair<FIterator, bool> InsertNode(FIterator hint, NodeHandle &node);
+  std::pair<FIterator, bool> InsertNodeUnique(FIterator hint,
+                                              NodeHandle &node);
+  void Merge(FlatTree &other);
+  void MergeUnique(FlatTree &other);
+
+ public:
+  FIterator Nth(size_t k) const noexcept;
+  template <typename K>
+  size_t Rank(const K &key) const;
+  template <typename K>
+  size_t CountRange(const K &lo, const K &hi) const;
+
+ public:
+  template <typename K>
+  std::pair<FIterator, FIterator> equal_range(const K &key) const;
+  template <typename K>
+  FIterator lower_bound(const K &key) const;
+  template <typename K>
+  FIterator upper_bound(const K &key) const;
+
+ public:
+  FIterator begin() const;
+  FIterator end() const;
+
+ private:
+  // what a search for K compares the keys of the values with
+  template <typename K>
+  using Probe =
+      std::conditional_t<IsTransparent<Compare>::value, K, KeyType>;
+
+  FIterator At(size_t pos) const noexcept;
+  const KeyType &KeyOf(size_t pos) const noexcept;
+  template <typename Before>
+  size_t PartitionPoint(Before before) const;
+  template <typename K>
+  size_t LowerIndex(const K &key) const;
+  template <typename K>
+  size_t UpperIndex(const K &key) const;
+
+ private:
+  // the index a new value takes, unless a unique insert met an equal value,
+  // which is then at pos
+  struct InsertPos {
+    size_t pos;
+    bool equal;
+  };
+
+  InsertPos FindUniquePos(const KeyType &key) const;
+  InsertPos FindHintPos(FIterator hint, const KeyType &key) const;
+  InsertPos FindUniqueHintPos(FIterator hint, const KeyType &key) const;
+  template <typename V>
+  std::pair<FIterator, bool> InsertAt(InsertPos pos, V &&val);
+  template <bool kUnique>
+  void MergeValues(FlatTree &other);
+
+ private:
+  Values values_;
+};
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::FlatTree(
+    const Allocator &alloc)
+    : values_(alloc) {}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::FlatTree(
+    const Compare &comp, const Allocator &alloc)
+    : KeyCompare<Compare>(comp), values_(alloc) {}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::operator=(
+    const FlatTree &m) {
+  if (this != &m) {
+    Comp() = m.Comp();
+    values_ = m.values_;
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::operator=(FlatTree &&m) {
+  if (this != &m) {
+    Comp() = m.Comp();  // m stays usable, so it is not moved
+    values_ = std::move(m.values_);
+  }
+}
+
+// trees are the same when they share the storage, as in RBTree
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool FlatTree<Type, Allocator, KeyOfValue, Compare>::operator==(
+    const FlatTree &m) {
+  return values_.data() == m.values_.data();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool FlatTree<Type, Allocator, KeyOfValue, Compare>::operator!=(
+    const FlatTree &m) {
+  return values_.data() != m.values_.data();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::At(
+    size_t pos) const noexcept {
+  return FIterator(const_cast<Values *>(&values_), pos);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+const typename FlatTree<Type, Allocator, KeyOfValue, Compare>::KeyType &
+FlatTree<Type, Allocator, KeyOfValue, Compare>::KeyOf(
+    size_t pos) const noexcept {
+  return KeyOfValue()(values_[pos]);
+}
+
+// Index of the first value for which before(key of the value) is false,
+// the values it holds for coming first. The halving loop has no branch on
+// the comparison, only a conditional add, so the processor never has to
+// guess the way and each probe depends on the previous one only through
+// the base.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename Before>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::PartitionPoint(
+    Before before) const {
+  size_t n = values_.size();
+  if (!n) return 0;
+
+  const Type *base = values_.data();
+  while (n > 1) {
+    size_t half = n / 2;
+    base += before(KeyOfValue()(base[half])) ? half : 0;
+    n -= half;
+  }
+
+  return static_cast<size_t>(base - values_.data()) +
+         before(KeyOfValue()(*base));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::LowerIndex(
+    const K &key) const {
+  return PartitionPoint(
+      [this, &key](const KeyType &value) { return Comp()(value, key); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::UpperIndex(
+    const K &key) const {
+  return PartitionPoint(
+      [this, &key](const KeyType &value) { return !Comp()(key, value); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Clear() {
+  values_.resize(0);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Swap(FlatTree &other) {
+  values_.swap(other.values_);
+  std::swap(Comp(), other.Comp());
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Allocator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::GetAllocator() const noexcept {
+  return values_.get_allocator();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Compare FlatTree<Type, Allocator, KeyOfValue, Compare>::GetCompare() const {
+  return Comp();
+}
+
+// inserts a copy or move of val after the values equal to it
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::Insert(V &&val) {
+  return InsertAt({UpperIndex(KeyOfValue()(val)), false},
+                  std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertUnique(V &&val) {
+  return InsertAt(FindUniquePos(KeyOfValue()(val)), std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::Insert(FIterator hint,
+                                                       V &&val) {
+  return InsertAt(FindHintPos(hint, KeyOfValue()(val)), std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertUnique(FIterator hint,
+                                                             V &&val) {
+  return InsertAt(FindUniqueHintPos(hint, KeyOfValue()(val)),
+                  std::forward<V>(val));
+}
+
+// the Emplace family builds the value from args first, its index is only
+// known from its key
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::Emplace(Args &&...args) {
+  return Insert(Type(std::forward<Args>(args)...));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::EmplaceUnique(
+    Args &&...args) {
+  return InsertUnique(Type(std::forward<Args>(args)...));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::EmplaceHint(FIterator hint,
+                                                            Args &&...args) {
+  return Insert(hint, Type(std::forward<Args>(args)...));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::EmplaceHintUnique(
+    FIterator hint, Args &&...args) {
+  return InsertUnique(hint, Type(std::forward<Args>(args)...));
+}
+
+// replaces the contents with the sorted range [first, last), skipping the
+// values for which same(previous, value) holds; every value is appended
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename InputIt, typename Same>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::AssignSorted(
+    InputIt first, InputIt last, Same same) {
+  using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+  Clear();
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>)
+    values_.reserve(static_cast<size_t>(std::distance(first, last)));
+  try {
+    for (; first != last; ++first)
+      if (values_.empty() || !same(values_.back(), *first))
+        values_.emplace_back(*first);
+  } catch (...) {
+    Clear();
+    throw;
+  }
+}
+
+// moves the values not ordered before key to right, which must be empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Split(const K &key,
+                                                           FlatTree &right) {
+  const Probe<K> &probe = key;
+  const size_t keep = LowerIndex(probe);
+
+  right.values_.reserve(values_.size() - keep);
+  for (size_t i = keep; i < values_.size(); ++i)
+    right.values_.push_back(std::move(values_[i]));
+  while (values_.size() > keep) values_.pop_back();
+}
+
+// appends the values of other, which must all order after the values of
+// this tree or together with the last of them, and leaves other empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Join(FlatTree &other) {
+  if (this == &other) return;
+
+  values_.reserve(values_.size() + other.values_.size());
+  for (Type &value : other.values_) values_.push_back(std::move(value));
+  other.Clear();
+}
+
+// moves the value at pos into the returned handle and erases it
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::NodeHandle
+FlatTree<Type, Allocator, KeyOfValue, Compare>::Extract(FIterator pos) {
+  NodeHandle handle(GetAllocator(), std::move(*pos));
+  Erase(pos);
+
+  return handle;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertNode(NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<FIterator, bool> result = Insert(std::move(*node.Get()));
+  node.Reset();
+
+  return result;
+}
+
+// a value that is present already stays in the handle, as InsertUnique
+// only moves from a value it inserts
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertNodeUnique(
+    NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<FIterator, bool> result = InsertUnique(std::move(*node.Get()));
+  if (result.second) node.Reset();
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertNode(FIterator hint,
+                                                           NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<FIterator, bool> result = Insert(hint, std::move(*node.Get()));
+  node.Reset();
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertNodeUnique(
+    FIterator hint, NodeHandle &node) {
+  if (node.Empty()) return {end(), false};
+  std::pair<FIterator, bool> result =
+      InsertUnique(hint, std::move(*node.Get()));
+  if (result.second) node.Reset();
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Merge(FlatTree &other) {
+  MergeValues<false>(other);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::MergeUnique(
+    FlatTree &other) {
+  MergeValues<true>(other);
+}
+
+// Merges the two sorted vectors in one pass into a new one, taking the
+// values of other that kUnique lets in; equal values of this tree come
+// first. The values left in other stay in order
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <bool kUnique>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::MergeValues(
+    FlatTree &other) {
+  if (this == &other) return;
+
+  Values merged(values_.get_allocator());
+  Values rest(other.values_.get_allocator());
+  merged.reserve(values_.size() + other.values_.size());
+  size_t i = 0;
+  for (Type &value : other.values_) {
+    const KeyType &key = KeyOfValue()(value);
+    while (i < values_.size() && Comp()(KeyOf(i), key))
+      merged.push_back(std::move(values_[i++]));
+    if constexpr (kUnique) {
+      if (i < values_.size() && !Comp()(key, KeyOf(i))) {
+        rest.push_back(std::move(value));
+        continue;
+      }
+    } else {
+      while (i < values_.size() && !Comp()(key, KeyOf(i)))
+        merged.push_back(std::move(values_[i++]));
+    }
+    merged.push_back(std::move(value));
+  }
+  for (; i < values_.size(); ++i) merged.push_back(std::move(values_[i]));
+
+  values_.swap(merged);
+  other.values_.swap(rest);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+bool FlatTree<Type, Allocator, KeyOfValue, Compare>::Contains(
+    const K &key) const {
+  return Find(key) != end();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::Count(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return UpperIndex(probe) - LowerIndex(probe);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::Find(const K &key) const {
+  const Probe<K> &probe = key;
+  size_t pos = LowerIndex(probe);
+
+  return pos < Size() && !Comp()(probe, KeyOf(pos)) ? At(pos) : end();
+}
+
+// appends the result of Find for every key of [first, last)
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename ForwardIt>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::FindMany(
+    ForwardIt first, ForwardIt last, s21::vector<FIterator> &out) const {
+  for (; first != last; ++first) out.push_back(Find(*first));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Erase(const Type &val) {
+  FIterator pos = Find(KeyOfValue()(val));
+
+  if (pos) Erase(pos);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void FlatTree<Type, Allocator, KeyOfValue, Compare>::Erase(FIterator pos) {
+  if (pos) values_.erase(values_.begin() + pos.pos_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool FlatTree<Type, Allocator, KeyOfValue, Compare>::Empty() const noexcept {
+  return values_.empty();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::Size() const noexcept {
+  return values_.size();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::Nth(size_t k) const noexcept {
+  return k < Size() ? At(k) : end();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::Rank(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return LowerIndex(probe);
+}
+
+// number of elements in [lo, hi)
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FlatTree<Type, Allocator, KeyOfValue, Compare>::CountRange(
+    const K &lo, const K &hi) const {
+  size_t loRank = Rank(lo);
+  size_t hiRank = Rank(hi);
+
+  return hiRank > loRank ? hiRank - loRank : 0;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::equal_range(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return {At(LowerIndex(probe)), At(UpperIndex(probe))};
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::lower_bound(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return At(LowerIndex(probe));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::upper_bound(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return At(UpperIndex(probe));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::begin() const {
+  return At(0);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator
+FlatTree<Type, Allocator, KeyOfValue, Compare>::end() const {
+  return At(Size());
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+FlatTree<Type, Allocator, KeyOfValue, Compare>::FindUniquePos(
+    const KeyType &key) const {
+  size_t pos = LowerIndex(key);
+
+  return {pos, pos < Size() && !Comp()(key, KeyOf(pos))};
+}
+
+// hint is the index the value is expected to take; it is only trusted
+// when the value fits between hint and its predecessor
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+FlatTree<Type, Allocator, KeyOfValue, Compare>::FindHintPos(
+    FIterator hint, const KeyType &key) const {
+  size_t pos = hint.pos_;
+
+  if ((pos == Size() || !Comp()(KeyOf(pos), key)) &&
+      (pos == 0 || !Comp()(key, KeyOf(pos - 1))))
+    return {pos, false};
+
+  return {UpperIndex(key), false};
+}
+
+// as FindHintPos, but stops at a value equal to key
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+FlatTree<Type, Allocator, KeyOfValue, Compare>::FindUniqueHintPos(
+    FIterator hint, const KeyType &key) const {
+  size_t pos = hint.pos_;
+
+  if (pos < Size() && !Comp()(key, KeyOf(pos)) && !Comp()(KeyOf(pos), key))
+    return {pos, true};
+  if ((pos == Size() || Comp()(key, KeyOf(pos))) &&
+      (pos == 0 || Comp()(KeyOf(pos - 1), key)))
+    return {pos, false};
+
+  return FindUniquePos(key);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename FlatTree<Type, Allocator, KeyOfValue, Compare>::FIterator,
+          bool>
+FlatTree<Type, Allocator, KeyOfValue, Compare>::InsertAt(InsertPos pos,
+                                                         V &&val) {
+  if (pos.equal) return {At(pos.pos), false};
+
+  if constexpr (!std::is_same_v<V, Type>) {
+    // val is made first: it may refer to a value about to be shifted
+    return InsertAt(pos, Type(std::forward<V>(val)));
+  } else {
+    values_.insert(values_.begin() + pos.pos, std::move(val));
+
+    return {At(pos.pos), true};
+  }
+}
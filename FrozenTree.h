@@ -0,0 +1,404 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "RBTree.h"
+#include "s21_vector.h"
+
+// An immutable snapshot of sorted values in the Eytzinger layout: the
+// implicit binary search tree stored in breadth-first order, with the
+// children of the value at position k (counting from 1) at 2k and 2k + 1.
+// The first levels of every search share the same few cache lines, a
+// descent computes the next position from the comparison instead of
+// branching on it, and the values a few levels down are prefetched while
+// the current one is compared, since they all sit next to each other.
+// Iterators walk the implicit tree in order, in O(1) amortized per step.
+template <typename Type, typename Allocator = std::allocator<Type>,
+          typename KeyOfValue = Identity, typename Compare = std::less<>>
+class FrozenTree : private KeyCompare<Compare> {
+  using KeyCompare<Compare>::Comp;
+
+ public:
+  using KeyType = std::decay_t<std::invoke_result_t<KeyOfValue, const Type &>>;
+
+ public:
+  class FrozenIterator {
+    friend class FrozenTree;
+
+   public:
+    FrozenIterator() = delete;
+    FrozenIterator(const Type *values, size_t size, size_t pos)
+        : values_(values), size_(size), pos_(pos) {}
+    FrozenIterator(const FrozenIterator &iter)
+        : values_(iter.values_), size_(iter.size_), pos_(iter.pos_) {}
+
+   public:
+    const Type &operator*() const noexcept { return values_[pos_ - 1]; }
+    const Type *operator->() const noexcept { return &values_[pos_ - 1]; }
+    void operator=(const FrozenIterator &iter) const noexcept {
+      values_ = iter.values_;
+      size_ = iter.size_;
+      pos_ = iter.pos_;
+    }
+    bool operator==(const FrozenIterator &r) const noexcept {
+      return r.values_ == values_ && r.pos_ == pos_;
+    }
+    bool operator!=(const FrozenIterator &r) const noexcept {
+      return !((*this) == r);
+    }
+    operator bool() const noexcept { return pos_ != 0; }
+
+    FrozenIterator operator++(int) const {
+      FrozenIterator res(*this);
+      ++(*this);
+
+      return res;
+    }
+
+    FrozenIterator operator++() const {
+      pos_ = Next(pos_, size_);
+
+      return *this;
+    }
+
+    FrozenIterator operator--(int) const {
+      FrozenIterator res(*this);
+      --(*this);
+
+      return res;
+    }
+
+    FrozenIterator operator--() const {
+      pos_ = Prev(pos_, size_);
+
+      return *this;
+    }
+
+   private:
+    mutable const Type *values_;
+    mutable size_t size_;
+    mutable size_t pos_;  // 0 is end()
+  };
+
+  using Iterator = FrozenIterator;
+
+ public:
+  FrozenTree() = default;
+  FrozenTree(const Compare &comp, const Allocator &alloc);
+
+ public:
+  template <typename ForwardIt>
+  void AssignSorted(ForwardIt first, ForwardIt last);
+
+ public:
+  bool Empty() const noexcept;
+  size_t Size() const noexcept;
+  template <typename K>
+  bool Contains(const K &key) const;
+  template <typename K>
+  size_t Count(const K &key) const;
+  template <typename K>
+  FrozenIterator Find(const K &key) const;
+  Allocator GetAllocator() const noexcept;
+  Compare GetCompare() const;
+
+ public:
+  template <typename K>
+  std::pair<FrozenIterator, FrozenIterator> equal_range(const K &key) const;
+  template <typename K>
+  FrozenIterator lower_bound(const K &key) const;
+  template <typename K>
+  FrozenIterator upper_bound(const K &key) const;
+
+ public:
+  FrozenIterator begin() const;
+  FrozenIterator end() const;
+
+ private:
+  template <typename K>
+  using Probe =
+      std::conditional_t<IsTransparent<Compare>::value, K, KeyType>;
+
+  // a descent prefetches the values this many times its position, which
+  // are the leftmost descendants as many levels down as one cache line
+  // holds values; at least the two children
+  static constexpr size_t kPrefetchStride = [] {
+    size_t stride = 2;
+    while (stride * 2 * sizeof(Type) <= 64) stride *= 2;
+    return stride;
+  }();
+
+  static size_t TrailingOnes(size_t pos) noexcept;
+  static size_t First(size_t size) noexcept;
+  static size_t Last(size_t size) noexcept;
+  static size_t Next(size_t pos, size_t size) noexcept;
+  static size_t Prev(size_t pos, size_t size) noexcept;
+
+  FrozenIterator At(size_t pos) const noexcept;
+  template <typename Before>
+  size_t Descend(Before before) const;
+  template <typename K>
+  size_t LowerPos(const K &key) const;
+  template <typename K>
+  size_t UpperPos(const K &key) const;
+
+ private:
+  s21::vector<Type, Allocator> values_;
+};
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenTree(
+    const Compare &comp, const Allocator &alloc)
+    : KeyCompare<Compare>(comp), values_(alloc) {}
+
+// Replaces the contents with the sorted range [first, last). The implicit
+// tree is walked in order next to the range to learn where every value
+// goes, then the values are copied in breadth-first order.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename ForwardIt>
+void FrozenTree<Type, Allocator, KeyOfValue, Compare>::AssignSorted(
+    ForwardIt first, ForwardIt last) {
+  using Source = decltype(std::addressof(*first));
+
+  size_t size = 0;
+  for (ForwardIt it = first; it != last; ++it) ++size;
+
+  s21::vector<Source> sources;
+  sources.resize(size);
+  for (size_t pos = First(size); pos; pos = Next(pos, size), ++first)
+    sources[pos - 1] = std::addressof(*first);
+
+  s21::vector<Type, Allocator> values(values_.get_allocator());
+  values.reserve(size);
+  for (Source source : sources) values.emplace_back(*source);
+  values_.swap(values);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool FrozenTree<Type, Allocator, KeyOfValue, Compare>::Empty() const noexcept {
+  return values_.empty();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::Size()
+    const noexcept {
+  return values_.size();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+bool FrozenTree<Type, Allocator, KeyOfValue, Compare>::Contains(
+    const K &key) const {
+  return Find(key) != end();
+}
+
+// O(log n + count), the equal values are walked
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::Count(
+    const K &key) const {
+  size_t count = 0;
+  auto range = equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) ++count;
+
+  return count;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::Find(const K &key) const {
+  const Probe<K> &probe = key;
+  size_t pos = LowerPos(probe);
+
+  return pos && !Comp()(probe, KeyOfValue()(values_[pos - 1])) ? At(pos)
+                                                               : end();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Allocator FrozenTree<Type, Allocator, KeyOfValue, Compare>::GetAllocator()
+    const noexcept {
+  return values_.get_allocator();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Compare FrozenTree<Type, Allocator, KeyOfValue, Compare>::GetCompare() const {
+  return Comp();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+std::pair<
+    typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator,
+    typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator>
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::equal_range(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return {At(LowerPos(probe)), At(UpperPos(probe))};
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::lower_bound(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return At(LowerPos(probe));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::upper_bound(
+    const K &key) const {
+  const Probe<K> &probe = key;
+
+  return At(UpperPos(probe));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::begin() const {
+  return At(First(Size()));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::end() const {
+  return At(0);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::TrailingOnes(
+    size_t pos) noexcept {
+#if defined(__GNUC__)
+  return static_cast<size_t>(
+      __builtin_ctzll(~static_cast<unsigned long long>(pos)));
+#else
+  size_t ones = 0;
+  for (; pos & 1; pos >>= 1) ++ones;
+  return ones;
+#endif
+}
+
+// the leftmost position, the smallest value
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::First(
+    size_t size) noexcept {
+  size_t pos = size ? 1 : 0;
+  while (pos && 2 * pos <= size) pos = 2 * pos;
+
+  return pos;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::Last(
+    size_t size) noexcept {
+  size_t pos = size ? 1 : 0;
+  while (pos && 2 * pos + 1 <= size) pos = 2 * pos + 1;
+
+  return pos;
+}
+
+// The in-order successor is the leftmost value of the right subtree, or
+// else the parent of the last ancestor reached as a left child: climbing
+// from right children drops the trailing ones of the position.
+// ++end() stays at end().
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::Next(
+    size_t pos, size_t size) noexcept {
+  if (!pos) return 0;
+  if (2 * pos + 1 <= size) {
+    pos = 2 * pos + 1;
+    while (2 * pos <= size) pos = 2 * pos;
+    return pos;
+  }
+
+  return pos >> (TrailingOnes(pos) + 1);
+}
+
+// mirrors Next, --end() is the last value and --begin() is end()
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::Prev(
+    size_t pos, size_t size) noexcept {
+  if (!pos) return Last(size);
+  if (2 * pos <= size) {
+    pos = 2 * pos;
+    while (2 * pos + 1 <= size) pos = 2 * pos + 1;
+    return pos;
+  }
+
+  return pos >> (TrailingOnes(~pos) + 1);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename FrozenTree<Type, Allocator, KeyOfValue, Compare>::FrozenIterator
+FrozenTree<Type, Allocator, KeyOfValue, Compare>::At(
+    size_t pos) const noexcept {
+  return FrozenIterator(values_.data(), Size(), pos);
+}
+
+// Position of the first value for which before(key of the value) is false,
+// or 0. The descent goes right whenever before holds and always runs to the
+// bottom; the answer is then the last node it left to the left, which the
+// trailing ones of the final position (the right turns since) undo.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename Before>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::Descend(
+    Before before) const {
+  const size_t size = Size();
+  const Type *values = values_.data();
+
+  size_t pos = 1;
+  while (pos <= size) {
+    Prefetch(values, (pos * kPrefetchStride - 1) * sizeof(Type));
+    pos = 2 * pos + before(KeyOfValue()(values[pos - 1]));
+  }
+
+  return pos >> (TrailingOnes(pos) + 1);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::LowerPos(
+    const K &key) const {
+  return Descend(
+      [this, &key](const KeyType &value) { return Comp()(value, key); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t FrozenTree<Type, Allocator, KeyOfValue, Compare>::UpperPos(
+    const K &key) const {
+  return Descend(
+      [this, &key](const KeyType &value) { return !Comp()(key, value); });
+}
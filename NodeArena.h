@@ -0,0 +1,280 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "OwnedObject.h"
+#include "s21_vector.h"
+
+// A NodeArena takes memory in chunks of whole pages that are aligned to
+// the page size, and every page starts with an ArenaPageHead, so the head
+// for an object is found by masking the object's address. The chunks
+// double from one page up to kArenaMaxChunkBytes, which keeps the first
+// chunk of a small tree small and the chunk table of a large one short
+// enough to stay in cache while searches resolve links through it.
+inline constexpr size_t kArenaPageBytes = size_t(1) << 12;
+inline constexpr unsigned kArenaOffsetBits = 16;  // 4-byte units in a chunk
+inline constexpr size_t kArenaMaxChunkBytes = size_t(4) << kArenaOffsetBits;
+
+// a 32-bit link: the chunk number above kArenaOffsetBits, the offset in the
+// chunk in 4-byte units below; the offsets 0 and 1 fall on the head of the
+// first page, so they are free to mean no object and the object outside
+// the arena
+inline constexpr std::uint32_t kArenaNull = 0;
+inline constexpr std::uint32_t kArenaOutside = 1;
+
+// The table of the chunk addresses of an arena by number, which turns a
+// link to an object in the arena back into its address.
+struct ArenaTable {
+  unsigned char *const *chunks;
+
+  void *Resolve(std::uint32_t link) const noexcept {
+    return chunks[link >> kArenaOffsetBits] +
+           (link & ((1U << kArenaOffsetBits) - 1)) * 4;
+  }
+};
+
+// The head of every arena page. It leads to the table of the arena, so
+// that a link is resolved knowing only the object it is stored in, and the
+// head of the first page keeps the one object linked from outside.
+struct ArenaPageHead {
+  unsigned char *const *chunks;
+  void *outside;
+  std::uint32_t number;  // of the chunk
+  std::uint32_t offset;  // of the page in the chunk, in 4-byte units
+
+  static const ArenaPageHead *Of(const void *obj) noexcept {
+    return reinterpret_cast<const ArenaPageHead *>(
+        reinterpret_cast<std::uintptr_t>(obj) & ~(kArenaPageBytes - 1));
+  }
+
+  static std::uint32_t LinkOf(const void *obj) noexcept {
+    std::uintptr_t offset =
+        reinterpret_cast<std::uintptr_t>(obj) & (kArenaPageBytes - 1);
+    const ArenaPageHead *head = Of(obj);
+    return head->number << kArenaOffsetBits |
+           (head->offset + static_cast<std::uint32_t>(offset >> 2));
+  }
+
+  void *Resolve(std::uint32_t link) const noexcept {
+    return ArenaTable{chunks}.Resolve(link);
+  }
+
+  ArenaPageHead *First() const noexcept {
+    return reinterpret_cast<ArenaPageHead *>(chunks[0]);
+  }
+};
+
+// NodePool counterpart for the S21_INDEX_NODES layout: the same interface,
+// but objects are carved from the pages of aligned chunks, after an
+// ArenaPageHead, and the number of chunks is bounded so that every link
+// fits in 31 bits, which is about 8 GiB of objects. Freed slots are reused
+// through a free list kept in the slots themselves.
+template <typename T, typename Allocator = std::allocator<T>>
+class NodeArena {
+  struct alignas(kArenaPageBytes) Page {
+    unsigned char bytes[kArenaPageBytes];
+  };
+
+  using PageAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Page>;
+  using PageTraits = std::allocator_traits<PageAllocator>;
+  using AddressAllocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<unsigned char *>;
+
+  static_assert(alignof(T) % 4 == 0,
+                "arena links count 4-byte units from a chunk");
+
+ public:
+  // links only resolve within the chunk table of one arena, which also
+  // keeps the single object linked from outside, so unlike a NodePool an
+  // arena never shares its chunks
+  static constexpr bool kCanShare = false;
+  // for the same reason an object leaves the arena for a hold by moving
+  using Hold = OwnedObject<T, Allocator>;
+
+ public:
+  NodeArena() = default;
+
+  explicit NodeArena(const Allocator &alloc)
+      : alloc_(alloc), chunks_(AddressAllocator(alloc)) {}
+
+  ~NodeArena() { Release(); }
+
+  NodeArena(const NodeArena &) = delete;
+  NodeArena &operator=(const NodeArena &) = delete;
+
+  NodeArena(NodeArena &&other) noexcept
+      : alloc_(other.alloc_), chunks_(AddressAllocator(other.alloc_)) {
+    Swap(other);
+  }
+
+  // other must use an equal allocator, the allocator itself is never replaced
+  NodeArena &operator=(NodeArena &&rhs) noexcept {
+    if (this != &rhs) {
+      Release();
+      Swap(rhs);
+    }
+    return *this;
+  }
+
+  template <typename... Args>
+  T *Create(Args &&...args) {
+    unsigned char *slot = Allocate();
+    try {
+      return new (slot) T(std::forward<Args>(args)...);
+    } catch (...) {
+      Deallocate(slot);
+      throw;
+    }
+  }
+
+  void Destroy(T *obj) noexcept {
+    obj->~T();
+    Deallocate(reinterpret_cast<unsigned char *>(obj));
+  }
+
+  // Moves obj, which the caller no longer links to, out of the arena into
+  // a hold; obj is left in place if that throws
+  Hold Keep(T *obj) {
+    Hold hold(GetAllocator(), std::move(*obj));
+    Destroy(obj);
+    return hold;
+  }
+
+  // moves the object of a hold into the arena and empties the hold
+  T *Adopt(Hold &hold) {
+    T *obj = Create(std::move(*hold.Get()));
+    hold.Reset();
+    return obj;
+  }
+
+  // Returns every chunk to the allocator without running destructors, the
+  // caller must have destroyed the live objects beforehand
+  void Release() noexcept {
+    for (size_t i = 0; i < chunks_.size(); ++i)
+      PageTraits::deallocate(alloc_, reinterpret_cast<Page *>(chunks_[i]),
+                             PagesIn(i));
+    chunks_.clear();
+    Rewind();
+  }
+
+  // Makes every slot available again while keeping the chunks, so the next
+  // allocations refill them in order; the live objects must be destroyed
+  void Rewind() noexcept {
+    freeList_ = next_ = end_ = page_ = chunkEnd_ = nullptr;
+    nextChunk_ = 0;
+  }
+
+  // exchanges the memory of two arenas with equal allocators; the page
+  // heads point into the address tables, which keep their storage
+  void Swap(NodeArena &other) noexcept {
+    chunks_.swap(other.chunks_);
+    std::swap(freeList_, other.freeList_);
+    std::swap(next_, other.next_);
+    std::swap(end_, other.end_);
+    std::swap(page_, other.page_);
+    std::swap(chunkEnd_, other.chunkEnd_);
+    std::swap(nextChunk_, other.nextChunk_);
+  }
+
+  // The table of the chunks, which resolves the links of the objects
+  // without a stop at their page heads; a Create() may move it
+  ArenaTable Table() const noexcept { return {chunks_.data()}; }
+
+  Allocator GetAllocator() const noexcept { return Allocator(alloc_); }
+
+ private:
+  unsigned char *Allocate() {
+    unsigned char *slot = freeList_;
+    if (slot)
+      std::memcpy(&freeList_, slot, sizeof(freeList_));
+    else {
+      if (next_ == end_) Grow();
+      slot = next_;
+      next_ += kSlotBytes;
+    }
+    return slot;
+  }
+
+  void Deallocate(unsigned char *slot) noexcept {
+    std::memcpy(slot, &freeList_, sizeof(freeList_));
+    freeList_ = slot;
+  }
+
+  // moves on to the next page, of the chunk being filled or of the next
+  void Grow() {
+    if (page_ == chunkEnd_) {
+      if (nextChunk_ == chunks_.size()) AddChunk();
+      page_ = chunks_[nextChunk_];
+      chunkEnd_ = page_ + PagesIn(nextChunk_) * kArenaPageBytes;
+      ++nextChunk_;
+    }
+    next_ = page_ + kFirstSlot;
+    end_ = next_ + kSlotsPerPage * kSlotBytes;
+    page_ += kArenaPageBytes;
+  }
+
+  void AddChunk() {
+    const size_t number = chunks_.size();
+    if (number == kMaxChunks)
+      throw std::length_error("NodeArena: 32-bit links exhausted");
+    const size_t pages = PagesIn(number);
+    unsigned char *chunk = reinterpret_cast<unsigned char *>(
+        PageTraits::allocate(alloc_, pages));
+    const unsigned char *const *table = chunks_.data();
+    try {
+      chunks_.push_back(chunk);
+    } catch (...) {
+      PageTraits::deallocate(alloc_, reinterpret_cast<Page *>(chunk), pages);
+      throw;
+    }
+
+    for (size_t page = 0; page < pages; ++page)
+      new (chunk + page * kArenaPageBytes) ArenaPageHead{
+          chunks_.data(), nullptr, static_cast<std::uint32_t>(number),
+          static_cast<std::uint32_t>(page * kArenaPageBytes / 4)};
+    if (chunks_.data() != table)  // the table moved
+      for (size_t i = 0; i < number; ++i)
+        for (size_t page = 0; page < PagesIn(i); ++page)
+          reinterpret_cast<ArenaPageHead *>(chunks_[i] +
+                                            page * kArenaPageBytes)
+              ->chunks = chunks_.data();
+  }
+
+  static constexpr size_t kMaxChunkPages =
+      kArenaMaxChunkBytes / kArenaPageBytes;
+
+  // the pages of the chunk of that number, which double up to the largest
+  static constexpr size_t PagesIn(size_t number) noexcept {
+    for (size_t pages = 1; pages < kMaxChunkPages; pages *= 2, --number)
+      if (!number) return pages;
+    return kMaxChunkPages;
+  }
+
+  // a slot must hold the free list link between its lives as a T
+  static constexpr size_t kSlotBytes =
+      sizeof(T) >= sizeof(unsigned char *)
+          ? sizeof(T)
+          : (sizeof(unsigned char *) + alignof(T) - 1) / alignof(T) *
+                alignof(T);
+  static constexpr size_t kFirstSlot =
+      (sizeof(ArenaPageHead) + alignof(T) - 1) / alignof(T) * alignof(T);
+  static constexpr size_t kSlotsPerPage =
+      (kArenaPageBytes - kFirstSlot) / kSlotBytes;
+  static constexpr size_t kMaxChunks = size_t(1) << (31 - kArenaOffsetBits);
+
+  PageAllocator alloc_;
+  s21::vector<unsigned char *, AddressAllocator> chunks_;
+  unsigned char *freeList_ = nullptr;
+  unsigned char *next_ = nullptr;
+  unsigned char *end_ = nullptr;
+  unsigned char *page_ = nullptr;  // the next page of the chunk being filled
+  unsigned char *chunkEnd_ = nullptr;
+  size_t nextChunk_ = 0;
+};
@@ -0,0 +1,476 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "s21_vector.h"
+
+// Fixed-size allocator for tree nodes. Memory is taken from Allocator in
+// chunks that double in size up to kMaxChunkSlots, freed slots are kept in
+// intrusive free lists for reuse, and Release() returns all chunks at once.
+//
+// A chunk may be held by several pools after Share(), so that trees can
+// hand their nodes to each other, and by the holds of single objects taken
+// out of a pool by Keep(); the first slot of every chunk counts its
+// holders, and the last one to release the chunk returns it. The chunks of
+// a pool are kept sorted by address, which is how Keep() and Divide() find
+// the chunk of an object. Pools that share chunks keep free slots of their
+// own: a pool taking over the objects of another takes its free slots too
+// (TakeOver()), and a pool that takes a few of the objects of another
+// shares only the chunks they are in and takes a few free slots along,
+// while one that takes many shares every chunk (Divide()).
+template <typename T, typename Allocator = std::allocator<T>>
+class NodePool {
+  union Slot {
+    Slot *next;
+    alignas(T) unsigned char storage[sizeof(T)];
+  };
+
+  struct FreeList {
+    Slot *head = nullptr;
+    Slot *tail = nullptr;  // only meaningful while head is set
+    size_t count = 0;
+
+    void Push(Slot *slot) noexcept {
+      slot->next = head;
+      if (!head) tail = slot;
+      head = slot;
+      ++count;
+    }
+
+    Slot *Pop() noexcept {
+      Slot *slot = head;
+      head = slot->next;
+      --count;
+      return slot;
+    }
+
+    // puts the slots of other in front of these and empties other
+    void Splice(FreeList &other) noexcept {
+      if (!other.head) return;
+      other.tail->next = head;
+      if (!head) tail = other.tail;
+      head = other.head;
+      count += other.count;
+      other = FreeList();
+    }
+  };
+
+  struct Chunk {
+    Slot *slots;
+    size_t count;
+  };
+
+  using SlotAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Slot>;
+  using SlotTraits = std::allocator_traits<SlotAllocator>;
+  using ChunkAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Chunk>;
+  using Holders = std::atomic<size_t>;
+
+  // The slots of the objects holds destroy go back to their pool through
+  // a box of the pool that its holds share, so the box outlives whichever
+  // of them goes first and is freed by the last
+  struct Returns {
+    std::atomic<size_t> holders;
+    std::atomic<Slot *> slots;
+  };
+
+  using ReturnsAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<Returns>;
+  using ReturnsTraits = std::allocator_traits<ReturnsAllocator>;
+
+  static_assert(sizeof(Holders) <= sizeof(Slot) &&
+                    alignof(Holders) <= alignof(Slot),
+                "the holder count takes the first slot of a chunk");
+
+ public:
+  static constexpr bool kCanShare = true;
+
+  // Owns one object of a pool apart from the pool, holding its chunk, so
+  // it may outlive the pool. The object goes to a pool with an equal
+  // allocator through Adopt(), or is destroyed with the hold, its slot
+  // then going back to its pool
+  class Hold {
+   public:
+    Hold() = default;
+    Hold(Hold &&other) noexcept { Take(other); }
+
+    Hold &operator=(Hold &&other) noexcept {
+      if (this != &other) {
+        Reset();
+        Take(other);
+      }
+      return *this;
+    }
+
+    ~Hold() { Reset(); }
+
+    T *Get() const noexcept { return obj_; }
+    bool Empty() const noexcept { return !obj_; }
+    Allocator GetAllocator() const { return Allocator(*alloc_); }
+
+    void Reset() noexcept {
+      if (!obj_) return;
+      obj_->~T();
+      Slot *slot = reinterpret_cast<Slot *>(obj_);
+      slot->next = returns_->slots.load(std::memory_order_relaxed);
+      while (!returns_->slots.compare_exchange_weak(
+          slot->next, slot, std::memory_order_release,
+          std::memory_order_relaxed)) {
+      }
+      Drop(returns_, *alloc_);
+      Drop(chunk_, *alloc_);
+      obj_ = nullptr;
+    }
+
+   private:
+    friend class NodePool;
+
+    // the allocator is rebuilt rather than assigned, as a pmr allocator
+    // can not be
+    void Take(Hold &other) noexcept {
+      obj_ = std::exchange(other.obj_, nullptr);
+      chunk_ = other.chunk_;
+      returns_ = other.returns_;
+      alloc_.reset();
+      if (other.alloc_) alloc_.emplace(*other.alloc_);
+    }
+
+    T *obj_ = nullptr;
+    Chunk chunk_{};
+    Returns *returns_ = nullptr;
+    std::optional<SlotAllocator> alloc_;
+  };
+
+ public:
+  NodePool() = default;
+
+  explicit NodePool(const Allocator &alloc)
+      : alloc_(alloc), chunks_(ChunkAllocator(alloc)) {}
+
+  ~NodePool() { Release(); }
+
+  NodePool(const NodePool &) = delete;
+  NodePool &operator=(const NodePool &) = delete;
+
+  NodePool(NodePool &&other) noexcept
+      : alloc_(other.alloc_), chunks_(ChunkAllocator(other.alloc_)) {
+    Swap(other);
+  }
+
+  // other must use an equal allocator, the allocator itself is never replaced
+  NodePool &operator=(NodePool &&rhs) noexcept {
+    if (this != &rhs) {
+      Release();
+      Swap(rhs);
+    }
+    return *this;
+  }
+
+  template <typename... Args>
+  T *Create(Args &&...args) {
+    Slot *slot = Allocate();
+    try {
+      return new (slot->storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      Deallocate(slot);
+      throw;
+    }
+  }
+
+  void Destroy(T *obj) noexcept {
+    obj->~T();
+    Deallocate(reinterpret_cast<Slot *>(obj));
+  }
+
+  // Lets go of every chunk without running destructors, returning those no
+  // other pool holds to the allocator; the caller must have destroyed the
+  // live objects of this pool beforehand
+  void Release() noexcept {
+    for (Chunk &chunk : chunks_) Drop(chunk, alloc_);
+    chunks_.clear();
+    DetachReturns();
+    free_[0] = free_[1] = FreeList();
+    next_ = end_ = nullptr;
+    nextChunk_ = 0;
+    nextChunkSlots_ = kMinChunkSlots;
+  }
+
+  // Makes every slot available again while keeping the chunks, so the next
+  // allocations refill them in order; the live objects must be destroyed.
+  // Chunks shared with another pool may still hold its objects, so then
+  // everything is released instead
+  void Rewind() noexcept {
+    for (Chunk &chunk : chunks_)
+      if (HoldersOf(chunk).load(std::memory_order_acquire) != 1) {
+        Release();
+        return;
+      }
+    DetachReturns();
+    free_[0] = free_[1] = FreeList();
+    next_ = end_ = nullptr;
+    nextChunk_ = 0;
+  }
+
+  // exchanges the memory of two pools with equal allocators
+  void Swap(NodePool &other) noexcept {
+    chunks_.swap(other.chunks_);
+    std::swap(free_, other.free_);
+    std::swap(next_, other.next_);
+    std::swap(end_, other.end_);
+    std::swap(nextChunk_, other.nextChunk_);
+    std::swap(nextChunkSlots_, other.nextChunkSlots_);
+    std::swap(returns_, other.returns_);
+  }
+
+  // Makes this pool a holder of the chunks of other too, after which the
+  // objects of other may be destroyed through this pool. The free slots of
+  // other stay with it, and other must use an equal allocator
+  void Share(const NodePool &other) {
+    FreeLeftovers();
+    const size_t held = chunks_.size();
+    chunks_.reserve(held + other.chunks_.size());
+    for (const Chunk &chunk : other.chunks_)
+      if (!std::binary_search(chunks_.begin(), chunks_.begin() + held, chunk,
+                              ByAddress)) {
+        HoldersOf(chunk).fetch_add(1, std::memory_order_relaxed);
+        chunks_.push_back(chunk);
+      }
+    std::inplace_merge(chunks_.begin(), chunks_.begin() + held, chunks_.end(),
+                       ByAddress);
+    nextChunk_ = chunks_.size();  // none is left over for Grow() to refill
+  }
+
+  // Takes the free slots of other, the rest of the chunk it was filling
+  // included, and releases it; this pool must share the chunks of other,
+  // whose objects all belong to it by then
+  void TakeOver(NodePool &other) noexcept {
+    other.FreeLeftovers();
+    if (other.returns_) other.CollectReturns();
+    const bool longer = other.free_[1].count > other.free_[0].count;
+    const bool shorter = free_[1].count < free_[0].count;
+    free_[shorter].Splice(other.free_[longer]);
+    free_[!shorter].Splice(other.free_[!longer]);
+    if (next_ == end_) {
+      next_ = std::exchange(other.next_, nullptr);
+      end_ = std::exchange(other.end_, nullptr);
+    }
+    for (; other.next_ != other.end_; ++other.next_) Deallocate(other.next_);
+    other.Release();
+  }
+
+  // Takes over the count objects of other that visit(fn) passes to fn.
+  // When they are fewer than the chunks of other, this pool becomes a
+  // holder of just the chunks they are in and takes as many free slots of
+  // other along, kMinChunkSlots at least but no more than half, with their
+  // chunks, in O(k log k + k log c) for k objects and the c chunks of
+  // other; the chunks that hold none of them stay with other alone.
+  // Otherwise walking the objects would cost more than the chunks, so this
+  // pool shares them all as Share() does and takes the longer free list
+  // of other, without calling visit
+  template <typename VisitFn>
+  void Divide(NodePool &other, size_t count, VisitFn visit) {
+    if (count >= other.chunks_.size()) {
+      Share(other);
+      const bool longer = other.free_[1].count > other.free_[0].count;
+      const bool shorter = free_[1].count < free_[0].count;
+      free_[shorter].Splice(other.free_[longer]);
+      return;
+    }
+
+    FreeLeftovers();
+    const size_t held = chunks_.size();
+    // objects next to each other in a walk are mostly in the same chunk
+    auto add = [&](const Slot *slot) {
+      const Chunk &chunk = other.ChunkOf(slot);
+      if (chunks_.size() == held || chunks_.back().slots != chunk.slots)
+        chunks_.push_back(chunk);
+    };
+    FreeList &list = other.free_[other.free_[1].count > other.free_[0].count];
+    size_t spare = kMinChunkSlots;
+    try {
+      visit([&](const T *obj) { add(reinterpret_cast<const Slot *>(obj)); });
+      spare = std::min(std::max(count, spare),
+                       (other.free_[0].count + other.free_[1].count) / 2);
+      const Slot *slot = list.head;
+      for (size_t i = 0; i < spare; ++i, slot = slot->next) add(slot);
+    } catch (...) {
+      chunks_.resize(held);
+      throw;
+    }
+
+    Chunk *const first = chunks_.begin() + held;
+    std::sort(first, chunks_.end(), ByAddress);
+    Chunk *last = std::unique(first, chunks_.end(),
+                              [](const Chunk &a, const Chunk &b) {
+                                return a.slots == b.slots;
+                              });
+    last = std::remove_if(first, last, [&](const Chunk &chunk) {
+      return std::binary_search(chunks_.begin(), first, chunk, ByAddress);
+    });
+    for (Chunk *chunk = first; chunk != last; ++chunk)
+      HoldersOf(*chunk).fetch_add(1, std::memory_order_relaxed);
+    chunks_.resize(last - chunks_.begin());
+    std::inplace_merge(chunks_.begin(), chunks_.begin() + held, chunks_.end(),
+                       ByAddress);
+    nextChunk_ = chunks_.size();
+    while (spare--) Deallocate(list.Pop());
+  }
+
+  // Moves obj, which the caller no longer links to, out of the pool into a
+  // hold; obj is left in place if that throws
+  Hold Keep(T *obj) {
+    if (!returns_) {
+      ReturnsAllocator alloc(alloc_);
+      returns_ = ReturnsTraits::allocate(alloc, 1);
+      new (returns_) Returns{{1}, {nullptr}};
+    }
+
+    const Chunk &chunk = ChunkOf(reinterpret_cast<Slot *>(obj));
+    HoldersOf(chunk).fetch_add(1, std::memory_order_relaxed);
+    returns_->holders.fetch_add(1, std::memory_order_relaxed);
+
+    Hold hold;
+    hold.obj_ = obj;
+    hold.chunk_ = chunk;
+    hold.returns_ = returns_;
+    hold.alloc_.emplace(alloc_);
+    return hold;
+  }
+
+  // Makes the object of a hold of a pool with an equal allocator one of
+  // this pool, which becomes a holder of its chunk, and empties the hold
+  T *Adopt(Hold &hold) {
+    FreeLeftovers();
+    Chunk *pos = std::lower_bound(chunks_.begin(), chunks_.end(), hold.chunk_,
+                                  ByAddress);
+    if (pos != chunks_.end() && pos->slots == hold.chunk_.slots)
+      HoldersOf(hold.chunk_).fetch_sub(1, std::memory_order_relaxed);
+    else {
+      const size_t at = pos - chunks_.begin();
+      chunks_.push_back(hold.chunk_);
+      std::rotate(chunks_.begin() + at, chunks_.end() - 1, chunks_.end());
+      nextChunk_ = chunks_.size();
+    }
+    Drop(hold.returns_, alloc_);
+
+    return std::exchange(hold.obj_, nullptr);
+  }
+
+  Allocator GetAllocator() const noexcept { return Allocator(alloc_); }
+
+ private:
+  static Holders &HoldersOf(const Chunk &chunk) noexcept {
+    return *std::launder(reinterpret_cast<Holders *>(chunk.slots->storage));
+  }
+
+  static bool ByAddress(const Chunk &a, const Chunk &b) noexcept {
+    return a.slots < b.slots;
+  }
+
+  // the chunk of this pool that slot is in
+  const Chunk &ChunkOf(const Slot *slot) const noexcept {
+    return *std::prev(std::upper_bound(
+        chunks_.begin(), chunks_.end(), slot,
+        [](const Slot *slot, const Chunk &chunk) {
+          return slot < chunk.slots;
+        }));
+  }
+
+  static void Drop(const Chunk &chunk, SlotAllocator &alloc) noexcept {
+    if (HoldersOf(chunk).fetch_sub(1, std::memory_order_acq_rel) == 1)
+      SlotTraits::deallocate(alloc, chunk.slots, chunk.count);
+  }
+
+  static void Drop(Returns *returns, const SlotAllocator &alloc) noexcept {
+    if (returns->holders.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      ReturnsAllocator returnsAlloc(alloc);
+      returns->~Returns();
+      ReturnsTraits::deallocate(returnsAlloc, returns, 1);
+    }
+  }
+
+  // the slots returned so far are dropped with the chunks they are in
+  void DetachReturns() noexcept {
+    if (returns_) Drop(returns_, alloc_);
+    returns_ = nullptr;
+  }
+
+  // moves the slots holds have given back onto the free lists
+  void CollectReturns() noexcept {
+    Slot *slot = returns_->slots.exchange(nullptr, std::memory_order_acquire);
+    while (slot) {
+      Slot *next = slot->next;
+      Deallocate(slot);
+      slot = next;
+    }
+  }
+
+  // puts the slots of the chunks left over from Rewind() on the free
+  // lists, before a change to the order of the chunks loses track of them
+  void FreeLeftovers() noexcept {
+    for (; nextChunk_ < chunks_.size(); ++nextChunk_) {
+      const Chunk &chunk = chunks_[nextChunk_];
+      for (size_t i = chunk.count; --i;) Deallocate(chunk.slots + i);
+    }
+  }
+
+  // slots are taken from the longer free list and given to the shorter
+  Slot *Allocate() {
+    if (!free_[0].head && !free_[1].head && returns_ &&
+        returns_->slots.load(std::memory_order_relaxed))
+      CollectReturns();
+    FreeList &list = free_[free_[1].count > free_[0].count];
+    if (list.head) return list.Pop();
+    if (next_ == end_) Grow();
+    return next_++;
+  }
+
+  void Deallocate(Slot *slot) noexcept {
+    free_[free_[1].count < free_[0].count].Push(slot);
+  }
+
+  void Grow() {
+    if (nextChunk_ < chunks_.size()) {  // chunk left over from Rewind()
+      Chunk &chunk = chunks_[nextChunk_++];
+      next_ = chunk.slots + 1;
+      end_ = chunk.slots + chunk.count;
+      return;
+    }
+
+    Slot *slots = SlotTraits::allocate(alloc_, nextChunkSlots_);
+    try {
+      chunks_.push_back({slots, nextChunkSlots_});
+    } catch (...) {
+      SlotTraits::deallocate(alloc_, slots, nextChunkSlots_);
+      throw;
+    }
+    new (slots->storage) Holders(1);
+    std::rotate(std::upper_bound(chunks_.begin(), chunks_.end() - 1,
+                                 chunks_.back(), ByAddress),
+                chunks_.end() - 1, chunks_.end());
+    nextChunk_ = chunks_.size();
+    next_ = slots + 1;
+    end_ = slots + nextChunkSlots_;
+    if (nextChunkSlots_ < kMaxChunkSlots) nextChunkSlots_ *= 2;
+  }
+
+  static constexpr size_t kMinChunkSlots = 8;
+  static constexpr size_t kMaxChunkSlots = 4096;
+
+  SlotAllocator alloc_;
+  s21::vector<Chunk, ChunkAllocator> chunks_;
+  FreeList free_[2];
+  Slot *next_ = nullptr;
+  Slot *end_ = nullptr;
+  size_t nextChunk_ = 0;
+  size_t nextChunkSlots_ = kMinChunkSlots;
+  Returns *returns_ = nullptr;
+};
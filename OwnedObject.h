@@ -0,0 +1,66 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+// One object in memory of its own from Allocator, owned as by a
+// unique_ptr. The node handles of trees that can not hand a node over as
+// it is keep the value in one: the B-tree and the flat tree, which have no
+// node per value, and the index layout of RBTree, whose nodes only link
+// within their own arena.
+template <typename T, typename Allocator>
+class OwnedObject {
+  using ObjectAllocator =
+      typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+  using ObjectTraits = std::allocator_traits<ObjectAllocator>;
+
+ public:
+  OwnedObject() = default;
+
+  template <typename... Args>
+  explicit OwnedObject(const Allocator &alloc, Args &&...args)
+      : alloc_(std::in_place, alloc) {
+    T *obj = ObjectTraits::allocate(*alloc_, 1);
+    try {
+      obj_ = new (obj) T(std::forward<Args>(args)...);
+    } catch (...) {
+      ObjectTraits::deallocate(*alloc_, obj, 1);
+      throw;
+    }
+  }
+
+  OwnedObject(OwnedObject &&other) noexcept
+      : obj_(std::exchange(other.obj_, nullptr)) {
+    if (other.alloc_) alloc_.emplace(*other.alloc_);
+  }
+
+  // the allocator is rebuilt rather than assigned, as a pmr allocator
+  // can not be
+  OwnedObject &operator=(OwnedObject &&other) noexcept {
+    if (this != &other) {
+      Reset();
+      obj_ = std::exchange(other.obj_, nullptr);
+      alloc_.reset();
+      if (other.alloc_) alloc_.emplace(*other.alloc_);
+    }
+    return *this;
+  }
+
+  ~OwnedObject() { Reset(); }
+
+  T *Get() const noexcept { return obj_; }
+  bool Empty() const noexcept { return !obj_; }
+  Allocator GetAllocator() const { return Allocator(*alloc_); }
+
+  void Reset() noexcept {
+    if (!obj_) return;
+    obj_->~T();
+    ObjectTraits::deallocate(*alloc_, obj_, 1);
+    obj_ = nullptr;
+  }
+
+ private:
+  T *obj_ = nullptr;
+  std::optional<ObjectAllocator> alloc_;
+};
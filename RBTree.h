@@ -1,769 +1,2813 @@
-#pragma once
-
-#include <iostream>
-#include <utility>
-
-#include "s21_vector.h"
-
-enum class color { RED, BLACK };
-
-template <typename Type>
-struct Node {
-  Type val;
-  color c;
-  Node *parent;
-  Node *left;
-  Node *right;
-
-  Node() = delete;
-
-  Node(Type val, color c, Node *parent, Node *left, Node *right)
-      : val(val), c(c), parent(parent), left(left), right(right) {}
-};
-
-template <typename Type>
-class RBTree {
- public:
-  class RBIterator {
-   public:
-    RBIterator() = delete;
-    RBIterator(Node<Type> *node, bool end = false)
-        : iter_(node), endFlag_(end) {}
-    RBIterator(const RBIterator &iter)
-        : iter_(iter.iter_), endFlag_(iter.endFlag_) {}
-    RBIterator(RBIterator &&iter)
-        : iter_(std::exchange(iter.iter_, nullptr)), endFlag_(iter.endFlag_) {}
-
-   public:
-    Type &operator*() noexcept {
-      //            if (!iter_ || endFlag_)
-      //                throw std::domain_error("nullptr");
-      return iter_->val;
-    }
-    const Type &operator*() const noexcept {
-      //            if (!iter_ || endFlag_)
-      //                throw std::domain_error("nullptr");
-      return iter_->val;
-    }
-    Node<Type> *operator->() noexcept { return iter_; }
-    const Node<Type> *operator->() const noexcept { return iter_; }
-    void operator=(const RBIterator &iter) const noexcept {
-      iter_ = iter.iter_;
-      endFlag_ = iter.endFlag_;
-    }
-    void operator=(RBIterator &&iter) const noexcept {
-      iter_ = std::exchange(iter.iter_, nullptr);
-      endFlag_ = std::exchange(iter.endFlag_, endFlag_);
-    }
-    bool operator==(const RBIterator &r) const noexcept {
-      return r.iter_ == iter_ && r.endFlag_ == endFlag_;
-    }
-    bool operator!=(const RBIterator &r) const noexcept {
-      return !((*this) == r);
-    }
-    operator bool() const noexcept { return iter_ != nullptr && !endFlag_; }
-
-    RBIterator operator++(int) const {
-      RBIterator res(*this);
-      ++(*this);
-
-      return res;
-    }
-
-    RBIterator operator++() const {
-      if (iter_) iter_ = nextNode();
-
-      return *this;
-    }
-
-    RBIterator operator--(int) const {
-      RBIterator res(*this);
-      --(*this);
-
-      return res;
-    }
-
-    RBIterator operator--() const {
-      if (iter_) iter_ = prevNode();
-
-      return *this;
-    }
-
-   private:
-    Node<Type> *prevNode() const {
-      Node<Type> *temp = iter_;
-      if (endFlag_)
-        endFlag_ = false;
-      else if (temp->left) {
-        temp = temp->left;
-        while (temp->right) temp = temp->right;
-      } else {
-        while (LeftSon(temp)) temp = temp->parent;
-        temp = temp->parent;
-      }
-
-      return temp;
-    }
-
-    Node<Type> *nextNode() const {
-      Node<Type> *temp = iter_;
-      if (temp->right) {
-        temp = temp->right;
-        while (temp->left) temp = temp->left;
-      } else {
-        while (temp->parent && !LeftSon(temp)) temp = temp->parent;
-
-        if (temp->parent)
-          temp = temp->parent;
-        else {
-          temp = iter_;
-          endFlag_ = true;
-        }
-      }
-      return temp;
-    }
-
-    bool LeftSon(Node<Type> *node) const { return node->parent->left == node; }
-
-    // private:
-   public:
-    mutable Node<Type> *iter_;
-    mutable bool endFlag_;
-  };
-
- public:
-  RBTree();
-  ~RBTree();
-  RBTree(const RBTree &m);
-
- public:
-  void operator=(const RBTree &m);
-  void operator=(RBTree &&m);
-
- public:
-  bool operator==(const RBTree &m);
-  bool operator!=(const RBTree &m);
-
- public:
-  template <typename... Args>
-  s21::vector<std::pair<RBIterator, bool>> insert_many(Args &&...args) {
-    s21::vector<std::pair<RBIterator, bool>> result;
-    InsertManyRec(result, args...);
-    return result;
-  }
-
- private:
-  template <typename T0, typename... Args>
-  void InsertManyRec(s21::vector<std::pair<RBIterator, bool>> &vec,
-                     const T0 &v0, Args &&...args) {
-    if constexpr (sizeof...(args) != 0) {
-      vec.push_back(Insert(v0));
-      InsertManyRec(vec, args...);
-    } else
-      vec.push_back(Insert(v0));
-  }
-
- public:
-  std::pair<RBIterator, bool> Insert(const Type &val);
-  void Erase(const Type &val);
-  void Erase(RBIterator node);
-  bool Empty() const noexcept;
-  size_t Size() const noexcept;
-  bool Contains(const Type &val) const noexcept;  // return Find
-  size_t Count(const Type &val) const noexcept;
-  RBIterator Find(const Type &val) const noexcept;
-  void Clear();
-  void Swap(RBTree &other);
-
- public:
-  std::pair<RBIterator, RBIterator> equal_range(const Type &key);
-  RBIterator lower_bound(const Type &key);
-  RBIterator upper_bound(const Type &key);
-
- public:
-  RBIterator begin() const;
-  RBIterator end() const;
-
- private:
-  Node<Type> *Find(Node<Type> *node, const Type &val) const;
-  Node<Type> *Grandfather(Node<Type> *node);
-  Node<Type> *Uncle(Node<Type> *node);
-  bool HasRedSon(Node<Type> *node);
-  bool LeftSon(Node<Type> *node);
-
- private:
-  void RightRotation(Node<Type> *node);
-  void LeftRotation(Node<Type> *node);
-
- private:
-  std::pair<RBIterator, bool> Insert(Node<Type> *node, const Type &val);
-  void Erase(Node<Type> *node);
-
- private:
-  void BalanceAfterInsert(Node<Type> *node);
-  void BalanceAfterErase(Node<Type> *node, bool eraseLeftSon);
-
- private:
-  void Free(const Node<Type> *node);
-
- private:
-  Node<Type> *root_;
-};
-
-template <typename Type>
-RBTree<Type>::RBTree() : root_(nullptr) {}
-
-template <typename Type>
-RBTree<Type>::~RBTree() {
-  if (root_) {
-    Free(root_);
-    root_ = nullptr;
-  }
-}
-
-template <typename Type>
-RBTree<Type>::RBTree(const RBTree &m) : root_(nullptr) {
-  if ((*this) != m) {
-    auto it = m.begin();
-    while (it != m.end()) {
-      Insert(*(it));
-      ++it;
-    }
-  }
-}
-
-template <typename Type>
-void RBTree<Type>::operator=(const RBTree &m) {
-  if ((*this) != m) {
-    auto it = m.begin();
-    while (it != m.end()) {
-      Insert(*(it));
-      ++it;
-    }
-  }
-}
-
-template <typename Type>
-void RBTree<Type>::operator=(RBTree &&m) {
-  if ((*this) != m) {
-    Clear();
-    root_ = std::move(m.root_);
-    m.root_ = nullptr;
-  }
-}
-
-template <typename Type>
-bool RBTree<Type>::operator==(const RBTree &m) {
-  return root_ == m.root_;
-}
-
-template <typename Type>
-bool RBTree<Type>::operator!=(const RBTree &m) {
-  return root_ != m.root_;
-}
-
-template <typename Type>
-void RBTree<Type>::Free(const Node<Type> *node) {
-  if (node->left) Free(node->left);
-  if (node->right) Free(node->right);
-  delete node;
-}
-
-template <typename Type>
-void RBTree<Type>::Clear() {
-  if (root_) Free(root_);
-  root_ = nullptr;
-}
-
-template <typename Type>
-void RBTree<Type>::Swap(RBTree &other) {
-  std::swap(root_, other.root_);
-}
-
-template <typename Type>
-std::pair<typename RBTree<Type>::RBIterator, bool> RBTree<Type>::Insert(
-    const Type &val) {
-  std::pair<typename RBTree<Type>::RBIterator, bool> result{end(), false};
-  if (!root_) {
-    root_ = new Node<Type>{val, color::BLACK, nullptr, nullptr, nullptr};
-    result = {root_, true};
-  } else
-    result = Insert(root_, val);
-
-  while (root_->parent) root_ = root_->parent;
-
-  return result;
-}
-
-template <typename Type>
-bool RBTree<Type>::Contains(const Type &val) const noexcept {
-  return Find(val) != end();
-}
-
-template <typename Type>
-size_t RBTree<Type>::Count(const Type &val) const noexcept {
-  int count = 0;
-  RBIterator iter = Find(val);
-  if (iter) {
-    RBIterator next(iter);
-    while (iter && *iter == val) next = iter--;
-    while (next && (*next) == val) {
-      ++count;
-      ++next;
-    }
-  } else
-    count = 0;
-  return count;
-}
-
-template <typename Type>
-typename RBTree<Type>::RBIterator RBTree<Type>::Find(
-    const Type &val) const noexcept {
-  Node<Type> *result = nullptr;
-
-  if (root_) result = Find(root_, val);
-
-  return result ? result : end();
-}
-
-template <typename Type>
-void RBTree<Type>::Erase(const Type &val) {
-  Node<Type> *erasedNode = Find(root_, val);
-
-  if (erasedNode) Erase(erasedNode);
-
-  while (root_->parent) root_ = root_->parent;
-}
-
-template <typename Type>
-void RBTree<Type>::Erase(RBIterator node) {
-  Node<Type> *erasedNode = node.operator->();
-
-  if (erasedNode) Erase(erasedNode);
-
-  while (root_ && root_->parent) root_ = root_->parent;
-}
-
-template <typename Type>
-bool RBTree<Type>::Empty() const noexcept {
-  return root_ == nullptr;
-}
-
-template <typename Type>
-size_t RBTree<Type>::Size() const noexcept {
-  size_t c = 0;
-  for (auto it = begin(); it != end(); ++it) ++c;
-
-  return c;
-}
-
-template <typename Type>
-std::pair<typename RBTree<Type>::RBIterator, typename RBTree<Type>::RBIterator>
-RBTree<Type>::equal_range(const Type &key) {
-  std::pair<RBIterator, RBIterator> result{end(), end()};
-
-  RBIterator iter = Find(key);
-  if (iter) {
-    RBIterator next(iter);
-    while (iter && *iter == key) next = iter--;
-
-    result.first = next;
-
-    while (next && (*next) == key) ++next;
-    result.second = next;
-  }
-  return result;
-}
-
-template <typename Type>
-typename RBTree<Type>::RBIterator RBTree<Type>::lower_bound(const Type &key) {
-  RBIterator result(root_);
-
-  while (result && (*result) > key) --result;
-
-  if (!result) return begin();
-
-  while (result && (*result < key)) ++result;
-
-  return result;
-}
-
-template <typename Type>
-typename RBTree<Type>::RBIterator RBTree<Type>::upper_bound(const Type &key) {
-  RBIterator result(root_);
-
-  while (result && (*result) > key) --result;
-
-  if (!result) return begin();
-
-  while (result && (*result <= key)) ++result;
-
-  return result;
-}
-
-template <typename Type>
-typename RBTree<Type>::RBIterator RBTree<Type>::begin() const {
-  Node<Type> *temp = root_;
-
-  if (temp)
-    while (temp->left) temp = temp->left;
-  else
-    return {temp, true};
-
-  return temp;
-}
-
-template <typename Type>
-typename RBTree<Type>::RBIterator RBTree<Type>::end() const {
-  Node<Type> *temp = root_;
-
-  if (temp)
-    while (temp->right) temp = temp->right;
-
-  return RBIterator{temp, true};
-}
-
-template <typename Type>
-Node<Type> *RBTree<Type>::Find(Node<Type> *node, const Type &val) const {
-  Node<Type> *result = nullptr;
-
-  if (node->val < val) {
-    if (node->right) result = Find(node->right, val);
-  } else if (node->val > val) {
-    if (node->left) result = Find(node->left, val);
-  } else
-    result = node;
-  return result;
-}
-
-template <typename Type>
-Node<Type> *RBTree<Type>::Grandfather(Node<Type> *node) {
-  Node<Type> *result = nullptr;
-  if (node->parent) result = node->parent->parent;
-
-  return result;
-}
-
-template <typename Type>
-Node<Type> *RBTree<Type>::Uncle(Node<Type> *node) {
-  Node<Type> *result = nullptr;
-
-  Node<Type> *grandfather = Grandfather(node);
-  if (grandfather)
-    result = grandfather->left == node->parent ? grandfather->right
-                                               : grandfather->left;
-
-  return result;
-}
-
-template <typename Type>
-bool RBTree<Type>::HasRedSon(Node<Type> *node) {
-  bool result = false;
-
-  if ((node->right && node->right->c == color::RED) ||
-      (node->left && node->left->c == color::RED))
-    result = true;
-
-  return result;
-}
-
-template <typename Type>
-void RBTree<Type>::RightRotation(Node<Type> *node) {
-  if (node->parent) {
-    if (LeftSon(node))
-      node->parent->left = node->left;
-    else
-      node->parent->right = node->left;
-  }
-  node->left->parent = node->parent;
-  node->parent = node->left;
-  node->left = node->left->right;
-  node->parent->right = node;
-  if (node->left) node->left->parent = node;
-}
-
-template <typename Type>
-void RBTree<Type>::LeftRotation(Node<Type> *node) {
-  if (node->parent) {
-    if (LeftSon(node))
-      node->parent->left = node->right;
-    else
-      node->parent->right = node->right;
-  }
-  node->right->parent = node->parent;
-  node->parent = node->right;
-  node->right = node->right->left;
-  node->parent->left = node;
-  if (node->right) node->right->parent = node;
-}
-
-template <typename Type>
-bool RBTree<Type>::LeftSon(Node<Type> *node) {
-  return node->parent->left == node;
-}
-
-template <typename Type>
-std::pair<typename RBTree<Type>::RBIterator, bool> RBTree<Type>::Insert(
-    Node<Type> *node, const Type &val) {
-  if (node->val < val) {
-    if (node->right)
-      return Insert(node->right, val);
-    else {
-      node->right = new Node<Type>(val, color::RED, node, nullptr, nullptr);
-      Node<Type> *rightNode = node->right;
-      BalanceAfterInsert(node->right);
-      return {rightNode, true};
-    }
-  } else {
-    if (node->left)
-      return Insert(node->left, val);
-    else {
-      node->left = new Node<Type>(val, color::RED, node, nullptr, nullptr);
-      Node<Type> *leftNode = node->left;
-      BalanceAfterInsert(node->left);
-      return {leftNode, true};
-    }
-  }
-}
-
-template <typename Type>
-void RBTree<Type>::BalanceAfterInsert(Node<Type> *node) {
-  if (node->parent == nullptr)
-    node->c = color::BLACK;
-  else if (node->parent->c == color::RED) {
-    if (Uncle(node) && Uncle(node)->c == color::RED) {
-      Uncle(node)->c = color::BLACK;
-      Grandfather(node)->c = color::RED;
-      node->parent->c = color::BLACK;
-      BalanceAfterInsert(Grandfather(node));
-    } else if (LeftSon(node)) {
-      if (LeftSon(node->parent)) {
-        Grandfather(node)->c = color::RED;
-        node->parent->c = color::BLACK;
-        RightRotation(Grandfather(node));
-      } else {
-        RightRotation(node->parent);
-        BalanceAfterInsert(node->right);
-      }
-    } else {
-      if (!LeftSon(node->parent)) {
-        Grandfather(node)->c = color::RED;
-        node->parent->c = color::BLACK;
-        LeftRotation(Grandfather(node));
-      } else {
-        LeftRotation(node->parent);
-        BalanceAfterInsert(node->left);
-      }
-    }
-  }
-}
-
-template <typename Type>
-void RBTree<Type>::Erase(Node<Type> *erasedNode) {
-  if (!erasedNode->left && !erasedNode->right) {
-    if (!erasedNode->parent) {
-      delete erasedNode;
-      root_ = nullptr;
-    } else if (erasedNode->c == color::RED)  // checked
-    {
-      if (LeftSon(erasedNode))
-        erasedNode->parent->left = nullptr;
-      else
-        erasedNode->parent->right = nullptr;
-      delete erasedNode;
-    } else  // not checked
-    {
-      Node<Type> *erasedNodeParent = erasedNode->parent;
-      bool erasedNodeLeftSon = LeftSon(erasedNode);
-
-      if (LeftSon(erasedNode))
-        erasedNode->parent->left = nullptr;
-      else
-        erasedNode->parent->right = nullptr;
-      delete erasedNode;
-
-      BalanceAfterErase(erasedNodeParent, erasedNodeLeftSon);
-    }
-  } else if (erasedNode->left && !erasedNode->right)  // checked
-  {
-    if (erasedNode->parent) {
-      if (LeftSon(erasedNode))
-        erasedNode->parent->left = erasedNode->left;
-      else
-        erasedNode->parent->right = erasedNode->left;
-      erasedNode->left->parent = erasedNode->parent;
-      erasedNode->left->c = color::BLACK;
-      delete erasedNode;
-    } else {
-      erasedNode->left->parent = nullptr;
-      erasedNode->left->c = color::BLACK;
-      root_ = erasedNode->left;
-      delete erasedNode;
-    }
-  } else if (!erasedNode->left && erasedNode->right)  // checked
-  {
-    if (erasedNode->parent) {
-      if (LeftSon(erasedNode))
-        erasedNode->parent->left = erasedNode->right;
-      else
-        erasedNode->parent->right = erasedNode->right;
-      erasedNode->right->parent = erasedNode->parent;
-      erasedNode->right->c = color::BLACK;
-      delete erasedNode;
-    } else {
-      erasedNode->right->parent = nullptr;
-      erasedNode->right->c = color::BLACK;
-      root_ = erasedNode->right;
-      delete erasedNode;
-    }
-  } else  // oba sina
-  {
-    Node<Type> *leftMaxNode = erasedNode->left;
-    while (leftMaxNode->right) leftMaxNode = leftMaxNode->right;
-
-    if (erasedNode->parent) {
-      if (LeftSon(erasedNode))
-        erasedNode->parent->left = leftMaxNode;
-      else
-        erasedNode->parent->right = leftMaxNode;
-    }
-
-    if (leftMaxNode == erasedNode->left)  // if no right grandsons
-    {
-      leftMaxNode->parent = erasedNode->parent;
-
-      erasedNode->left = leftMaxNode->left;
-      if (erasedNode->left) erasedNode->left->parent = erasedNode;  // deti?
-
-      leftMaxNode->left = erasedNode;
-      erasedNode->parent = leftMaxNode;
-
-      leftMaxNode->right = erasedNode->right;
-      leftMaxNode->right->parent = leftMaxNode;  // tochno imeetsya
-      erasedNode->right = nullptr;               // no grandson
-    } else                                       // not checked
-    {
-      std::swap(leftMaxNode->parent, erasedNode->parent);
-      std::swap(leftMaxNode->left, erasedNode->left);    // deti?
-      std::swap(leftMaxNode->right, erasedNode->right);  // deti?
-      leftMaxNode->left->parent = leftMaxNode;           // tochno imeetsya
-      leftMaxNode->right->parent = leftMaxNode;
-      if (erasedNode->left) erasedNode->left->parent = erasedNode;  // deti?
-      erasedNode->right = nullptr;  // no grandson
-    }
-    std::swap(leftMaxNode->c, erasedNode->c);
-    root_ = leftMaxNode;
-    Erase(erasedNode);
-  }
-}
-
-template <typename Type>
-void RBTree<Type>::BalanceAfterErase(Node<Type> *node, bool eraseLeftSon) {
-  if (eraseLeftSon) {
-    if (node->c == color::RED) {
-      if (node->right->right && node->right->right->c == color::RED) {
-        node->c = color::BLACK;
-        node->right->c = color::RED;
-        node->right->right->c = color::BLACK;
-        LeftRotation(node);
-      } else if (node->right->left && node->right->left->c == color::RED) {
-        RightRotation(node->right);
-        LeftRotation(node);
-        node->c = color::BLACK;
-      } else {
-        node->right->c = color::RED;
-        node->c = color::BLACK;
-      }
-    } else {
-      if (node->right->c == color::RED) {
-        Node<Type> *left_grandson = node->right->left;
-        if (left_grandson->right && left_grandson->right->c == color::RED) {
-          left_grandson->right->c = color::BLACK;
-          RightRotation(node->right);
-          LeftRotation(node);
-        } else if (left_grandson->left &&
-                   left_grandson->left->c == color::RED) {
-          RightRotation(node->right);
-          LeftRotation(node);
-        } else {
-          node->right->c = color::BLACK;
-          left_grandson->c = color::RED;
-          LeftRotation(node);
-        }
-      } else {
-        if (HasRedSon(node->right)) {
-          if (node->right->right && node->right->right->c == color::RED) {
-            node->right->right->c = color::BLACK;
-            // RightRotation(left);
-            LeftRotation(node);
-          } else {
-            node->right->left->c = color::BLACK;
-            RightRotation(node->right);
-            LeftRotation(node);
-          }
-        } else {
-          node->right->c = color::RED;
-          if (node->parent) BalanceAfterErase(node->parent, LeftSon(node));
-        }
-      }
-    }
-  } else {
-    if (node->c == color::RED) {
-      if (node->left->left && node->left->left->c == color::RED)  // 1
-      {
-        node->c = color::BLACK;
-        node->left->c = color::RED;
-        node->left->left->c = color::BLACK;
-        RightRotation(node);
-      } else if (node->left->right && node->left->right->c == color::RED)  // 2
-      {
-        LeftRotation(node->left);
-        RightRotation(node);
-        node->c = color::BLACK;
-      } else  // 3
-      {
-        node->left->c = color::RED;
-        node->c = color::BLACK;
-      }
-    } else {
-      if (node->left->c == color::RED) {
-        Node<Type> *right_grandson = node->left->right;
-        if (right_grandson->left &&
-            right_grandson->left->c == color::RED)  // 4.1
-        {
-          right_grandson->left->c = color::BLACK;
-          LeftRotation(node->left);
-          RightRotation(node);
-        } else if (right_grandson->right &&
-                   right_grandson->right->c == color::RED)  // 4.2
-        {
-          LeftRotation(node->left);
-          RightRotation(node);
-        } else  // 5
-        {
-          node->left->c = color::BLACK;
-          right_grandson->c = color::RED;
-          RightRotation(node);
-        }
-      } else {
-        if (HasRedSon(node->left)) {
-          if (node->left->left && node->left->left->c == color::RED)  // 6
-          {
-            node->left->left->c = color::BLACK;
-            // RightRotation(left);
-            RightRotation(node);
-          } else  // 7 2.2.2.1
-          {
-            node->left->right->c = color::BLACK;
-            LeftRotation(node->left);
-            RightRotation(node);
-          }
-        } else  // 8
-        {
-          node->left->c = color::RED;
-          if (node->parent) BalanceAfterErase(node->parent, LeftSon(node));
-        }
-      }
-    }
-  }
-};
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "NodeArena.h"
+#include "NodePool.h"
+#include "s21_vector.h"
+
+enum class color { RED, BLACK };
+
+// Links shared by the value nodes and the tree header. The header is the
+// parent of the root, its left/right point to the minimum/maximum node and
+// its size is always 0, which is how iterators recognise end().
+//
+// The links and the color are only reached through the accessors, so the
+// tree code is shared by three layouts:
+// - by default they are plain pointers next to a color field;
+// - with S21_COMPACT_NODES the color is kept in the lowest bit of the
+//   parent pointer, which is always 0 for an aligned node, making every
+//   node one word smaller;
+// - with S21_INDEX_NODES the nodes live in the chunks of a NodeArena and
+//   link to each other by 32-bit indices into it (see NodeArena.h), which
+//   halves the links and the size again. The header stays outside the
+//   arena and keeps pointers, as a HeaderNode. Left() and Right() find
+//   the arena through the page head of the node, while searches load its
+//   table once and pass it to Left(table) and Right(table).
+//
+// S21_THREADED_NODES adds to any of them links to the in-order neighbours,
+// a ring closed by the header, so that an iterator steps with one load
+// instead of climbing the tree. Rotations keep the order, so only linking
+// and erasing a node touch the ring.
+#if defined(S21_COMPACT_NODES) && defined(S21_INDEX_NODES)
+#error "S21_COMPACT_NODES and S21_INDEX_NODES are alternative layouts"
+#endif
+
+#if defined(S21_INDEX_NODES)
+struct HeaderNode;
+using LinkTable = ArenaTable;
+#else
+// the links of the other layouts are addresses and need no table
+struct LinkTable {};
+#endif
+
+struct NodeBase {
+  NodeBase() = default;
+
+#if defined(S21_COMPACT_NODES)
+  NodeBase(color c, NodeBase *parent, NodeBase *left, NodeBase *right,
+           size_t size) noexcept
+      : size(size),
+        parent_(reinterpret_cast<std::uintptr_t>(parent) | ColorBit(c)),
+        left_(left),
+        right_(right) {}
+
+  NodeBase *Parent() const noexcept {
+    return reinterpret_cast<NodeBase *>(parent_ & ~kBlackBit);
+  }
+  void SetParent(NodeBase *parent) noexcept {
+    parent_ = reinterpret_cast<std::uintptr_t>(parent) | (parent_ & kBlackBit);
+  }
+  NodeBase *Left() const noexcept { return left_; }
+  void SetLeft(NodeBase *left) noexcept { left_ = left; }
+  NodeBase *Right() const noexcept { return right_; }
+  void SetRight(NodeBase *right) noexcept { right_ = right; }
+  NodeBase *Parent(LinkTable) const noexcept { return Parent(); }
+  NodeBase *Left(LinkTable) const noexcept { return left_; }
+  NodeBase *Right(LinkTable) const noexcept { return right_; }
+  color Color() const noexcept {
+    return parent_ & kBlackBit ? color::BLACK : color::RED;
+  }
+  void SetColor(color c) noexcept {
+    parent_ = (parent_ & ~kBlackBit) | ColorBit(c);
+  }
+#if defined(S21_THREADED_NODES)
+  NodeBase *Next() const noexcept { return next_; }
+  void SetNext(NodeBase *next) noexcept { next_ = next; }
+  NodeBase *Prev() const noexcept { return prev_; }
+  void SetPrev(NodeBase *prev) noexcept { prev_ = prev; }
+#endif
+
+  size_t size;  // number of nodes in the subtree rooted here
+
+ private:
+  static constexpr std::uintptr_t kBlackBit = 1;
+
+  static std::uintptr_t ColorBit(color c) noexcept {
+    return c == color::BLACK ? kBlackBit : 0;
+  }
+
+  std::uintptr_t parent_;
+  NodeBase *left_;
+  NodeBase *right_;
+#if defined(S21_THREADED_NODES)
+  NodeBase *next_;
+  NodeBase *prev_;
+#endif
+#elif defined(S21_INDEX_NODES)
+  NodeBase(color c, NodeBase *parent, NodeBase *left, NodeBase *right,
+           size_t size) noexcept
+      : size(static_cast<std::uint32_t>(size)),
+        parent_(LinkTo(parent) << 1 | ColorBit(c)),
+        left_(LinkTo(left)),
+        right_(LinkTo(right)) {}
+
+  inline NodeBase *Parent() const noexcept;
+  inline void SetParent(NodeBase *parent) noexcept;
+  inline NodeBase *Left() const noexcept;
+  inline void SetLeft(NodeBase *left) noexcept;
+  inline NodeBase *Right() const noexcept;
+  inline void SetRight(NodeBase *right) noexcept;
+  // the links of a node, not of the header, by the table of its arena
+  // rather than by its page head
+  NodeBase *Parent(const LinkTable &table) const noexcept {
+    const std::uint32_t link = parent_ >> 1;
+    if (link == kArenaOutside)
+      return static_cast<NodeBase *>(
+          reinterpret_cast<const ArenaPageHead *>(table.chunks[0])->outside);
+    return Down(table, link);
+  }
+  NodeBase *Left(const LinkTable &table) const noexcept {
+    return Down(table, left_);
+  }
+  NodeBase *Right(const LinkTable &table) const noexcept {
+    return Down(table, right_);
+  }
+  color Color() const noexcept {
+    return parent_ & kBlackBit ? color::BLACK : color::RED;
+  }
+  void SetColor(color c) noexcept {
+    parent_ = (parent_ & ~kBlackBit) | ColorBit(c);
+  }
+#if defined(S21_THREADED_NODES)
+  inline NodeBase *Next() const noexcept;
+  inline void SetNext(NodeBase *next) noexcept;
+  inline NodeBase *Prev() const noexcept;
+  inline void SetPrev(NodeBase *prev) noexcept;
+#endif
+
+  std::uint32_t size;  // number of nodes in the subtree rooted here
+
+ private:
+  static constexpr std::uint32_t kBlackBit = 1;
+
+  static std::uint32_t ColorBit(color c) noexcept {
+    return c == color::BLACK ? kBlackBit : 0;
+  }
+
+  inline HeaderNode *AsHeader() const noexcept;
+
+  // the link stored for node, made from the arena chunk of this node
+  std::uint32_t LinkTo(NodeBase *node) const noexcept {
+    if (!node) return kArenaNull;
+    if (!node->size) {
+      ArenaPageHead::Of(this)->First()->outside = node;
+      return kArenaOutside;
+    }
+    return ArenaPageHead::LinkOf(node);
+  }
+
+  static NodeBase *Down(const LinkTable &table, std::uint32_t link) noexcept {
+    return link ? static_cast<NodeBase *>(table.Resolve(link)) : nullptr;
+  }
+
+  NodeBase *Follow(std::uint32_t link) const noexcept {
+    const ArenaPageHead *head = ArenaPageHead::Of(this);
+    if (link > kArenaOutside)
+      return static_cast<NodeBase *>(head->Resolve(link));
+    return link ? static_cast<NodeBase *>(head->First()->outside) : nullptr;
+  }
+
+  std::uint32_t parent_;  // link << 1 | color bit
+  std::uint32_t left_;
+  std::uint32_t right_;
+#if defined(S21_THREADED_NODES)
+  std::uint32_t next_;
+  std::uint32_t prev_;
+#endif
+#else
+  NodeBase(color c, NodeBase *parent, NodeBase *left, NodeBase *right,
+           size_t size) noexcept
+      : size(size), c_(c), parent_(parent), left_(left), right_(right) {}
+
+  NodeBase *Parent() const noexcept { return parent_; }
+  void SetParent(NodeBase *parent) noexcept { parent_ = parent; }
+  NodeBase *Left() const noexcept { return left_; }
+  void SetLeft(NodeBase *left) noexcept { left_ = left; }
+  NodeBase *Right() const noexcept { return right_; }
+  void SetRight(NodeBase *right) noexcept { right_ = right; }
+  NodeBase *Parent(LinkTable) const noexcept { return Parent(); }
+  NodeBase *Left(LinkTable) const noexcept { return left_; }
+  NodeBase *Right(LinkTable) const noexcept { return right_; }
+  color Color() const noexcept { return c_; }
+  void SetColor(color c) noexcept { c_ = c; }
+#if defined(S21_THREADED_NODES)
+  NodeBase *Next() const noexcept { return next_; }
+  void SetNext(NodeBase *next) noexcept { next_ = next; }
+  NodeBase *Prev() const noexcept { return prev_; }
+  void SetPrev(NodeBase *prev) noexcept { prev_ = prev; }
+#endif
+
+  size_t size;  // number of nodes in the subtree rooted here
+
+ private:
+  color c_;
+  NodeBase *parent_;
+  NodeBase *left_;
+  NodeBase *right_;
+#if defined(S21_THREADED_NODES)
+  NodeBase *next_;
+  NodeBase *prev_;
+#endif
+#endif
+};
+
+#if defined(S21_INDEX_NODES)
+// the header of a tree in the index layout, which is not in any arena
+struct HeaderNode : NodeBase {
+  NodeBase *parent;
+  NodeBase *left;
+  NodeBase *right;
+#if defined(S21_THREADED_NODES)
+  NodeBase *next;
+  NodeBase *prev;
+#endif
+};
+
+HeaderNode *NodeBase::AsHeader() const noexcept {
+  return static_cast<HeaderNode *>(const_cast<NodeBase *>(this));
+}
+
+NodeBase *NodeBase::Parent() const noexcept {
+  return size ? Follow(parent_ >> 1) : AsHeader()->parent;
+}
+
+void NodeBase::SetParent(NodeBase *parent) noexcept {
+  if (size)
+    parent_ = LinkTo(parent) << 1 | (parent_ & kBlackBit);
+  else
+    AsHeader()->parent = parent;
+}
+
+NodeBase *NodeBase::Left() const noexcept {
+  return size ? Follow(left_) : AsHeader()->left;
+}
+
+void NodeBase::SetLeft(NodeBase *left) noexcept {
+  if (size)
+    left_ = LinkTo(left);
+  else
+    AsHeader()->left = left;
+}
+
+NodeBase *NodeBase::Right() const noexcept {
+  return size ? Follow(right_) : AsHeader()->right;
+}
+
+void NodeBase::SetRight(NodeBase *right) noexcept {
+  if (size)
+    right_ = LinkTo(right);
+  else
+    AsHeader()->right = right;
+}
+
+#if defined(S21_THREADED_NODES)
+NodeBase *NodeBase::Next() const noexcept {
+  return size ? Follow(next_) : AsHeader()->next;
+}
+
+void NodeBase::SetNext(NodeBase *next) noexcept {
+  if (size)
+    next_ = LinkTo(next);
+  else
+    AsHeader()->next = next;
+}
+
+NodeBase *NodeBase::Prev() const noexcept {
+  return size ? Follow(prev_) : AsHeader()->prev;
+}
+
+void NodeBase::SetPrev(NodeBase *prev) noexcept {
+  if (size)
+    prev_ = LinkTo(prev);
+  else
+    AsHeader()->prev = prev;
+}
+#endif
+
+template <typename T, typename Allocator>
+using NodeStorage = NodeArena<T, Allocator>;
+#else
+using HeaderNode = NodeBase;
+
+template <typename T, typename Allocator>
+using NodeStorage = NodePool<T, Allocator>;
+#endif
+
+template <typename Type>
+struct Node : NodeBase {
+  Type val;
+
+  Node() = delete;
+
+  template <typename... Args>
+  Node(color c, NodeBase *parent, NodeBase *left, NodeBase *right,
+       Args &&...args)
+      : NodeBase(c, parent, left, right, 1),
+        val(std::forward<Args>(args)...) {}
+};
+
+// Key extraction policies: the tree orders its values by the key that
+// KeyOfValue returns for them, a set value is its own key and a map value
+// is ordered by its first member
+struct Identity {
+  template <typename T>
+  const T &operator()(const T &val) const noexcept {
+    return val;
+  }
+};
+
+struct SelectFirst {
+  template <typename Pair>
+  const auto &operator()(const Pair &val) const noexcept {
+    return val.first;
+  }
+};
+
+// a comparator marked is_transparent compares keys with other types, such
+// as std::less<> comparing std::string with std::string_view
+template <typename Compare, typename = void>
+struct IsTransparent : std::false_type {};
+
+template <typename Compare>
+struct IsTransparent<Compare, std::void_t<typename Compare::is_transparent>>
+    : std::true_type {};
+
+// Three-way ordering: a comparator with a member compare(a, b) returning an
+// int below, equal to or above zero orders a and b in one call. std::less
+// and std::greater get the same from keys with such a compare(b) member, as
+// std::string has, so a search compares each visited node only once.
+template <typename Compare, typename A, typename B>
+using ThreeWayResult = decltype(std::declval<const Compare &>().compare(
+    std::declval<const A &>(), std::declval<const B &>()));
+
+template <typename A, typename B>
+using CompareMemberResult =
+    decltype(std::declval<const A &>().compare(std::declval<const B &>()));
+
+template <typename Compare, typename A, typename B, typename = void>
+struct HasThreeWay : std::false_type {};
+
+template <typename Compare, typename A, typename B>
+struct HasThreeWay<
+    Compare, A, B,
+    std::enable_if_t<std::is_same_v<ThreeWayResult<Compare, A, B>, int>>>
+    : std::true_type {};
+
+template <typename A, typename B, typename = void>
+struct HasCompareMember : std::false_type {};
+
+template <typename A, typename B>
+struct HasCompareMember<
+    A, B, std::enable_if_t<std::is_same_v<CompareMemberResult<A, B>, int>>>
+    : std::true_type {};
+
+template <typename Compare, typename Key>
+inline constexpr bool kIsStdLess = std::is_same_v<Compare, std::less<Key>> ||
+                                   std::is_same_v<Compare, std::less<>>;
+
+template <typename Compare, typename Key>
+inline constexpr bool kIsStdGreater =
+    std::is_same_v<Compare, std::greater<Key>> ||
+    std::is_same_v<Compare, std::greater<>>;
+
+// Holds the comparator of a tree. An empty comparator class is inherited
+// rather than stored, so a stateless one takes no space in the tree.
+template <typename Compare,
+          bool = std::is_empty_v<Compare> && !std::is_final_v<Compare>>
+class KeyCompare : private Compare {
+ public:
+  KeyCompare() = default;
+  explicit KeyCompare(const Compare &comp) : Compare(comp) {}
+
+  const Compare &Comp() const noexcept { return *this; }
+  Compare &Comp() noexcept { return *this; }
+};
+
+template <typename Compare>
+class KeyCompare<Compare, false> {
+ public:
+  KeyCompare() = default;
+  explicit KeyCompare(const Compare &comp) : comp_(comp) {}
+
+  const Compare &Comp() const noexcept { return comp_; }
+  Compare &Comp() noexcept { return comp_; }
+
+ private:
+  Compare comp_{};
+};
+
+// Asks for the cache line at addr + offset bytes ahead of its use, as a
+// hint only: the address is formed as an integer and never dereferenced,
+// so it may lie past the end of the data.
+inline void Prefetch(const void *addr, size_t offset = 0) noexcept {
+#if defined(__GNUC__)
+  __builtin_prefetch(reinterpret_cast<const void *>(
+      reinterpret_cast<std::uintptr_t>(addr) + offset));
+#else
+  (void)addr;
+  (void)offset;
+#endif
+}
+
+// Values are ordered by Compare applied to their keys. A search converts
+// its key to KeyType once, unless Compare is transparent, in which case
+// the key is compared as it is.
+template <typename Type, typename Allocator = std::allocator<Type>,
+          typename KeyOfValue = Identity, typename Compare = std::less<>>
+class RBTree : private KeyCompare<Compare> {
+  using KeyCompare<Compare>::Comp;
+
+ public:
+  using KeyType = std::decay_t<std::invoke_result_t<KeyOfValue, const Type &>>;
+
+ public:
+  class RBIterator {
+   public:
+    RBIterator() = delete;
+    RBIterator(NodeBase *node) : iter_(node) {}
+    RBIterator(const RBIterator &iter) : iter_(iter.iter_) {}
+    RBIterator(RBIterator &&iter) : iter_(std::exchange(iter.iter_, nullptr)) {}
+
+   public:
+    Type &operator*() noexcept { return Value(iter_); }
+    const Type &operator*() const noexcept { return Value(iter_); }
+    Type *operator->() noexcept { return &Value(iter_); }
+    const Type *operator->() const noexcept { return &Value(iter_); }
+    void operator=(const RBIterator &iter) const noexcept {
+      iter_ = iter.iter_;
+    }
+    void operator=(RBIterator &&iter) const noexcept {
+      iter_ = std::exchange(iter.iter_, nullptr);
+    }
+    bool operator==(const RBIterator &r) const noexcept {
+      return r.iter_ == iter_;
+    }
+    bool operator!=(const RBIterator &r) const noexcept {
+      return !((*this) == r);
+    }
+    operator bool() const noexcept { return iter_ != nullptr && iter_->size; }
+
+    RBIterator operator++(int) const {
+      RBIterator res(*this);
+      ++(*this);
+
+      return res;
+    }
+
+    RBIterator operator++() const {
+      if (iter_) iter_ = nextNode();
+
+      return *this;
+    }
+
+    RBIterator operator--(int) const {
+      RBIterator res(*this);
+      --(*this);
+
+      return res;
+    }
+
+    RBIterator operator--() const {
+      if (iter_) iter_ = prevNode();
+
+      return *this;
+    }
+
+   private:
+    // climbing stops at the header, so --begin() and ++(--end()) give end()
+    NodeBase *prevNode() const {
+#if defined(S21_THREADED_NODES)
+      return iter_->Prev();
+#else
+      NodeBase *temp = iter_;
+      if (!temp->size)
+        temp = temp->Right();
+      else if (temp->Left()) {
+        temp = temp->Left();
+        while (temp->Right()) temp = temp->Right();
+      } else {
+        NodeBase *parent = temp->Parent();
+        while (parent->size && parent->Left() == temp) {
+          temp = parent;
+          parent = parent->Parent();
+        }
+        temp = parent;
+      }
+
+      return temp;
+#endif
+    }
+
+    NodeBase *nextNode() const {
+#if defined(S21_THREADED_NODES)
+      return iter_->size ? iter_->Next() : iter_;
+#else
+      NodeBase *temp = iter_;
+      if (!temp->size)
+        return temp;
+      else if (temp->Right()) {
+        temp = temp->Right();
+        while (temp->Left()) temp = temp->Left();
+      } else {
+        NodeBase *parent = temp->Parent();
+        while (parent->size && parent->Right() == temp) {
+          temp = parent;
+          parent = parent->Parent();
+        }
+        temp = parent;
+      }
+      return temp;
+#endif
+    }
+
+    // private:
+   public:
+    mutable NodeBase *iter_;
+  };
+
+  using Iterator = RBIterator;
+
+ public:
+  RBTree();
+  explicit RBTree(const Allocator &alloc);
+  RBTree(const Compare &comp, const Allocator &alloc);
+  ~RBTree();
+  RBTree(const RBTree &m);
+
+ public:
+  void operator=(const RBTree &m);
+  void operator=(RBTree &&m);
+
+ public:
+  bool operator==(const RBTree &m);
+  bool operator!=(const RBTree &m);
+
+ public:
+  template <typename... Args>
+  s21::vector<std::pair<RBIterator, bool>> insert_many(Args &&...args) {
+    s21::vector<std::pair<RBIterator, bool>> result;
+    InsertManyRec(result, std::forward<Args>(args)...);
+    return result;
+  }
+
+ private:
+  template <typename T0, typename... Args>
+  void InsertManyRec(s21::vector<std::pair<RBIterator, bool>> &vec, T0 &&v0,
+                     Args &&...args) {
+    // hinting with the successor of the previous value makes ascending
+    // arguments take the constant time path
+    RBIterator hint = vec.empty() ? end() : ++RBIterator(vec.back().first);
+    vec.push_back(Insert(hint, Type(std::forward<T0>(v0))));
+    if constexpr (sizeof...(args) != 0)
+      InsertManyRec(vec, std::forward<Args>(args)...);
+  }
+
+ public:
+  template <typename V>
+  std::pair<RBIterator, bool> Insert(V &&val);
+  template <typename V>
+  std::pair<RBIterator, bool> InsertUnique(V &&val);
+  template <typename V>
+  std::pair<RBIterator, bool> Insert(RBIterator hint, V &&val);
+  template <typename V>
+  std::pair<RBIterator, bool> InsertUnique(RBIterator hint, V &&val);
+
+ public:
+  template <typename... Args>
+  std::pair<RBIterator, bool> Emplace(Args &&...args);
+  template <typename... Args>
+  std::pair<RBIterator, bool> EmplaceUnique(Args &&...args);
+  template <typename... Args>
+  std::pair<RBIterator, bool> EmplaceHint(RBIterator hint, Args &&...args);
+  template <typename... Args>
+  std::pair<RBIterator, bool> EmplaceHintUnique(RBIterator hint,
+                                                Args &&...args);
+
+ public:
+  void Erase(const Type &val);
+  void Erase(RBIterator node);
+  bool Empty() const noexcept;
+  size_t Size() const noexcept;
+  template <typename K>
+  bool Contains(const K &key) const;
+  template <typename K>
+  size_t Count(const K &key) const;
+  template <typename K>
+  RBIterator Find(const K &key) const;
+  template <typename ForwardIt>
+  void FindMany(ForwardIt first, ForwardIt last,
+                s21::vector<RBIterator> &out) const;
+  void Clear();
+  void Swap(RBTree &other);
+  Allocator GetAllocator() const noexcept;
+  Compare GetCompare() const;
+
+ public:
+  template <typename InputIt, typename Same>
+  void AssignSorted(InputIt first, InputIt last, Same same);
+
+ public:
+  template <typename K>
+  void Split(const K &key, RBTree &right);
+  void Join(RBTree &other);
+
+ public:
+  // Owns a value taken out of a tree by Extract until InsertNode links it
+  // into a tree again. In a NodePool the value stays in its node, which
+  // the hold keeps apart from the pool (see NodePool::Hold) and the next
+  // tree links as it is; an arena node is moved into the hold instead
+  class NodeHandle {
+   public:
+    Type *Get() const noexcept {
+      return hold_.Empty() ? nullptr : &hold_.Get()->val;
+    }
+    bool Empty() const noexcept { return hold_.Empty(); }
+    Allocator GetAllocator() const { return hold_.GetAllocator(); }
+
+   private:
+    friend class RBTree;
+    typename NodeStorage<Node<Type>, Allocator>::Hold hold_;
+  };
+
+  NodeHandle Extract(RBIterator pos);
+  // an InsertNode that links the node empties the handle, otherwise the
+  // handle keeps it
+  std::pair<RBIterator, bool> InsertNode(NodeHandle &node);
+  std::pair<RBIterator, bool> InsertNodeUnique(NodeHandle &node);
+  std::pair<RBIterator, bool> InsertNode(RBIterator hint, NodeHandle &node);
+  std::pair<RBIterator, bool> InsertNodeUnique(RBIterator hint,
+                                               NodeHandle &node);
+  // moves the nodes of other into this tree, or with MergeUnique the ones
+  // with keys this tree lacks, leaving the others in other
+  void Merge(RBTree &other);
+  void MergeUnique(RBTree &other);
+
+ public:
+  RBIterator Nth(size_t k) const noexcept;
+  template <typename K>
+  size_t Rank(const K &key) const;
+  template <typename K>
+  size_t CountRange(const K &lo, const K &hi) const;
+
+ public:
+  template <typename K>
+  std::pair<RBIterator, RBIterator> equal_range(const K &key) const;
+  template <typename K>
+  RBIterator lower_bound(const K &key) const;
+  template <typename K>
+  RBIterator upper_bound(const K &key) const;
+
+ public:
+  RBIterator begin() const;
+  RBIterator end() const;
+
+ private:
+  static Type &Value(NodeBase *node) noexcept;
+  static const KeyType &KeyOf(NodeBase *node) noexcept;
+
+  // what a search for K compares the keys of the nodes with
+  template <typename K>
+  using Probe =
+      std::conditional_t<IsTransparent<Compare>::value, K, KeyType>;
+
+  // whether a node is ordered against a K in one three-way comparison,
+  // otherwise the searches take a single Comp() call per level instead
+  template <typename K>
+  static constexpr bool kThreeWay =
+      HasThreeWay<Compare, KeyType, K>::value ||
+      ((kIsStdLess<Compare, KeyType> || kIsStdGreater<Compare, KeyType>) &&
+       HasCompareMember<KeyType, K>::value);
+  template <typename K>
+  int Compare3(NodeBase *node, const K &key) const;
+  // searches FindMany advances together, enough to keep a few cache misses
+  // in flight while staying in registers and the first level of cache
+  static constexpr size_t kFindLanes = 8;
+  NodeBase *Root() const noexcept;
+  NodeBase *Header() const noexcept;
+  LinkTable Links() const noexcept;
+  void ResetHeader() noexcept;
+  void StealHeader(RBTree &other) noexcept;
+  void ThreadEnds() noexcept;
+  void ThreadAll() noexcept;
+  void SetEnds() noexcept;
+  void CopyFrom(const RBTree &other);
+  void Clone(NodeBase *src, NodeBase *parent, bool toLeft);
+
+ private:
+  template <typename K>
+  NodeBase *Find(NodeBase *node, const K &key) const;
+  template <typename K>
+  NodeBase *LowerBound(NodeBase *node, NodeBase *result, const K &key) const;
+  template <typename K>
+  NodeBase *UpperBound(NodeBase *node, NodeBase *result, const K &key) const;
+  template <typename K>
+  NodeBase *LowerBoundAfter(NodeBase *node, const K &key) const;
+  size_t Index(NodeBase *node) const noexcept;
+  NodeBase *Grandfather(NodeBase *node);
+  NodeBase *Uncle(NodeBase *node);
+  bool HasRedSon(NodeBase *node);
+  bool LeftSon(NodeBase *node) const;
+  static size_t SizeOf(const NodeBase *node) noexcept;
+  static void UpdateSize(NodeBase *node) noexcept;
+
+ private:
+  void RightRotation(NodeBase *node);
+  void LeftRotation(NodeBase *node);
+  void ReplaceSon(NodeBase *node, NodeBase *son);
+  void SwapWithLeftMax(NodeBase *node, NodeBase *leftMax);
+
+ private:
+  // where a new value is linked: as the left or right son of parent (the
+  // header for an empty tree), unless a unique insert met an equal node
+  struct InsertPos {
+    NodeBase *parent;
+    bool toLeft;
+    NodeBase *equal;
+  };
+
+  InsertPos FindPos(const KeyType &key) const;
+  InsertPos FindUniquePos(const KeyType &key) const;
+  InsertPos FindLastPos(const KeyType &key) const;
+  InsertPos FindHintPos(NodeBase *hint, const KeyType &key) const;
+  InsertPos FindUniqueHintPos(NodeBase *hint, const KeyType &key) const;
+  InsertPos PosBetween(NodeBase *before, NodeBase *after) const;
+
+ private:
+  template <typename V>
+  std::pair<RBIterator, bool> InsertAt(InsertPos pos, V &&val);
+  template <typename FindPosFn>
+  std::pair<RBIterator, bool> EmplaceNode(NodeBase *node, FindPosFn findPos);
+  NodeBase *LinkNode(InsertPos pos, NodeBase *node);
+  void Unlink(NodeBase *node);
+  static void ResetLinks(NodeBase *node) noexcept;
+  template <typename FindPosFn>
+  std::pair<RBIterator, bool> LinkHandle(NodeHandle &node, FindPosFn findPos);
+  template <bool kUnique>
+  void MergeNodes(RBTree &other);
+  template <bool kUnique>
+  void MergeLinked(RBTree &other);
+  void Erase(NodeBase *node);
+
+ private:
+  // whether the nodes can change trees, which then share the chunks of
+  // their pools; otherwise Split and Join move the values one by one
+  static constexpr bool kCanShare =
+      NodeStorage<Node<Type>, Allocator>::kCanShare;
+  // no search path of a red-black tree is longer than twice the height
+  // of a perfect one
+  static constexpr size_t kMaxHeight = 2 * std::numeric_limits<size_t>::digits;
+  static size_t BlackHeight(const NodeBase *node) noexcept;
+  size_t JoinNodes(NodeBase *left, size_t leftHeight, NodeBase *mid,
+                   NodeBase *right, size_t rightHeight);
+  void MoveTail(RBIterator first, RBTree &to);
+  void MoveHead(RBIterator last, RBTree &to);
+
+ private:
+  bool BalanceAfterInsert(NodeBase *node);
+  void BalanceAfterErase(NodeBase *node, bool eraseLeftSon);
+
+ private:
+  void DestroyNodes(NodeBase *root) noexcept;
+  template <typename Fn>
+  static void ForEachNode(NodeBase *root, Fn fn);
+
+ private:
+  // walks a sorted range, stepping over the values same() as the previous
+  template <typename ForwardIt, typename Same>
+  struct SortedReader {
+    void Next() {
+      ForwardIt prev = first;
+      for (++first; first != last && same(*prev, *first);) ++first;
+    }
+
+    ForwardIt first;
+    ForwardIt last;
+    Same same;
+  };
+
+  template <typename Reader>
+  NodeBase *BuildSorted(Reader &reader, size_t n, size_t depth,
+                        size_t redDepth);
+
+ private:
+  // how many times this tree may hold the nodes of the other one and
+  // still be merged with it by rebuilding both, rather than by a search
+  // for each node of the other
+  static constexpr size_t kMergeRatio = 4;
+  // how many nodes ahead of the one it reaches a walk over a list of
+  // nodes prefetches
+  static constexpr size_t kLinkAhead = 16;
+  // subtrees ListNodes walks together, each one a chain of cache misses
+  // of its own that overlaps with the others
+  static constexpr size_t kListLanes = 16;
+  static void ListNodes(NodeBase *root, NodeBase **out) noexcept;
+  static NodeBase *BuildLinked(NodeBase *const *&next,
+                               NodeBase *const *last, size_t n, size_t depth,
+                               size_t redDepth) noexcept;
+  void LinkNodes(NodeBase *const *nodes, size_t n) noexcept;
+
+ private:
+  HeaderNode header_;
+  NodeStorage<Node<Type>, Allocator> pool_;
+};
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+RBTree<Type, Allocator, KeyOfValue, Compare>::RBTree() {
+  ResetHeader();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+RBTree<Type, Allocator, KeyOfValue, Compare>::RBTree(
+    const Allocator &alloc) : pool_(alloc) {
+  ResetHeader();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+RBTree<Type, Allocator, KeyOfValue, Compare>::RBTree(const Compare &comp,
+                                                     const Allocator &alloc)
+    : KeyCompare<Compare>(comp), pool_(alloc) {
+  ResetHeader();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+RBTree<Type, Allocator, KeyOfValue, Compare>::~RBTree() {
+  Clear();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+RBTree<Type, Allocator, KeyOfValue, Compare>::RBTree(const RBTree &m)
+    : KeyCompare<Compare>(m.Comp()),
+      pool_(std::allocator_traits<Allocator>::
+                select_on_container_copy_construction(m.GetAllocator())) {
+  ResetHeader();
+  CopyFrom(m);
+}
+
+// replaces the contents with a copy of m, the memory of the old nodes is
+// reused for the new ones before anything is allocated
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::operator=(const RBTree &m) {
+  if (this != &m) {
+    if constexpr (!std::is_trivially_destructible_v<Node<Type>>)
+      DestroyNodes(Root());
+    pool_.Rewind();
+    ResetHeader();
+    Comp() = m.Comp();
+    CopyFrom(m);
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::operator=(RBTree &&m) {
+  if (this != &m) {
+    Comp() = m.Comp();  // m stays usable, so it is not moved
+    Clear();
+    if (GetAllocator() == m.GetAllocator())
+      StealHeader(m);
+    else {  // nodes of a foreign allocator can not be adopted
+      // in order, each value goes right after the last one
+      for (auto it = m.begin(); it != m.end(); ++it)
+        Insert(end(), std::move(*it));
+      m.Clear();
+    }
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::operator==(const RBTree &m) {
+  return Root() == m.Root();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::operator!=(const RBTree &m) {
+  return Root() != m.Root();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Type &RBTree<Type, Allocator, KeyOfValue, Compare>::Value(
+    NodeBase *node) noexcept {
+  return static_cast<Node<Type> *>(node)->val;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+const typename RBTree<Type, Allocator, KeyOfValue, Compare>::KeyType &
+RBTree<Type, Allocator, KeyOfValue, Compare>::KeyOf(NodeBase *node) noexcept {
+  return KeyOfValue()(Value(node));
+}
+
+// below, equal to or above zero as the key of node orders before, together
+// with or after key; only for the K that kThreeWay allows
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+int RBTree<Type, Allocator, KeyOfValue, Compare>::Compare3(
+    NodeBase *node, const K &key) const {
+  if constexpr (HasThreeWay<Compare, KeyType, K>::value)
+    return Comp().compare(KeyOf(node), key);
+  else if constexpr (kIsStdLess<Compare, KeyType>)
+    return KeyOf(node).compare(key);
+  else {
+    int order = KeyOf(node).compare(key);
+    return order < 0 ? 1 : order > 0 ? -1 : 0;
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::Root() const noexcept {
+  return header_.Parent();
+}
+
+// what a walk down or up the tree follows the links of the nodes by,
+// taken once before it starts; no node may be created during the walk
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+LinkTable RBTree<Type, Allocator, KeyOfValue, Compare>::Links() const noexcept {
+#if defined(S21_INDEX_NODES)
+  return pool_.Table();
+#else
+  return {};
+#endif
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+NodeBase
+*RBTree<Type, Allocator, KeyOfValue, Compare>::Header() const noexcept {
+  return const_cast<HeaderNode *>(&header_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ResetHeader() noexcept {
+  header_ = HeaderNode();
+  header_.SetColor(color::RED);
+  header_.SetLeft(Header());
+  header_.SetRight(Header());
+#if defined(S21_THREADED_NODES)
+  header_.SetNext(Header());
+  header_.SetPrev(Header());
+#endif
+}
+
+// takes over the nodes of other together with the pool holding them, this
+// tree must be empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::StealHeader(
+    RBTree &other) noexcept {
+  if (other.Root()) {
+    header_ = other.header_;
+    Root()->SetParent(Header());
+    ThreadEnds();
+    pool_ = std::move(other.pool_);
+    other.ResetHeader();
+  }
+}
+
+// points the ends of the in-order ring at the header of this tree, after
+// the header has been copied from another one
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ThreadEnds() noexcept {
+#if defined(S21_THREADED_NODES)
+  header_.SetNext(header_.Left());
+  header_.SetPrev(header_.Right());
+  header_.Left()->SetPrev(Header());
+  header_.Right()->SetNext(Header());
+#endif
+}
+
+// links every node to its in-order neighbours in O(n), for trees built
+// without LinkNode; the walk climbs the tree as the iterators otherwise do
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ThreadAll() noexcept {
+#if defined(S21_THREADED_NODES)
+  NodeBase *prev = Header();
+  for (NodeBase *node = header_.Left(); node != Header();) {
+    prev->SetNext(node);
+    node->SetPrev(prev);
+    prev = node;
+    if (node->Right()) {
+      for (node = node->Right(); node->Left();) node = node->Left();
+    } else {
+      NodeBase *parent = node->Parent();
+      while (parent != Header() && parent->Right() == node) {
+        node = parent;
+        parent = parent->Parent();
+      }
+      node = parent;
+    }
+  }
+  prev->SetNext(Header());
+  header_.SetPrev(prev);
+#endif
+}
+
+// points the header at the minimum and the maximum under the root, which
+// must not be empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::SetEnds() noexcept {
+  NodeBase *node = Root();
+  while (node->Left()) node = node->Left();
+  header_.SetLeft(node);
+  for (node = Root(); node->Right();) node = node->Right();
+  header_.SetRight(node);
+}
+
+// builds a copy of other with the same shape and colors in O(n) without
+// comparing any values, this tree must be empty
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::CopyFrom(
+    const RBTree &other) {
+  if (!other.Root()) return;
+
+  try {
+    Clone(other.Root(), Header(), false);
+  } catch (...) {
+    Clear();
+    throw;
+  }
+
+  SetEnds();
+  ThreadAll();
+}
+
+// copies the subtree src as the left or right son of parent, or as the
+// root when parent is the header; every node is linked as soon as it is
+// made, so a throwing copy leaves a valid tree to clear. Left spines are
+// walked in a loop, only right sons recurse
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Clone(NodeBase *src,
+                                                         NodeBase *parent,
+                                                         bool toLeft) {
+  while (src) {
+    NodeBase *node =
+        pool_.Create(src->Color(), parent, nullptr, nullptr, Value(src));
+    node->size = src->size;
+    if (parent == Header())
+      header_.SetParent(node);
+    else if (toLeft)
+      parent->SetLeft(node);
+    else
+      parent->SetRight(node);
+    Clone(src->Right(), node, false);
+    parent = node;
+    toLeft = true;
+    src = src->Left();
+  }
+}
+
+// makes a subtree of the next n values of reader with red nodes at redDepth
+// (never the root); a throwing call destroys what it has built so far
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename Reader>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::BuildSorted(
+    Reader &reader, size_t n, size_t depth, size_t redDepth) {
+  if (!n) return nullptr;
+
+  size_t leftSize = n / 2;
+  NodeBase *left = BuildSorted(reader, leftSize, depth + 1, redDepth);
+  NodeBase *node = nullptr;
+  try {
+    color c = depth && depth == redDepth ? color::RED : color::BLACK;
+    node = pool_.Create(c, nullptr, left, nullptr, *reader.first);
+    if (left) left->SetParent(node);
+    node->size = n;
+    reader.Next();
+    node->SetRight(BuildSorted(reader, n - leftSize - 1, depth + 1, redDepth));
+    if (node->Right()) node->Right()->SetParent(node);
+  } catch (...) {
+    DestroyNodes(node ? node : left);
+    throw;
+  }
+
+  return node;
+}
+
+// Writes the nodes under root to out in order. A walk in order waits for
+// every node it reaches, so the tree is cut into up to kListLanes subtrees
+// and the nodes between them, and the subtrees are walked in turns, a
+// step of each at a time: a step prefetches the node it moves to and
+// reads it only on the next turn of its subtree. The size of a left
+// subtree tells where in out the nodes of the next one go
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ListNodes(
+    NodeBase *root, NodeBase **out) noexcept {
+  struct Lane {
+    NodeBase *node;
+    NodeBase **out;
+    size_t depth;
+    NodeBase *path[kMaxHeight];
+  };
+
+  // the largest subtree is cut each time, so they come out about as large
+  NodeBase *roots[kListLanes];
+  NodeBase **outs[kListLanes];
+  size_t active = 0;
+  if (root) {
+    roots[0] = root;
+    outs[0] = out;
+    active = 1;
+  }
+  while (active && active < kListLanes) {
+    size_t cut = 0;
+    for (size_t i = 1; i < active; ++i)
+      if (roots[i]->size > roots[cut]->size) cut = i;
+    NodeBase *node = roots[cut];
+    if (node->size == 1) break;
+    NodeBase **at = outs[cut];
+    size_t leftSize = SizeOf(node->Left());
+    at[leftSize] = node;
+    if (!node->Left()) {
+      roots[cut] = node->Right();
+      outs[cut] = at + 1;
+      continue;
+    }
+    roots[cut] = node->Left();
+    if (node->Right()) {
+      roots[active] = node->Right();
+      outs[active++] = at + leftSize + 1;
+    }
+  }
+
+  Lane lanes[kListLanes];
+  for (size_t i = 0; i < active; ++i) {
+    lanes[i].node = roots[i];
+    lanes[i].out = outs[i];
+    lanes[i].depth = 0;
+    Prefetch(lanes[i].node);
+  }
+  // a step reads the node prefetched on the last turn, writes out the
+  // nodes up to the next one the walk has not read yet and prefetches it
+  for (size_t walking = active; walking;) {
+    for (size_t i = 0; i < active; ++i) {
+      Lane &lane = lanes[i];
+      if (!lane.node) continue;
+      lane.path[lane.depth++] = lane.node;
+      NodeBase *next = lane.node->Left();
+      while (!next && lane.depth) {
+        NodeBase *node = lane.path[--lane.depth];
+        *lane.out++ = node;
+        next = node->Right();
+      }
+      lane.node = next;
+      if (next)
+        Prefetch(next);
+      else
+        --walking;
+    }
+  }
+}
+
+// as BuildSorted, but links the next n nodes of the list [next, last)
+// instead of making new ones; the nodes are taken in order, so the ones a
+// few places on are prefetched
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::BuildLinked(
+    NodeBase *const *&next, NodeBase *const *last, size_t n, size_t depth,
+    size_t redDepth) noexcept {
+  if (!n) return nullptr;
+
+  size_t leftSize = n / 2;
+  NodeBase *left = BuildLinked(next, last, leftSize, depth + 1, redDepth);
+  if (last - next > static_cast<std::ptrdiff_t>(kLinkAhead))
+    Prefetch(next[kLinkAhead]);
+  NodeBase *node = *next++;
+  node->SetColor(depth && depth == redDepth ? color::RED : color::BLACK);
+  node->SetLeft(left);
+  if (left) left->SetParent(node);
+  node->size = n;
+  node->SetRight(
+      BuildLinked(next, last, n - leftSize - 1, depth + 1, redDepth));
+  if (node->Right()) node->Right()->SetParent(node);
+
+  return node;
+}
+
+// makes the n nodes of the sorted list nodes the whole tree, in the shape
+// AssignSorted gives it; the links the tree had before are dropped
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::LinkNodes(
+    NodeBase *const *nodes, size_t n) noexcept {
+  ResetHeader();
+  if (!n) return;
+
+  size_t lastLevel = 0;
+  for (size_t m = n; m > 1; m /= 2) ++lastLevel;
+  NodeBase *const *next = nodes;
+  header_.SetParent(BuildLinked(next, nodes + n, n, 0, lastLevel));
+  Root()->SetParent(Header());
+
+  header_.SetLeft(nodes[0]);
+  header_.SetRight(nodes[n - 1]);
+  ThreadAll();
+}
+
+// runs the destructors of the values under root, the memory itself is left
+// to the pool
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::DestroyNodes(
+    NodeBase *root) noexcept {
+  NodeBase *node = root;
+
+  // unlinks and destroys leaves bottom-up, so no recursion is needed
+  while (node) {
+    if (node->Left())
+      node = node->Left();
+    else if (node->Right())
+      node = node->Right();
+    else {
+      NodeBase *parent = node == root ? nullptr : node->Parent();
+      if (parent) {
+        if (LeftSon(node))
+          parent->SetLeft(nullptr);
+        else
+          parent->SetRight(nullptr);
+      }
+      static_cast<Node<Type> *>(node)->~Node();
+      node = parent;
+    }
+  }
+}
+
+// calls fn on every node under root, in no particular order; the stack
+// holds a right son for each left turn taken, so no more than the height
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename Fn>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ForEachNode(NodeBase *root,
+                                                               Fn fn) {
+  NodeBase *stack[kMaxHeight];
+  size_t top = 0;
+  for (NodeBase *node = root; node || top;) {
+    if (!node) node = stack[--top];
+    fn(node);
+    if (node->Left() && node->Right()) stack[top++] = node->Right();
+    node = node->Left() ? node->Left() : node->Right();
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Clear() {
+  if constexpr (!std::is_trivially_destructible_v<Node<Type>>)
+    DestroyNodes(Root());
+  pool_.Release();
+  ResetHeader();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Swap(RBTree &other) {
+  std::swap(header_, other.header_);
+  if (Root()) {
+    Root()->SetParent(Header());
+    ThreadEnds();
+  } else
+    ResetHeader();
+  if (other.Root()) {
+    other.Root()->SetParent(other.Header());
+    other.ThreadEnds();
+  } else
+    other.ResetHeader();
+  pool_.Swap(other.pool_);
+  std::swap(Comp(), other.Comp());
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Allocator
+RBTree<Type, Allocator, KeyOfValue, Compare>::GetAllocator() const noexcept {
+  return pool_.GetAllocator();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+Compare RBTree<Type, Allocator, KeyOfValue, Compare>::GetCompare() const {
+  return Comp();
+}
+
+// inserts a copy or move of val after the values equal to it
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::Insert(V &&val) {
+  return InsertAt(FindLastPos(KeyOfValue()(val)), std::forward<V>(val));
+}
+
+// inserts val unless an equal value is present, in a single descent that
+// ends either at the equal node or at the free spot for val
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertUnique(V &&val) {
+  return InsertAt(FindUniquePos(KeyOfValue()(val)), std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::Insert(RBIterator hint, V &&val) {
+  return InsertAt(FindHintPos(hint.iter_, KeyOfValue()(val)),
+                  std::forward<V>(val));
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertUnique(
+    RBIterator hint, V &&val) {
+  return InsertAt(FindUniqueHintPos(hint.iter_, KeyOfValue()(val)),
+                  std::forward<V>(val));
+}
+
+// the Emplace family builds the value inside a new node from args and only
+// then looks for its place, a unique emplace of a present value drops it
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::Emplace(Args &&...args) {
+  return EmplaceNode(
+      pool_.Create(color::RED, nullptr, nullptr, nullptr,
+                   std::forward<Args>(args)...),
+      [this](const KeyType &key) { return FindLastPos(key); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::EmplaceUnique(Args &&...args) {
+  return EmplaceNode(
+      pool_.Create(color::RED, nullptr, nullptr, nullptr,
+                   std::forward<Args>(args)...),
+      [this](const KeyType &key) { return FindUniquePos(key); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::EmplaceHint(
+    RBIterator hint, Args &&...args) {
+  return EmplaceNode(
+      pool_.Create(color::RED, nullptr, nullptr, nullptr,
+                   std::forward<Args>(args)...),
+      [this, hint](const KeyType &key) {
+        return FindHintPos(hint.iter_, key);
+      });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename... Args>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::EmplaceHintUnique(
+    RBIterator hint, Args &&...args) {
+  return EmplaceNode(pool_.Create(color::RED, nullptr, nullptr, nullptr,
+                                  std::forward<Args>(args)...),
+                     [this, hint](const KeyType &key) {
+                       return FindUniqueHintPos(hint.iter_, key);
+                     });
+}
+
+// replaces the contents with the sorted range [first, last), skipping the
+// values for which same(previous, value) holds. The tree is built perfectly
+// balanced in O(n): every level is black except a partial last one, which
+// is red, so no comparisons or rotations are needed
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename InputIt, typename Same>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::AssignSorted(
+    InputIt first, InputIt last, Same same) {
+  using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+  if constexpr (!std::is_base_of_v<std::forward_iterator_tag, Category>) {
+    // the length of a single pass range is only known after reading it
+    s21::vector<Type> buffer;
+    for (; first != last; ++first) buffer.push_back(*first);
+    AssignSorted(buffer.begin(), buffer.end(), same);
+  } else {
+    Clear();
+    if (first == last) return;
+
+    SortedReader<InputIt, Same> reader{first, last, same};
+    size_t n = 0;
+    for (SortedReader<InputIt, Same> it = reader; it.first != last; it.Next())
+      ++n;
+    size_t lastLevel = 0;
+    for (size_t m = n; m > 1; m /= 2) ++lastLevel;
+
+    try {
+      header_.SetParent(BuildSorted(reader, n, 0, lastLevel));
+    } catch (...) {
+      Clear();
+      throw;
+    }
+    Root()->SetParent(Header());
+
+    SetEnds();
+    ThreadAll();
+  }
+}
+
+// Moves the values not ordered before key to right, which must be empty.
+// The tree is cut along the search path for key: bottom-up, every node of
+// the path is joined with the subtree hanging off it to the side it goes
+// to and with what the lower nodes have gathered there. Each join costs
+// the difference of the black heights it bridges, and these add up to the
+// height of the tree, so the cut takes O(log n) and no node is copied.
+// The pool goes to the larger part. When the smaller one, of k nodes,
+// has fewer nodes than the pool has chunks c, it gets a pool that holds
+// only the chunks its nodes are in, found in O(k log n), so that a small
+// part does not keep the memory of the other; otherwise it shares every
+// chunk, in O(c log c), so the split takes O(log n + min(k, c) log n).
+// Nodes that can not change pools, those of an arena or of trees with
+// unequal allocators, are moved value by value instead: the smaller part
+// when the allocators are equal, the moved values to right otherwise
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Split(const K &key,
+                                                         RBTree &right) {
+  const Probe<K> &probe = key;
+  if (!Root() || Comp()(KeyOf(header_.Right()), probe)) return;
+
+  bool canShare = false;
+  if constexpr (kCanShare) canShare = GetAllocator() == right.GetAllocator();
+  if (!canShare) {
+    // the values are moved one by one, so with an equal allocator the
+    // smaller part moves and the trees are swapped after
+    RBIterator first = lower_bound(probe);
+    if (GetAllocator() == right.GetAllocator() &&
+        2 * Index(first.iter_) < Size()) {
+      MoveHead(first, right);
+      Swap(right);
+    } else
+      MoveTail(first, right);
+    return;
+  }
+  if (!Comp()(KeyOf(header_.Left()), probe)) {
+    right.StealHeader(*this);
+    return;
+  }
+
+  // the path is found before anything moves, so that a throwing
+  // comparison leaves the tree as it was
+  NodeBase *path[kMaxHeight];
+  bool toLeft[kMaxHeight];  // whether the node stays in this tree
+  size_t depth = 0;
+  for (NodeBase *node = Root(); node; ++depth) {
+    path[depth] = node;
+    toLeft[depth] = Comp()(KeyOf(node), probe);
+    node = toLeft[depth] ? node->Right() : node->Left();
+  }
+
+  if constexpr (kCanShare) {
+    size_t rightSize = 0;
+    for (size_t i = 0; i < depth; ++i)
+      if (!toLeft[i]) rightSize += 1 + SizeOf(path[i]->Right());
+    const bool rightSmaller = 2 * rightSize <= Size();
+    const size_t smallerSize = rightSmaller ? rightSize : Size() - rightSize;
+    auto visit = [&](auto fn) {
+      auto visitNode = [&](NodeBase *node) {
+        fn(static_cast<Node<Type> *>(node));
+      };
+      for (size_t i = 0; i < depth; ++i)
+        if (toLeft[i] != rightSmaller) {
+          visitNode(path[i]);
+          ForEachNode(toLeft[i] ? path[i]->Left() : path[i]->Right(),
+                      visitNode);
+        }
+    };
+    if (rightSmaller)
+      right.pool_.Divide(pool_, smallerSize, visit);
+    else {
+      pool_.Swap(right.pool_);
+      try {
+        pool_.Divide(right.pool_, smallerSize, visit);
+      } catch (...) {
+        pool_.Swap(right.pool_);
+        throw;
+      }
+    }
+  }
+  ResetHeader();
+  size_t leftHeight = 0;
+  size_t rightHeight = 0;
+  for (size_t sonHeight = 0; depth--;) {
+    NodeBase *node = path[depth];
+    size_t height = sonHeight + (node->Color() == color::BLACK);
+    if (toLeft[depth])
+      leftHeight =
+          JoinNodes(node->Left(), sonHeight, node, Root(), leftHeight);
+    else
+      rightHeight = right.JoinNodes(right.Root(), rightHeight, node,
+                                    node->Right(), sonHeight);
+    sonHeight = height;
+  }
+
+  SetEnds();
+  ThreadEnds();
+  right.SetEnds();
+  right.ThreadEnds();
+}
+
+// Appends the values of other, which must all order after the values of
+// this tree or together with the last of them, and leaves other empty. The
+// first node of other becomes the middle of a single join, in O(log n),
+// after which this tree holds the chunks of the pool of other as well,
+// with its free slots; merging the lists of chunks takes O(c log c) for
+// the c chunks of both pools
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Join(RBTree &other) {
+  if (this == &other || !other.Root()) return;
+
+  bool canShare = GetAllocator() == other.GetAllocator();
+  if (canShare && !Root()) {
+    Clear();
+    StealHeader(other);
+    return;
+  }
+  if constexpr (!kCanShare) canShare = false;
+  if (!canShare) {
+    // the smaller tree moves, as in Split
+    if (GetAllocator() == other.GetAllocator() && Size() < other.Size()) {
+      Swap(other);
+      other.MoveHead(other.end(), *this);
+    } else
+      other.MoveTail(other.begin(), *this);
+    return;
+  }
+
+  if constexpr (kCanShare) {
+    pool_.Share(other.pool_);
+    NodeBase *mid = other.header_.Left();
+    NodeBase *first = header_.Left();
+    NodeBase *last = other.header_.Right();
+#if defined(S21_THREADED_NODES)
+    NodeBase *before = header_.Right();
+    NodeBase *after = mid->Next();
+#endif
+    other.Unlink(mid);
+    JoinNodes(Root(), BlackHeight(Root()), mid, other.Root(),
+              BlackHeight(other.Root()));
+    header_.SetLeft(first);
+    header_.SetRight(last);
+#if defined(S21_THREADED_NODES)
+    before->SetNext(mid);
+    mid->SetPrev(before);
+    if (after != other.Header()) {
+      mid->SetNext(after);
+      after->SetPrev(mid);
+    }
+#endif
+    ThreadEnds();
+    pool_.TakeOver(other.pool_);
+    other.ResetHeader();
+  }
+}
+
+// unlinks the node at pos and hands it to the returned handle
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::NodeHandle
+RBTree<Type, Allocator, KeyOfValue, Compare>::Extract(RBIterator pos) {
+  Node<Type> *node = static_cast<Node<Type> *>(pos.iter_);
+  Unlink(node);
+
+  NodeHandle handle;
+  try {
+    handle.hold_ = pool_.Keep(node);
+  } catch (...) {
+    pool_.Destroy(node);
+    throw;
+  }
+  return handle;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertNode(NodeHandle &node) {
+  return LinkHandle(node,
+                    [this](const KeyType &key) { return FindLastPos(key); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertNodeUnique(
+    NodeHandle &node) {
+  return LinkHandle(node,
+                    [this](const KeyType &key) { return FindUniquePos(key); });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertNode(RBIterator hint,
+                                                         NodeHandle &node) {
+  return LinkHandle(node, [this, hint](const KeyType &key) {
+    return FindHintPos(hint.iter_, key);
+  });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertNodeUnique(
+    RBIterator hint, NodeHandle &node) {
+  return LinkHandle(node, [this, hint](const KeyType &key) {
+    return FindUniqueHintPos(hint.iter_, key);
+  });
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Merge(RBTree &other) {
+  MergeNodes<false>(other);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::MergeUnique(
+    RBTree &other) {
+  MergeNodes<true>(other);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::Contains(
+    const K &key) const {
+  return Find(key) != end();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::Count(const K &key) const {
+  std::pair<RBIterator, RBIterator> range = equal_range(key);
+
+  return Index(range.second.iter_) - Index(range.first.iter_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator
+RBTree<Type, Allocator, KeyOfValue, Compare>::Find(const K &key) const {
+  NodeBase *result = nullptr;
+
+  if (Root()) result = Find<Probe<K>>(Root(), key);
+
+  return result ? result : end();
+}
+
+// Appends to out the result of Find for every key of [first, last), the
+// first of the equal values for a multiset. Ascending keys are searched
+// from the previous result, which only climbs as far as the distance to
+// the next one. Other keys are searched kFindLanes at a time: each round
+// moves every search one level down and prefetches the node it reaches,
+// so the cache misses of the searches overlap instead of following one
+// another. Keys that would need converting to KeyType on every comparison
+// are searched one by one.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename ForwardIt>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::FindMany(
+    ForwardIt first, ForwardIt last, s21::vector<RBIterator> &out) const {
+  using Reference = decltype(*first);
+  using K = std::decay_t<Reference>;
+  constexpr bool kInPlace = std::is_lvalue_reference_v<Reference> &&
+                            std::is_same_v<Probe<K>, K>;
+
+  auto isResult = [this](NodeBase *lower, const Probe<K> &probe) {
+    return lower != Header() && !Comp()(probe, KeyOf(lower));
+  };
+
+  const size_t base = out.size();
+  bool ascending = true;
+  for (ForwardIt it = first, prev = first; it != last; prev = it++) {
+    if (ascending && it != first) {
+      const Probe<K> &probe = *it;
+      const Probe<K> &prevProbe = *prev;
+      ascending = !Comp()(probe, prevProbe);
+    }
+    out.push_back(end());
+  }
+
+  if (!kInPlace || ascending) {
+    NodeBase *lower = nullptr;
+    for (size_t i = base; first != last; ++first, ++i) {
+      const Probe<K> &probe = *first;
+      lower = ascending && lower ? LowerBoundAfter(lower, probe)
+                                 : LowerBound(Root(), Header(), probe);
+      if (isResult(lower, probe)) out[i] = RBIterator(lower);
+    }
+    return;
+  }
+
+  if constexpr (kInPlace) {
+    const LinkTable links = Links();
+    NodeBase *nodes[kFindLanes];
+    NodeBase *lowers[kFindLanes];
+    const K *keys[kFindLanes];
+    size_t slots[kFindLanes];
+    size_t lanes = 0;
+    size_t next = base;
+
+    for (; lanes < kFindLanes && first != last; ++lanes, ++first) {
+      nodes[lanes] = Root();
+      lowers[lanes] = Header();
+      keys[lanes] = std::addressof(*first);
+      slots[lanes] = next++;
+    }
+
+    while (lanes) {
+      for (size_t i = 0; i < lanes;) {
+        NodeBase *node = nodes[i];
+        if (node) {
+          bool right = Comp()(KeyOf(node), *keys[i]);
+          if (!right) lowers[i] = node;
+          nodes[i] = node = right ? node->Right(links) : node->Left(links);
+          if (node) Prefetch(node);
+          ++i;
+          continue;
+        }
+
+        // the search of lane i is over, it takes the next key or the last
+        // lane takes its place
+        if (isResult(lowers[i], *keys[i])) out[slots[i]] = lowers[i];
+        if (first != last) {
+          nodes[i] = Root();
+          lowers[i] = Header();
+          keys[i] = std::addressof(*first++);
+          slots[i] = next++;
+        } else {
+          --lanes;
+          nodes[i] = nodes[lanes];
+          lowers[i] = lowers[lanes];
+          keys[i] = keys[lanes];
+          slots[i] = slots[lanes];
+        }
+      }
+    }
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Erase(const Type &val) {
+  NodeBase *erasedNode = Root() ? Find(Root(), KeyOfValue()(val)) : nullptr;
+
+  if (erasedNode) Erase(erasedNode);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Erase(RBIterator node) {
+  if (node) Erase(node.iter_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::Empty() const noexcept {
+  return Root() == nullptr;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::Size() const noexcept {
+  return SizeOf(Root());
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator
+RBTree<Type, Allocator, KeyOfValue, Compare>::Nth(size_t k) const noexcept {
+  const LinkTable links = Links();
+  NodeBase *node = Root();
+
+  while (node) {
+    size_t leftSize = SizeOf(node->Left(links));
+    if (k < leftSize)
+      node = node->Left(links);
+    else if (k == leftSize)
+      return node;
+    else {
+      k -= leftSize + 1;
+      node = node->Right(links);
+    }
+  }
+
+  return end();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::Rank(const K &key) const {
+  const LinkTable links = Links();
+  const Probe<K> &probe = key;
+  size_t result = 0;
+  NodeBase *node = Root();
+
+  while (node) {
+    if (Comp()(KeyOf(node), probe)) {
+      result += SizeOf(node->Left(links)) + 1;
+      node = node->Right(links);
+    } else
+      node = node->Left(links);
+  }
+
+  return result;
+}
+
+// number of elements in [lo, hi)
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::CountRange(
+    const K &lo, const K &hi) const {
+  size_t loRank = Rank(lo);
+  size_t hiRank = Rank(hi);
+
+  return hiRank > loRank ? hiRank - loRank : 0;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator>
+RBTree<Type, Allocator, KeyOfValue, Compare>::equal_range(const K &key) const {
+  const LinkTable links = Links();
+  const Probe<K> &probe = key;
+  NodeBase *upper = Header();
+  NodeBase *node = Root();
+
+  // descend together until the key is met, then finish both bounds apart
+  while (node) {
+    int order;
+    if constexpr (kThreeWay<Probe<K>>)
+      order = Compare3(node, probe);
+    else
+      order = Comp()(KeyOf(node), probe)   ? -1
+              : Comp()(probe, KeyOf(node)) ? 1
+                                           : 0;
+
+    if (order < 0)
+      node = node->Right(links);
+    else if (order > 0) {
+      upper = node;
+      node = node->Left(links);
+    } else
+      return {LowerBound(node->Left(links), node, probe),
+              UpperBound(node->Right(links), upper, probe)};
+  }
+
+  return {upper, upper};
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator
+RBTree<Type, Allocator, KeyOfValue, Compare>::lower_bound(const K &key) const {
+  return LowerBound<Probe<K>>(Root(), Header(), key);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator
+RBTree<Type, Allocator, KeyOfValue, Compare>::upper_bound(const K &key) const {
+  return UpperBound<Probe<K>>(Root(), Header(), key);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator
+RBTree<Type, Allocator, KeyOfValue, Compare>::begin() const {
+  return header_.Left();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator
+RBTree<Type, Allocator, KeyOfValue, Compare>::end() const {
+  return Header();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::Find(
+    NodeBase *node, const K &key) const {
+  if constexpr (kThreeWay<K>) {
+    const LinkTable links = Links();
+    while (node) {
+      int order = Compare3(node, key);
+      if (order == 0) break;
+      node = order < 0 ? node->Right(links) : node->Left(links);
+    }
+
+    return node;
+  } else {
+    // only the lower bound can be equal to key, so it alone is compared
+    // both ways, every other level takes one comparison
+    NodeBase *lower = LowerBound(node, nullptr, key);
+
+    return lower && !Comp()(key, KeyOf(lower)) ? lower : nullptr;
+  }
+}
+
+// first node of the subtree not less than key, result if there is none
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::LowerBound(
+    NodeBase *node, NodeBase *result, const K &key) const {
+  const LinkTable links = Links();
+  while (node) {
+    if (Comp()(KeyOf(node), key))
+      node = node->Right(links);
+    else {
+      result = node;
+      node = node->Left(links);
+    }
+  }
+
+  return result;
+}
+
+// first node of the subtree greater than key, result if there is none
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::UpperBound(
+    NodeBase *node, NodeBase *result, const K &key) const {
+  const LinkTable links = Links();
+  while (node) {
+    if (Comp()(key, KeyOf(node))) {
+      result = node;
+      node = node->Left(links);
+    } else
+      node = node->Right(links);
+  }
+
+  return result;
+}
+
+// The first node not less than key, given node, the same for a key not
+// after it. What follows node in order is its right subtree, then the
+// nearest ancestor it lies left of and that ancestor's right subtree, and
+// so on up; the search climbs only until such an ancestor is not less
+// than key, then descends into the right subtree it passed.
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename K>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::LowerBoundAfter(
+    NodeBase *node, const K &key) const {
+  if (node == Header() || !Comp()(KeyOf(node), key)) return node;
+
+  for (;;) {
+    NodeBase *child = node;
+    NodeBase *parent = node->Parent();
+    while (parent != Header() && parent->Right() == child) {
+      child = parent;
+      parent = parent->Parent();
+    }
+    if (parent == Header() || !Comp()(KeyOf(parent), key))
+      return LowerBound(node->Right(), parent, key);
+    node = parent;
+  }
+}
+
+// in-order position of node, Size() for the header
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::Index(
+    NodeBase *node) const noexcept {
+  if (node == Header()) return Size();
+
+  size_t result = SizeOf(node->Left());
+  for (; node != Root(); node = node->Parent())
+    if (!LeftSon(node)) result += SizeOf(node->Parent()->Left()) + 1;
+
+  return result;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::Grandfather(
+    NodeBase *node) {
+  return node->Parent()->Parent();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::Uncle(NodeBase *node) {
+  NodeBase *grandfather = Grandfather(node);
+
+  return grandfather->Left() == node->Parent() ? grandfather->Right()
+                                           : grandfather->Left();
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::SizeOf(
+    const NodeBase *node) noexcept {
+  return node ? node->size : 0;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::UpdateSize(
+    NodeBase *node) noexcept {
+  node->size = SizeOf(node->Left()) + SizeOf(node->Right()) + 1;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::HasRedSon(NodeBase *node) {
+  bool result = false;
+
+  if ((node->Right() && node->Right()->Color() == color::RED) ||
+      (node->Left() && node->Left()->Color() == color::RED))
+    result = true;
+
+  return result;
+}
+
+// puts son in place of node under node's parent (or as the root)
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ReplaceSon(
+    NodeBase *node, NodeBase *son) {
+  if (node == Root())
+    header_.SetParent(son);
+  else if (LeftSon(node))
+    node->Parent()->SetLeft(son);
+  else
+    node->Parent()->SetRight(son);
+  if (son) son->SetParent(node->Parent());
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::RightRotation(
+    NodeBase *node) {
+  NodeBase *son = node->Left();
+  ReplaceSon(node, son);
+  node->SetLeft(son->Right());
+  if (node->Left()) node->Left()->SetParent(node);
+  son->SetRight(node);
+  node->SetParent(son);
+  son->size = node->size;
+  UpdateSize(node);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::LeftRotation(
+    NodeBase *node) {
+  NodeBase *son = node->Right();
+  ReplaceSon(node, son);
+  node->SetRight(son->Left());
+  if (node->Right()) node->Right()->SetParent(node);
+  son->SetLeft(node);
+  node->SetParent(son);
+  son->size = node->size;
+  UpdateSize(node);
+}
+
+// the root's parent is the header, whose left is the leftmost node, so the
+// root must never be passed here
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::LeftSon(
+    NodeBase *node) const {
+  return node->Parent()->Left() == node;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+RBTree<Type, Allocator, KeyOfValue, Compare>::FindPos(
+    const KeyType &key) const {
+  const LinkTable links = Links();
+  InsertPos pos{Header(), true, nullptr};
+
+  for (NodeBase *node = Root(); node;) {
+    pos.parent = node;
+    pos.toLeft = !(Comp()(KeyOf(node), key));
+    node = pos.toLeft ? node->Left(links) : node->Right(links);
+  }
+
+  return pos;
+}
+
+// as FindPos, but after the nodes equal to key rather than before them
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+RBTree<Type, Allocator, KeyOfValue, Compare>::FindLastPos(
+    const KeyType &key) const {
+  const LinkTable links = Links();
+  InsertPos pos{Header(), true, nullptr};
+
+  for (NodeBase *node = Root(); node;) {
+    pos.parent = node;
+    pos.toLeft = Comp()(key, KeyOf(node));
+    node = pos.toLeft ? node->Left(links) : node->Right(links);
+  }
+
+  return pos;
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+RBTree<Type, Allocator, KeyOfValue, Compare>::FindUniquePos(
+    const KeyType &key) const {
+  const LinkTable links = Links();
+  InsertPos pos{Header(), true, nullptr};
+
+  if constexpr (kThreeWay<KeyType>) {
+    for (NodeBase *node = Root(); node && !pos.equal;) {
+      int order = Compare3(node, key);
+      if (order < 0) {
+        pos = {node, false, nullptr};
+        node = node->Right(links);
+      } else if (order > 0) {
+        pos = {node, true, nullptr};
+        node = node->Left(links);
+      } else
+        pos.equal = node;
+    }
+  } else {
+    for (NodeBase *node = Root(); node;) {
+      pos.toLeft = Comp()(key, KeyOf(node));
+      pos.parent = node;
+      node = pos.toLeft ? node->Left(links) : node->Right(links);
+    }
+
+    // an equal key can only be the one right before the place found
+    NodeBase *before = pos.parent;
+    if (pos.toLeft) {
+      if (before == header_.Left()) return pos;
+      before = (--RBIterator(before)).iter_;
+    }
+    if (!Comp()(KeyOf(before), key)) pos.equal = before;
+  }
+
+  return pos;
+}
+
+// the place right before hint if key belongs there, where only the
+// neighbour of hint has to be compared; a full descent otherwise
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+RBTree<Type, Allocator, KeyOfValue, Compare>::FindHintPos(
+    NodeBase *hint, const KeyType &key) const {
+  if (hint == Header()) {
+    if (Root() && !(Comp()(key, KeyOf(header_.Right()))))
+      return {header_.Right(), false, nullptr};
+  } else if (!(Comp()(KeyOf(hint), key))) {
+    if (hint == header_.Left()) return {hint, true, nullptr};
+    NodeBase *before = (--RBIterator(hint)).iter_;
+    if (!(Comp()(key, KeyOf(before)))) return PosBetween(before, hint);
+  } else {
+    NodeBase *after = (++RBIterator(hint)).iter_;
+    if (after == Header() || !(Comp()(KeyOf(after), key)))
+      return PosBetween(hint, after);
+  }
+
+  return FindPos(key);
+}
+
+// as FindHintPos, but stops at a node equal to key
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+RBTree<Type, Allocator, KeyOfValue, Compare>::FindUniqueHintPos(
+    NodeBase *hint, const KeyType &key) const {
+  if (hint == Header()) {
+    if (Root() && Comp()(KeyOf(header_.Right()), key))
+      return {header_.Right(), false, nullptr};
+  } else if (Comp()(key, KeyOf(hint))) {
+    if (hint == header_.Left()) return {hint, true, nullptr};
+    NodeBase *before = (--RBIterator(hint)).iter_;
+    if (Comp()(KeyOf(before), key)) return PosBetween(before, hint);
+  } else if (Comp()(KeyOf(hint), key)) {
+    NodeBase *after = (++RBIterator(hint)).iter_;
+    if (after == Header() || Comp()(key, KeyOf(after)))
+      return PosBetween(hint, after);
+  } else
+    return {hint, true, hint};
+
+  return FindUniquePos(key);
+}
+
+// the place between the neighbouring nodes before and after (which may be
+// the header); one of them always has a free son on the facing side
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+typename RBTree<Type, Allocator, KeyOfValue, Compare>::InsertPos
+RBTree<Type, Allocator, KeyOfValue, Compare>::PosBetween(
+    NodeBase *before, NodeBase *after) const {
+  return before->Right() ? InsertPos{after, true, nullptr}
+                       : InsertPos{before, false, nullptr};
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename V>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::InsertAt(InsertPos pos, V &&val) {
+  if (pos.equal) return {pos.equal, false};
+
+  return {LinkNode(pos, pool_.Create(color::RED, nullptr, nullptr, nullptr,
+                                     std::forward<V>(val))),
+          true};
+}
+
+// links the already built node at the place findPos gives for its value,
+// or destroys it when that place is taken by an equal node
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename FindPosFn>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::EmplaceNode(
+    NodeBase *node, FindPosFn findPos) {
+  InsertPos pos{};
+  try {
+    pos = findPos(KeyOf(node));
+  } catch (...) {
+    pool_.Destroy(static_cast<Node<Type> *>(node));
+    throw;
+  }
+  if (pos.equal) {
+    pool_.Destroy(static_cast<Node<Type> *>(node));
+    return {pos.equal, false};
+  }
+
+  return {LinkNode(pos, node), true};
+}
+
+// makes node a son of pos.parent, counts it in the sizes above and
+// restores the balance
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+NodeBase *RBTree<Type, Allocator, KeyOfValue, Compare>::LinkNode(
+    InsertPos pos, NodeBase *node) {
+  NodeBase *parent = pos.parent;
+
+  node->SetParent(parent);
+  if (parent == Header()) {
+    header_.SetParent(node);
+    header_.SetLeft(node);
+    header_.SetRight(node);
+  } else if (pos.toLeft) {
+    parent->SetLeft(node);
+    if (header_.Left() == parent) header_.SetLeft(node);
+  } else {
+    parent->SetRight(node);
+    if (header_.Right() == parent) header_.SetRight(node);
+  }
+#if defined(S21_THREADED_NODES)
+  // a left son comes right before its parent, a right son right after it
+  NodeBase *before = pos.toLeft ? parent->Prev() : parent;
+  NodeBase *after = before->Next();
+  node->SetPrev(before);
+  node->SetNext(after);
+  before->SetNext(node);
+  after->SetPrev(node);
+#endif
+  const LinkTable links = Links();
+  for (NodeBase *up = parent; up != Header(); up = up->Parent(links))
+    ++up->size;
+  BalanceAfterInsert(node);
+
+  return node;
+}
+
+// returns whether a red root had to be blackened, which adds one to the
+// black height of the tree
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+bool RBTree<Type, Allocator, KeyOfValue, Compare>::BalanceAfterInsert(
+    NodeBase *node) {
+  bool grown = false;
+
+  // each pass fixes node or moves the red-red conflict to next
+  while (node) {
+    NodeBase *next = nullptr;
+
+    if (node == Root()) {
+      grown = node->Color() == color::RED;
+      node->SetColor(color::BLACK);
+    } else if (node->Parent()->Color() == color::RED) {
+      NodeBase *uncle = Uncle(node);
+      if (uncle && uncle->Color() == color::RED) {
+        uncle->SetColor(color::BLACK);
+        Grandfather(node)->SetColor(color::RED);
+        node->Parent()->SetColor(color::BLACK);
+        next = Grandfather(node);
+      } else if (LeftSon(node)) {
+        if (LeftSon(node->Parent())) {
+          Grandfather(node)->SetColor(color::RED);
+          node->Parent()->SetColor(color::BLACK);
+          RightRotation(Grandfather(node));
+        } else {
+          RightRotation(node->Parent());
+          next = node->Right();
+        }
+      } else {
+        if (!LeftSon(node->Parent())) {
+          Grandfather(node)->SetColor(color::RED);
+          node->Parent()->SetColor(color::BLACK);
+          LeftRotation(Grandfather(node));
+        } else {
+          LeftRotation(node->Parent());
+          next = node->Left();
+        }
+      }
+    }
+
+    node = next;
+  }
+
+  return grown;
+}
+
+// the number of black nodes on every path from node down to a leaf
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::BlackHeight(
+    const NodeBase *node) noexcept {
+  size_t height = 0;
+  for (; node; node = node->Left()) height += node->Color() == color::BLACK;
+
+  return height;
+}
+
+// Makes the root of this tree the join of the subtrees left and right,
+// either of which may be empty, with mid ordering between them; the
+// heights are their black heights and the one of the result is returned.
+// mid goes down the facing spine of the higher subtree to the first black
+// node as high as the lower one, takes its place with the two as sons and
+// is balanced as a new red node, so the time is the difference of the
+// heights. The ends of the tree are left to the caller
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+size_t RBTree<Type, Allocator, KeyOfValue, Compare>::JoinNodes(
+    NodeBase *left, size_t leftHeight, NodeBase *mid, NodeBase *right,
+    size_t rightHeight) {
+  if (left && left->Color() == color::RED) {
+    left->SetColor(color::BLACK);
+    ++leftHeight;
+  }
+  if (right && right->Color() == color::RED) {
+    right->SetColor(color::BLACK);
+    ++rightHeight;
+  }
+
+  const bool intoLeft = leftHeight >= rightHeight;
+  NodeBase *high = intoLeft ? left : right;
+  NodeBase *low = intoLeft ? right : left;
+  const size_t highHeight = intoLeft ? leftHeight : rightHeight;
+  const size_t lowHeight = intoLeft ? rightHeight : leftHeight;
+
+  NodeBase *parent = Header();
+  NodeBase *node = high;
+  for (size_t height = highHeight;
+       node && (height > lowHeight || node->Color() == color::RED);) {
+    if (node->Color() == color::BLACK) --height;
+    parent = node;
+    node = intoLeft ? node->Right() : node->Left();
+  }
+
+  mid->SetColor(color::RED);
+  mid->SetLeft(intoLeft ? node : low);
+  mid->SetRight(intoLeft ? low : node);
+  if (mid->Left()) mid->Left()->SetParent(mid);
+  if (mid->Right()) mid->Right()->SetParent(mid);
+  UpdateSize(mid);
+  mid->SetParent(parent);
+  if (parent == Header())
+    header_.SetParent(mid);
+  else {
+    header_.SetParent(high);
+    high->SetParent(Header());
+    if (intoLeft)
+      parent->SetRight(mid);
+    else
+      parent->SetLeft(mid);
+    for (NodeBase *up = parent; up != Header(); up = up->Parent())
+      up->size += SizeOf(low) + 1;
+  }
+
+  return highHeight + BalanceAfterInsert(mid);
+}
+
+// moves the values from first on to the end of to one by one, for trees
+// whose nodes can not change pools
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::MoveTail(RBIterator first,
+                                                            RBTree &to) {
+  while (first != end()) {
+    to.Insert(to.end(), std::move(*first));
+    Erase((first++).iter_);
+  }
+}
+
+// moves the values before last to the front of to one by one, the last of
+// them first, for trees whose nodes can not change pools
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::MoveHead(RBIterator last,
+                                                            RBTree &to) {
+  while (last != begin()) {
+    --last;
+    to.Insert(to.begin(), std::move(*last));
+    Erase((last++).iter_);
+  }
+}
+
+// exchanges the positions of node and the maximum of its left subtree, so
+// that node is left with at most one son; the values stay in their nodes
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::SwapWithLeftMax(
+    NodeBase *node, NodeBase *leftMax) {
+  NodeBase *leftMaxParent = leftMax->Parent();
+  NodeBase *leftMaxLeft = leftMax->Left();
+
+  ReplaceSon(node, leftMax);
+  leftMax->SetRight(node->Right());
+  leftMax->Right()->SetParent(leftMax);
+  if (leftMax == node->Left()) {
+    leftMax->SetLeft(node);
+    node->SetParent(leftMax);
+  } else {
+    leftMax->SetLeft(node->Left());
+    leftMax->Left()->SetParent(leftMax);
+    leftMaxParent->SetRight(node);
+    node->SetParent(leftMaxParent);
+  }
+  node->SetLeft(leftMaxLeft);
+  if (node->Left()) node->Left()->SetParent(node);
+  node->SetRight(nullptr);
+
+  color leftMaxColor = leftMax->Color();
+  leftMax->SetColor(node->Color());
+  node->SetColor(leftMaxColor);
+  std::swap(leftMax->size, node->size);
+}
+
+// takes the node out of the tree and restores the balance, the node itself
+// is left to the caller
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Unlink(
+    NodeBase *erasedNode) {
+  if (erasedNode->Left() && erasedNode->Right()) {
+    NodeBase *leftMaxNode = erasedNode->Left();
+    while (leftMaxNode->Right()) leftMaxNode = leftMaxNode->Right();
+    SwapWithLeftMax(erasedNode, leftMaxNode);
+  }
+
+  if (header_.Left() == erasedNode)
+    header_.SetLeft((++RBIterator(erasedNode)).iter_);
+  if (header_.Right() == erasedNode)
+    header_.SetRight((--RBIterator(erasedNode)).iter_);
+#if defined(S21_THREADED_NODES)
+  erasedNode->Prev()->SetNext(erasedNode->Next());
+  erasedNode->Next()->SetPrev(erasedNode->Prev());
+#endif
+  const LinkTable links = Links();
+  for (NodeBase *node = erasedNode->Parent(); node != Header();
+       node = node->Parent(links))
+    --node->size;
+
+  NodeBase *son = erasedNode->Left() ? erasedNode->Left() : erasedNode->Right();
+  NodeBase *parent = erasedNode->Parent();
+  bool erasedNodeLeftSon = erasedNode != Root() && LeftSon(erasedNode);
+  ReplaceSon(erasedNode, son);
+
+  if (!Root())
+    ResetHeader();
+  else if (erasedNode->Color() == color::BLACK) {
+    if (son)  // a single son is always red
+      son->SetColor(color::BLACK);
+    else
+      BalanceAfterErase(parent, erasedNodeLeftSon);
+  }
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::Erase(NodeBase *node) {
+  Unlink(node);
+  pool_.Destroy(static_cast<Node<Type> *>(node));
+}
+
+// readies a node unlinked from a tree to be linked into one again
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::ResetLinks(
+    NodeBase *node) noexcept {
+  node->size = 1;
+  node->SetColor(color::RED);
+  node->SetLeft(nullptr);
+  node->SetRight(nullptr);
+}
+
+// links the node of a handle at the place findPos gives for its value, or
+// leaves it in the handle when that place is taken by an equal node
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <typename FindPosFn>
+std::pair<typename RBTree<Type, Allocator, KeyOfValue, Compare>::RBIterator,
+          bool>
+RBTree<Type, Allocator, KeyOfValue, Compare>::LinkHandle(NodeHandle &node,
+                                                         FindPosFn findPos) {
+  if (node.Empty()) return {end(), false};
+  InsertPos pos = findPos(KeyOfValue()(*node.Get()));
+  if (pos.equal) return {pos.equal, false};
+
+  NodeBase *linked = nullptr;
+  if (node.GetAllocator() == GetAllocator()) {
+    linked = pool_.Adopt(node.hold_);
+    ResetLinks(linked);
+  } else {  // a node of a foreign allocator can not be adopted
+    linked = pool_.Create(color::RED, nullptr, nullptr, nullptr,
+                          std::move(*node.Get()));
+    node.hold_.Reset();
+  }
+  return {LinkNode(pos, linked), true};
+}
+
+// moves the nodes of other that kUnique lets in, equal values after the
+// ones of this tree as std::multiset::merge puts them; when the pools can
+// share their chunks the nodes are relinked, otherwise their values are
+// moved into new nodes
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <bool kUnique>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::MergeNodes(
+    RBTree &other) {
+  if (this == &other || !other.Root()) return;
+
+  bool canShare = GetAllocator() == other.GetAllocator();
+  if (canShare && !Root()) {  // every node of other goes
+    Clear();
+    StealHeader(other);
+    return;
+  }
+  if constexpr (kCanShare) {
+    if (canShare && Size() <= other.Size() * kMergeRatio) {
+      MergeLinked<kUnique>(other);
+      return;
+    }
+  } else {
+    canShare = false;
+  }
+
+  // the pools are shared once the first node is about to move
+  bool shared = false;
+  for (RBIterator it = other.begin(); it != other.end();) {
+    NodeBase *node = (it++).iter_;
+    InsertPos pos =
+        kUnique ? FindUniquePos(KeyOf(node)) : FindLastPos(KeyOf(node));
+    if (pos.equal) continue;
+    if (canShare) {
+      if constexpr (kCanShare)
+        if (!shared) pool_.Share(other.pool_);
+      shared = true;
+      other.Unlink(node);
+      ResetLinks(node);
+      LinkNode(pos, node);
+    } else {
+      InsertAt(pos, std::move(Value(node)));
+      other.Erase(node);
+    }
+  }
+  if constexpr (kCanShare)
+    if (shared && !other.Root()) pool_.TakeOver(other.pool_);
+}
+
+// Merges the nodes of other, whose pool this one can share, in O(n + m):
+// one walk over the nodes of both trees, listed in order, merges the
+// lists, and each tree is then linked from its list perfectly balanced,
+// as AssignSorted builds one, without comparing, allocating or copying
+// anything. Only the walk compares values and it changes nothing, and the
+// pools are shared after it, so a throwing comparison, like a failure to
+// allocate the lists or to share, leaves both trees and their pools as
+// they were
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+template <bool kUnique>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::MergeLinked(
+    RBTree &other) {
+  const size_t aSize = Size();
+  const size_t bSize = other.Size();
+  // the nodes of this tree are listed at the end of merged, from where
+  // the merge moves them forward, never past the ones still to be read;
+  // the ones other keeps are moved forward within its own list the same
+  // way
+  s21::vector<NodeBase *> merged(aSize + bSize);
+  s21::vector<NodeBase *> rest(bSize);
+  ListNodes(Root(), merged.data() + bSize);
+  ListNodes(other.Root(), rest.data());
+
+  NodeBase **out = merged.data();
+  NodeBase **a = out + bSize;
+  NodeBase **aEnd = a + aSize;
+  NodeBase **b = rest.data();
+  NodeBase **bEnd = b + bSize;
+  NodeBase **left = b;
+  while (a != aEnd && b != bEnd) {
+    if (aEnd - a > static_cast<std::ptrdiff_t>(kLinkAhead))
+      Prefetch(a[kLinkAhead]);
+    if (bEnd - b > static_cast<std::ptrdiff_t>(kLinkAhead))
+      Prefetch(b[kLinkAhead]);
+    if (Comp()(KeyOf(*b), KeyOf(*a))) {
+      *out++ = *b++;
+      continue;
+    }
+    if (kUnique && !Comp()(KeyOf(*a), KeyOf(*b))) *left++ = *b++;
+    *out++ = *a++;
+  }
+  while (a != aEnd) *out++ = *a++;
+  while (b != bEnd) *out++ = *b++;
+
+  pool_.Share(other.pool_);
+  LinkNodes(merged.data(), out - merged.data());
+  other.LinkNodes(rest.data(), left - rest.data());
+  if (!other.Root()) pool_.TakeOver(other.pool_);
+}
+
+template <typename Type, typename Allocator, typename KeyOfValue,
+          typename Compare>
+void RBTree<Type, Allocator, KeyOfValue, Compare>::BalanceAfterErase(
+    NodeBase *node, bool eraseLeftSon) {
+  // each pass restores the black height under node or hands the missing
+  // black up to next
+  while (node) {
+    NodeBase *next = nullptr;
+
+    if (eraseLeftSon) {
+      if (node->Color() == color::RED) {
+        if (node->Right()->Right() &&
+            node->Right()->Right()->Color() == color::RED) {
+          node->SetColor(color::BLACK);
+          node->Right()->SetColor(color::RED);
+          node->Right()->Right()->SetColor(color::BLACK);
+          LeftRotation(node);
+        } else if (node->Right()->Left() &&
+                   node->Right()->Left()->Color() == color::RED) {
+          RightRotation(node->Right());
+          LeftRotation(node);
+          node->SetColor(color::BLACK);
+        } else {
+          node->Right()->SetColor(color::RED);
+          node->SetColor(color::BLACK);
+        }
+      } else {
+        if (node->Right()->Color() == color::RED) {
+          node->Right()->SetColor(color::BLACK);
+          node->SetColor(color::RED);
+          LeftRotation(node);
+          next = node;
+        } else {
+          if (HasRedSon(node->Right())) {
+            if (node->Right()->Right() &&
+                node->Right()->Right()->Color() == color::RED) {
+              node->Right()->Right()->SetColor(color::BLACK);
+              // RightRotation(left);
+              LeftRotation(node);
+            } else {
+              node->Right()->Left()->SetColor(color::BLACK);
+              RightRotation(node->Right());
+              LeftRotation(node);
+            }
+          } else {
+            node->Right()->SetColor(color::RED);
+            if (node != Root()) {
+              next = node->Parent();
+              eraseLeftSon = LeftSon(node);
+            }
+          }
+        }
+      }
+    } else {
+      if (node->Color() == color::RED) {
+        if (node->Left()->Left() &&
+            node->Left()->Left()->Color() == color::RED)  // 1
+        {
+          node->SetColor(color::BLACK);
+          node->Left()->SetColor(color::RED);
+          node->Left()->Left()->SetColor(color::BLACK);
+          RightRotation(node);
+        } else if (node->Left()->Right() &&
+                   node->Left()->Right()->Color() == color::RED)  // 2
+        {
+          LeftRotation(node->Left());
+          RightRotation(node);
+          node->SetColor(color::BLACK);
+        } else  // 3
+        {
+          node->Left()->SetColor(color::RED);
+          node->SetColor(color::BLACK);
+        }
+      } else {
+        if (node->Left()->Color() == color::RED) {
+          node->Left()->SetColor(color::BLACK);
+          node->SetColor(color::RED);
+          RightRotation(node);
+          next = node;
+        } else {
+          if (HasRedSon(node->Left())) {
+            if (node->Left()->Left() &&
+                node->Left()->Left()->Color() == color::RED)  // 6
+            {
+              node->Left()->Left()->SetColor(color::BLACK);
+              // RightRotation(left);
+              RightRotation(node);
+            } else  // 7 2.2.2.1
+            {
+              node->Left()->Right()->SetColor(color::BLACK);
+              LeftRotation(node->Left());
+              RightRotation(node);
+            }
+          } else  // 8
+          {
+            node->Left()->SetColor(color::RED);
+            if (node != Root()) {
+              next = node->Parent();
+              eraseLeftSon = LeftSon(node);
+            }
+          }
+        }
+      }
+    }
+
+    node = next;
+  }
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <future>
+
+#include "s21_vector.h"
+
+// Union, intersection and difference of two trees of keys with the same
+// order, for s21::set and s21::multiset on any of RBTree, BTree and
+// FlatTree. Repeated keys follow std::set_union and the like: a key held
+// a times by one tree and b times by the other is held max(a, b),
+// min(a, b) or max(a - b, 0) times by the result; for sets a and b are at
+// most 1, which gives the usual sets.
+//
+// Trees of comparable sizes are merged in one walk over both in O(n + m).
+// With threads above 1 a large merge is cut into key ranges at the keys
+// of evenly spaced ranks of the larger tree, each range is merged into a
+// tree of its own at the same time as the others, and the parts are
+// joined in order at the end. When one tree is over kSkewRatio times the
+// other, only the keys of the smaller are searched in the larger, in
+// order, so that each search goes on from the previous result (FindMany),
+// which is O(m log(n / m + 1)) comparisons. The result is then either
+// built from the matches or, when it holds most of the larger tree, is a
+// copy of the larger tree, made without comparisons, with the m keys
+// applied to it.
+template <typename Tree>
+class SetAlgebra {
+  using Iterator = typename Tree::Iterator;
+
+ public:
+  static void Union(const Tree &a, const Tree &b, size_t threads, Tree &out);
+  static void Intersection(const Tree &a, const Tree &b, size_t threads,
+                           Tree &out);
+  static void Difference(const Tree &a, const Tree &b, size_t threads,
+                         Tree &out);
+
+ private:
+  enum class Op { kUnion, kIntersection, kDifference };
+
+  // how many times one tree may hold the keys of the other and still be
+  // walked through in a merge
+  static constexpr size_t kSkewRatio = 32;
+  // the fewest keys a merge gives a thread of its own
+  static constexpr size_t kMinPartSize = size_t(1) << 16;
+
+  static bool Skewed(const Tree &small, const Tree &large) noexcept;
+  template <Op kOp>
+  static void Merge(const Tree &a, const Tree &b, size_t threads, Tree &out);
+  template <Op kOp>
+  static void MergeRanges(Iterator a, Iterator aEnd, Iterator b,
+                          Iterator bEnd, Tree &out);
+  template <typename Visit>
+  static void MatchRuns(const Tree &small, const Tree &large, Visit visit);
+};
+
+template <typename Tree>
+void SetAlgebra<Tree>::Union(const Tree &a, const Tree &b, size_t threads,
+                             Tree &out) {
+  const bool aSmall = a.Size() < b.Size();
+  const Tree &small = aSmall ? a : b;
+  const Tree &large = aSmall ? b : a;
+  if (!Skewed(small, large)) {
+    Merge<Op::kUnion>(a, b, threads, out);
+    return;
+  }
+
+  // the keys of the smaller tree only add the copies the larger lacks
+  out = large;
+  MatchRuns(small, large,
+            [&](Iterator run, size_t count, Iterator, size_t matched) {
+              for (size_t i = 0; i < count; ++i, ++run)
+                if (i >= matched) out.Insert(*run);
+            });
+}
+
+template <typename Tree>
+void SetAlgebra<Tree>::Intersection(const Tree &a, const Tree &b,
+                                    size_t threads, Tree &out) {
+  const bool aSmall = a.Size() < b.Size();
+  const Tree &small = aSmall ? a : b;
+  const Tree &large = aSmall ? b : a;
+  if (!Skewed(small, large)) {
+    Merge<Op::kIntersection>(a, b, threads, out);
+    return;
+  }
+
+  // the matched copies are taken from a, as std::set_intersection does
+  MatchRuns(small, large,
+            [&](Iterator run, size_t, Iterator match, size_t matched) {
+              Iterator from = aSmall ? run : match;
+              for (; matched; --matched, ++from) out.Insert(out.end(), *from);
+            });
+}
+
+template <typename Tree>
+void SetAlgebra<Tree>::Difference(const Tree &a, const Tree &b,
+                                  size_t threads, Tree &out) {
+  if (Skewed(b, a)) {
+    // most of a stays, each key of b takes out one copy
+    out = a;
+    for (Iterator it = b.begin(); it != b.end(); ++it) {
+      Iterator held = out.Find(*it);
+      if (held != out.end()) out.Erase(held);
+    }
+  } else if (Skewed(a, b)) {
+    // a run of a keeps the copies past the ones b matches
+    MatchRuns(a, b, [&](Iterator run, size_t count, Iterator, size_t matched) {
+      for (size_t i = 0; i < count; ++i, ++run)
+        if (i >= matched) out.Insert(out.end(), *run);
+    });
+  } else {
+    Merge<Op::kDifference>(a, b, threads, out);
+  }
+}
+
+template <typename Tree>
+bool SetAlgebra<Tree>::Skewed(const Tree &small,
+                              const Tree &large) noexcept {
+  return small.Size() < large.Size() / kSkewRatio;
+}
+
+template <typename Tree>
+template <typename SetAlgebra<Tree>::Op kOp>
+void SetAlgebra<Tree>::Merge(const Tree &a, const Tree &b, size_t threads,
+                             Tree &out) {
+  const Tree &large = a.Size() < b.Size() ? b : a;
+  const size_t parts = std::max<size_t>(
+      1, std::min(threads, (a.Size() + b.Size()) / kMinPartSize));
+
+  // part i merges the keys from the bound i - 1 on up to the bound i
+  s21::vector<Iterator> aBounds;
+  s21::vector<Iterator> bBounds;
+  aBounds.push_back(a.begin());
+  bBounds.push_back(b.begin());
+  for (size_t i = 1; i < parts; ++i) {
+    const auto &key = *large.Nth(i * large.Size() / parts);
+    aBounds.push_back(a.lower_bound(key));
+    bBounds.push_back(b.lower_bound(key));
+  }
+  aBounds.push_back(a.end());
+  bBounds.push_back(b.end());
+
+  s21::vector<Tree> rest;
+  rest.reserve(parts - 1);
+  for (size_t i = 1; i < parts; ++i)
+    rest.emplace_back(out.GetCompare(), out.GetAllocator());
+
+  s21::vector<std::future<void>> merges;
+  merges.reserve(parts - 1);
+  for (size_t i = 1; i < parts; ++i)
+    merges.push_back(std::async(std::launch::async, [&, i] {
+      MergeRanges<kOp>(aBounds[i], aBounds[i + 1], bBounds[i],
+                       bBounds[i + 1], rest[i - 1]);
+    }));
+  MergeRanges<kOp>(aBounds[0], aBounds[1], bBounds[0], bBounds[1], out);
+  for (std::future<void> &merge : merges) merge.get();
+
+  for (Tree &part : rest) out.Join(part);
+}
+
+// appends to out what kOp keeps of the ranges of a and b, in one walk
+template <typename Tree>
+template <typename SetAlgebra<Tree>::Op kOp>
+void SetAlgebra<Tree>::MergeRanges(Iterator a, Iterator aEnd, Iterator b,
+                                   Iterator bEnd, Tree &out) {
+  auto comp = out.GetCompare();
+
+  while (a != aEnd && b != bEnd) {
+    if (comp(*a, *b)) {
+      if (kOp != Op::kIntersection) out.Insert(out.end(), *a);
+      ++a;
+    } else if (comp(*b, *a)) {
+      if (kOp == Op::kUnion) out.Insert(out.end(), *b);
+      ++b;
+    } else {
+      if (kOp != Op::kDifference) out.Insert(out.end(), *a);
+      ++a;
+      ++b;
+    }
+  }
+  if (kOp != Op::kIntersection)
+    for (; a != aEnd; ++a) out.Insert(out.end(), *a);
+  if (kOp == Op::kUnion)
+    for (; b != bEnd; ++b) out.Insert(out.end(), *b);
+}
+
+// Calls visit(run, count, match, matched) for every run of equal keys of
+// small, in order: run is its first key and count its length, match the
+// first equal key of large, as FindMany gives it, and matched how many of
+// the run it pairs off, at most count
+template <typename Tree>
+template <typename Visit>
+void SetAlgebra<Tree>::MatchRuns(const Tree &small, const Tree &large,
+                                 Visit visit) {
+  s21::vector<Iterator> found;
+  found.reserve(small.Size());
+  large.FindMany(small.begin(), small.end(), found);
+  auto comp = large.GetCompare();
+
+  size_t i = 0;
+  for (Iterator it = small.begin(); it != small.end();) {
+    Iterator run = it;
+    size_t count = 0;
+    do {
+      ++it;
+      ++count;
+    } while (it != small.end() && !comp(*run, *it));
+
+    Iterator match = found[i];
+    size_t matched = 0;
+    for (Iterator at = match; matched < count && at != large.end() &&
+                              !comp(*run, *at);
+         ++at)
+      ++matched;
+    visit(run, count, match, matched);
+    i += count;
+  }
+}
@@ -0,0 +1,621 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+
+#include "s21_btree.h"
+#include "s21_flat.h"
+#include "s21_map.h"
+#include "s21_multiset.h"
+#include "s21_set.h"
+
+namespace {
+
+// runs body ops times and returns the mean time of one run in nanoseconds
+template <typename Body>
+double MeasureNs(size_t ops, Body &&body) {
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < ops; ++i) body(i);
+  auto finish = std::chrono::steady_clock::now();
+
+  return std::chrono::duration<double, std::nano>(finish - start).count() /
+         static_cast<double>(ops);
+}
+
+void Report(const char *name, size_t n, double ns) {
+  std::printf("%-36s n=%-10zu %10.1f ns/op\n", name, n, ns);
+}
+
+void ReportBytes(const char *name, size_t n, double bytes) {
+  std::printf("%-36s n=%-10zu %10.1f bytes/element\n", name, n, bytes);
+}
+
+// guards the measured results against dead-code elimination
+volatile size_t sink = 0;
+
+// bytes currently held through CountingAllocator
+size_t allocatedBytes = 0;
+
+template <typename T>
+struct CountingAllocator {
+  using value_type = T;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(const CountingAllocator<U> &) noexcept {}
+
+  T *allocate(size_t n) {
+    allocatedBytes += n * sizeof(T);
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T *ptr, size_t n) noexcept {
+    allocatedBytes -= n * sizeof(T);
+    std::allocator<T>().deallocate(ptr, n);
+  }
+
+  template <typename U>
+  bool operator==(const CountingAllocator<U> &) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const CountingAllocator<U> &) const noexcept {
+    return false;
+  }
+};
+
+void BenchMapAppend(size_t n) {
+  Report("s21::map insert ascending", n, MeasureNs(1, [&](size_t) {
+           s21::map<int, int> my_map;
+           for (size_t i = 0; i < n; ++i) my_map.insert(static_cast<int>(i), 0);
+           sink = sink + my_map.size();
+         }) / static_cast<double>(n));
+  Report("s21::map emplace_hint(end)", n, MeasureNs(1, [&](size_t) {
+           s21::map<int, int> my_map;
+           for (size_t i = 0; i < n; ++i)
+             my_map.emplace_hint(my_map.end(), static_cast<int>(i), 0);
+           sink = sink + my_map.size();
+         }) / static_cast<double>(n));
+  Report("std::map emplace_hint(end)", n, MeasureNs(1, [&](size_t) {
+           std::map<int, int> orig_map;
+           for (size_t i = 0; i < n; ++i)
+             orig_map.emplace_hint(orig_map.end(), static_cast<int>(i), 0);
+           sink = sink + orig_map.size();
+         }) / static_cast<double>(n));
+}
+
+void BenchMultisetRange(size_t n) {
+  std::mt19937 rng(42);
+  s21::multiset<int> my_set;
+  std::multiset<int> orig_set;
+  int range = static_cast<int>(std::max<size_t>(n / 4, 1));
+  for (size_t i = 0; i < n; ++i) {
+    int value = static_cast<int>(rng() % range);
+    my_set.insert(value);
+    orig_set.insert(value);
+  }
+
+  const size_t ops = 200000;
+  s21::vector<int> keys;
+  for (size_t i = 0; i < ops; ++i) keys.push_back(rng() % range);
+
+  Report("s21::multiset lower_bound", n, MeasureNs(ops, [&](size_t i) {
+           auto it = my_set.lower_bound(keys[i]);
+           sink = sink + (it != my_set.end());
+         }));
+  Report("std::multiset lower_bound", n, MeasureNs(ops, [&](size_t i) {
+           auto it = orig_set.lower_bound(keys[i]);
+           sink = sink + (it != orig_set.end());
+         }));
+  Report("s21::multiset upper_bound", n, MeasureNs(ops, [&](size_t i) {
+           auto it = my_set.upper_bound(keys[i]);
+           sink = sink + (it != my_set.end());
+         }));
+  Report("std::multiset upper_bound", n, MeasureNs(ops, [&](size_t i) {
+           auto it = orig_set.upper_bound(keys[i]);
+           sink = sink + (it != orig_set.end());
+         }));
+  Report("s21::multiset equal_range + walk", n, MeasureNs(ops, [&](size_t i) {
+           auto range_it = my_set.equal_range(keys[i]);
+           for (auto it = range_it.first; it != range_it.second; ++it)
+             sink = sink + 1;
+         }));
+  Report("std::multiset equal_range + walk", n, MeasureNs(ops, [&](size_t i) {
+           auto range_it = orig_set.equal_range(keys[i]);
+           for (auto it = range_it.first; it != range_it.second; ++it)
+             sink = sink + 1;
+         }));
+  Report("s21::multiset count", n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + my_set.count(keys[i]);
+         }));
+  Report("std::multiset count", n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + orig_set.count(keys[i]);
+         }));
+}
+
+void BenchSetInsertFind(size_t n) {
+  std::mt19937 rng(3);
+  s21::vector<int> values;
+  for (size_t i = 0; i < n; ++i) values.push_back(static_cast<int>(rng()));
+
+  s21::set<int> my_set;
+  std::set<int> orig_set;
+  Report("s21::set insert", n, MeasureNs(n, [&](size_t i) {
+           sink = sink + my_set.insert(values[i]).second;
+         }));
+  Report("std::set insert", n, MeasureNs(n, [&](size_t i) {
+           sink = sink + orig_set.insert(values[i]).second;
+         }));
+
+  const size_t ops = 1000000;
+  s21::vector<int> keys;
+  for (size_t i = 0; i < ops; ++i)
+    keys.push_back(i % 2 ? values[rng() % n] : static_cast<int>(rng()));
+  Report("s21::set find", n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + (my_set.find(keys[i]) != my_set.end());
+         }));
+  Report("std::set find", n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + (orig_set.find(keys[i]) != orig_set.end());
+         }));
+}
+
+// long keys sharing a prefix, where comparing them dominates the descent
+void BenchStringSetFind(size_t n) {
+  std::mt19937 rng(5);
+  const std::string prefix = "/srv/data/archive/2024/collections/records/";
+  s21::vector<std::string> values;
+  for (size_t i = 0; i < n; ++i)
+    values.push_back(prefix + std::to_string(rng()));
+
+  s21::set<std::string> my_set;
+  std::set<std::string> orig_set;
+  Report("s21::set<string> insert", n, MeasureNs(n, [&](size_t i) {
+           sink = sink + my_set.insert(values[i]).second;
+         }));
+  Report("std::set<string> insert", n, MeasureNs(n, [&](size_t i) {
+           sink = sink + orig_set.insert(values[i]).second;
+         }));
+
+  const size_t ops = 1000000;
+  s21::vector<std::string> keys;
+  for (size_t i = 0; i < ops; ++i)
+    keys.push_back(i % 2 ? values[rng() % n] : prefix + std::to_string(rng()));
+  Report("s21::set<string> find", n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + (my_set.find(keys[i]) != my_set.end());
+         }));
+  Report("std::set<string> find", n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + (orig_set.find(keys[i]) != orig_set.end());
+         }));
+}
+
+// heap bytes per element, S21_COMPACT_NODES makes s21 nodes a word smaller
+void BenchSetMemory(size_t n) {
+  std::mt19937 rng(13);
+  {
+    s21::set<int, std::less<int>, CountingAllocator<int>> my_set;
+    while (my_set.size() < n) my_set.insert(static_cast<int>(rng()));
+    ReportBytes("s21::set<int> memory", n,
+                static_cast<double>(allocatedBytes) / static_cast<double>(n));
+  }
+  {
+    std::set<int, std::less<int>, CountingAllocator<int>> orig_set;
+    while (orig_set.size() < n) orig_set.insert(static_cast<int>(rng()));
+    ReportBytes("std::set<int> memory", n,
+                static_cast<double>(allocatedBytes) / static_cast<double>(n));
+  }
+}
+
+// the same containers on RBTree and on BTree, switched by the typedef only
+template <typename Set>
+void BenchSetBackend(const char *name, size_t n) {
+  std::mt19937 rng(17);
+  s21::vector<int> values;
+  for (size_t i = 0; i < n; ++i) values.push_back(static_cast<int>(rng()));
+  const size_t ops = 1000000;
+  s21::vector<int> keys;
+  for (size_t i = 0; i < ops; ++i)
+    keys.push_back(i % 2 ? values[rng() % n] : static_cast<int>(rng()));
+
+  std::string label(name);
+  Set my_set;
+  Report((label + " insert").c_str(), n, MeasureNs(n, [&](size_t i) {
+           sink = sink + my_set.insert(values[i]).second;
+         }));
+  Report((label + " find").c_str(), n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + (my_set.find(keys[i]) != my_set.end());
+         }));
+  Report((label + " rank").c_str(), n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + my_set.rank(keys[i]);
+         }));
+  Report((label + " iterate").c_str(), n, MeasureNs(1, [&](size_t) {
+           for (auto it = my_set.begin(); it != my_set.end(); ++it)
+             sink = sink + *it;
+         }) / static_cast<double>(n));
+  Report((label + " erase").c_str(), n, MeasureNs(n, [&](size_t i) {
+           auto it = my_set.find(values[i]);
+           if (it != my_set.end()) my_set.erase(it);
+         }));
+  Report((label + " insert ascending").c_str(), n, MeasureNs(1, [&](size_t) {
+           Set sorted;
+           for (size_t i = 0; i < n; ++i)
+             sorted.insert(sorted.end(), static_cast<int>(i));
+           sink = sink + sorted.size();
+         }) / static_cast<double>(n));
+
+  // nodes allocated in order, where stepping costs more than the misses
+  Set sorted;
+  for (size_t i = 0; i < n; ++i)
+    sorted.insert(sorted.end(), static_cast<int>(i));
+  Report((label + " iterate ascending").c_str(), n, MeasureNs(1, [&](size_t) {
+           for (auto it = sorted.begin(); it != sorted.end(); ++it)
+             sink = sink + *it;
+         }) / static_cast<double>(n));
+}
+
+void BenchBTree(size_t n) {
+  BenchSetBackend<s21::set<int>>("s21::set<int>", n);
+  BenchSetBackend<s21::btree_set<int>>("s21::btree_set<int>", n);
+
+  std::mt19937 rng(13);
+  {
+    s21::btree_set<int, std::less<int>, CountingAllocator<int>> my_set;
+    while (my_set.size() < n) my_set.insert(static_cast<int>(rng()));
+    ReportBytes("s21::btree_set<int> memory", n,
+                static_cast<double>(allocatedBytes) / static_cast<double>(n));
+  }
+}
+
+// lookups in read-mostly maps built once from sorted pairs, small to large
+template <typename Map>
+void BenchMapLookup(const char *name, size_t n) {
+  std::mt19937 rng(31);
+  std::set<int> keySet;
+  while (keySet.size() < n) keySet.insert(static_cast<int>(rng()));
+  s21::vector<std::pair<int, int>> pairs;
+  s21::vector<int> values;
+  for (int key : keySet) {
+    pairs.push_back({key, key / 2});
+    values.push_back(key);
+  }
+  const size_t ops = 1000000;
+  s21::vector<int> keys;
+  for (size_t i = 0; i < ops; ++i)
+    keys.push_back(i % 2 ? values[rng() % n] : static_cast<int>(rng()));
+
+  Map my_map = Map::from_sorted(pairs.begin(), pairs.end());
+  Report(name, n, MeasureNs(ops, [&](size_t i) {
+           sink = sink + my_map.contains(keys[i]);
+         }));
+}
+
+void BenchFlat(size_t n) {
+  for (size_t size : {size_t(64), size_t(4096), n}) {
+    BenchMapLookup<s21::map<int, int>>("s21::map<int> find", size);
+    BenchMapLookup<s21::btree_map<int, int>>("s21::btree_map<int> find", size);
+    BenchMapLookup<s21::flat_map<int, int>>("s21::flat_map<int> find", size);
+  }
+
+  std::mt19937 rng(13);
+  {
+    s21::vector<int> values;
+    for (size_t i = 0; i < n; ++i) values.push_back(static_cast<int>(rng()));
+    std::sort(values.begin(), values.end());
+    auto my_set =
+        s21::flat_set<int, std::less<int>, CountingAllocator<int>>::from_sorted(
+            values.begin(), values.end());
+    ReportBytes("s21::flat_set<int> memory", my_set.size(),
+                static_cast<double>(allocatedBytes) /
+                    static_cast<double>(my_set.size()));
+  }
+}
+
+// the same lookups on a map and on its frozen snapshot
+void BenchFrozen(size_t n) {
+  for (size_t size : {size_t(64), size_t(4096), n}) {
+    BenchMapLookup<s21::map<int, int>>("s21::map<int> find", size);
+    BenchMapLookup<s21::frozen_map<int, int>>("s21::frozen_map<int> find",
+                                              size);
+  }
+}
+
+// a batch of lookups one find at a time and through find_many, the batch
+// in random order and sorted
+void BenchFindMany(size_t n) {
+  std::mt19937 rng(37);
+  s21::map<int, int> my_map;
+  s21::vector<int> values;
+  while (my_map.size() < n) {
+    int key = static_cast<int>(rng());
+    if (my_map.insert(key, key).second) values.push_back(key);
+  }
+  const size_t ops = 1000000;
+  s21::vector<int> keys;
+  for (size_t i = 0; i < ops; ++i)
+    keys.push_back(i % 2 ? values[rng() % n] : static_cast<int>(rng()));
+
+  for (bool sorted : {false, true}) {
+    if (sorted) std::sort(keys.begin(), keys.end());
+    std::string order = sorted ? " sorted" : " random";
+    Report(("s21::map find loop" + order).c_str(), n,
+           MeasureNs(1, [&](size_t) {
+             for (size_t i = 0; i < ops; ++i)
+               sink = sink + (my_map.find(keys[i]) != my_map.end());
+           }) / static_cast<double>(ops));
+    Report(("s21::map find_many" + order).c_str(), n,
+           MeasureNs(1, [&](size_t) {
+             s21::vector<s21::map<int, int>::iterator> found;
+             found.reserve(ops);
+             my_map.find_many(keys.begin(), keys.end(), found);
+             sink = sink + found.size();
+           }) / static_cast<double>(ops));
+  }
+}
+
+void BenchSplitJoin(size_t n) {
+  std::mt19937 rng(43);
+  s21::map<int, int> my_map;
+  for (size_t i = 0; i < n; ++i) my_map.insert(static_cast<int>(i), 0);
+
+  const size_t ops = 10000;
+  Report("s21::map split + join", n, MeasureNs(ops, [&](size_t) {
+           s21::map<int, int> right =
+               my_map.split(static_cast<int>(rng() % n));
+           sink = sink + right.size();
+           my_map.join(right);
+         }));
+  // the smaller part is largest at the median, where it spans many chunks
+  Report("s21::map split + join at median", n, MeasureNs(1000, [&](size_t) {
+           s21::map<int, int> right = my_map.split(static_cast<int>(n / 2));
+           sink = sink + right.size();
+           my_map.join(right);
+         }));
+  // what moving a shard took before: reinserting its elements one by one
+  Report("s21::map split by reinserting", n, MeasureNs(1, [&](size_t) {
+           s21::map<int, int> right;
+           auto it = my_map.nth(n / 2);
+           while (it != my_map.end()) {
+             right.insert(*it);
+             auto next = it;
+             ++next;
+             my_map.erase(it);
+             it = next;
+           }
+           sink = sink + right.size();
+           my_map.merge(right);
+         }));
+}
+
+void BenchSetAlgebra(size_t n) {
+  std::mt19937 rng(47);
+  s21::set<int> large;
+  std::set<int> orig_large;
+  for (size_t i = 0; i < n; ++i) {
+    int value = static_cast<int>(rng());
+    large.insert(value);
+    orig_large.insert(value);
+  }
+  // a thousand keys, half of them held by the large set
+  s21::set<int> small;
+  std::set<int> orig_small;
+  for (size_t i = 0; i < 1000; ++i) {
+    int value = i % 2 ? *large.nth(rng() % large.size())
+                      : static_cast<int>(rng());
+    small.insert(value);
+    orig_small.insert(value);
+  }
+
+  const size_t ops = 1000;
+  Report("s21::set intersection with 1000 keys", n,
+         MeasureNs(ops, [&](size_t) {
+           sink = sink + large.intersection_with(small).size();
+         }));
+  // a linear merge walks the whole large set, once is enough
+  Report("std::set_intersection with 1000 keys", n,
+         MeasureNs(1, [&](size_t) {
+           std::set<int> result;
+           std::set_intersection(orig_large.begin(), orig_large.end(),
+                                 orig_small.begin(), orig_small.end(),
+                                 std::inserter(result, result.end()));
+           sink = sink + result.size();
+         }));
+
+  s21::set<int> other;
+  for (size_t i = 0; i < n; ++i) other.insert(static_cast<int>(rng()));
+  for (size_t threads : {1, 4})
+    Report(threads == 1 ? "s21::set union, 1 thread"
+                        : "s21::set union, 4 threads",
+           n, MeasureNs(1, [&](size_t) {
+             sink = sink + large.union_with(other, threads).size();
+           }));
+}
+
+void BenchNodeHandles(size_t n) {
+  std::mt19937 rng(53);
+  s21::set<std::string> my_set;
+  std::set<std::string> orig_set;
+  s21::vector<std::string> keys;
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back(std::to_string(rng()) + '_' + std::to_string(i) +
+                   std::string(16, 'k'));
+    my_set.insert(keys.back());
+    orig_set.insert(keys.back());
+  }
+
+  // each key is taken out, given a new name and put back
+  const size_t ops = 100000;
+  s21::vector<size_t> picks;
+  for (size_t i = 0; i < ops; ++i) picks.push_back(rng() % n);
+  auto rename = [&](auto &set, s21::vector<std::string> &names, size_t i) {
+    std::string &key = names[picks[i]];
+    auto node = set.extract(key);
+    key.back() = key.back() == 'k' ? 'm' : 'k';
+    node.value() = key;
+    sink = sink + set.insert(std::move(node)).inserted;
+  };
+  s21::vector<std::string> origKeys = keys;
+  Report("s21::set extract + insert", n,
+         MeasureNs(ops, [&](size_t i) { rename(my_set, keys, i); }));
+  Report("std::set extract + insert", n,
+         MeasureNs(ops, [&](size_t i) { rename(orig_set, origKeys, i); }));
+  Report("s21::set erase + insert", n, MeasureNs(ops, [&](size_t i) {
+           std::string &key = keys[picks[i]];
+           my_set.erase(my_set.find(key));
+           key.back() = key.back() == 'k' ? 'm' : 'k';
+           sink = sink + my_set.insert(key).second;
+         }));
+
+  // half of the keys go from one map to the other
+  s21::map<std::string, int> my_source;
+  std::map<std::string, int> orig_source;
+  for (size_t i = 0; i < n; ++i) {
+    std::string key = std::to_string(rng());
+    my_source[key] = 0;
+    orig_source[key] = 0;
+  }
+  s21::map<std::string, int> my_target;
+  std::map<std::string, int> orig_target;
+  for (size_t i = 0; i < n; ++i) {
+    std::string key = std::to_string(rng());
+    my_target[key] = 1;
+    orig_target[key] = 1;
+  }
+  Report("s21::map merge", n, MeasureNs(1, [&](size_t) {
+           my_target.merge(my_source);
+           sink = sink + my_target.size();
+         }) / static_cast<double>(n));
+  Report("std::map merge", n, MeasureNs(1, [&](size_t) {
+           orig_target.merge(orig_source);
+           sink = sink + orig_target.size();
+         }) / static_cast<double>(n));
+}
+
+// merges maps of n and n / ratio random keys, built anew for every run
+template <typename Map>
+void BenchMerge(const char *name, size_t n, size_t ratio) {
+  std::mt19937 rng(59);
+  s21::vector<int> keys;
+  for (size_t i = 0; i < n + n / ratio; ++i)
+    keys.push_back(static_cast<int>(rng()));
+
+  double ns = 0;
+  const size_t ops = 3;
+  for (size_t op = 0; op < ops; ++op) {
+    Map target;
+    Map source;
+    for (size_t i = 0; i < n; ++i) target[keys[i]] = 0;
+    for (size_t i = n; i < keys.size(); ++i) source[keys[i]] = 1;
+    ns += MeasureNs(1, [&](size_t) {
+      target.merge(source);
+      sink = sink + target.size();
+    });
+  }
+  Report(name, n, ns / ops / static_cast<double>(n + n / ratio));
+}
+
+void BenchMultisetInsertErase(size_t n) {
+  std::mt19937 rng(7);
+  s21::vector<int> values;
+  for (size_t i = 0; i < n; ++i) values.push_back(static_cast<int>(rng()));
+
+  Report("s21::multiset insert + erase", n, MeasureNs(1, [&](size_t) {
+           s21::multiset<int> my_set;
+           for (int value : values) my_set.insert(value);
+           for (size_t i = 0; i < n; i += 2) my_set.erase(my_set.begin());
+           for (int value : values) my_set.insert(value);
+           sink = sink + my_set.size();
+         }) / static_cast<double>(n));
+  Report("std::multiset insert + erase", n, MeasureNs(1, [&](size_t) {
+           std::multiset<int> orig_set;
+           for (int value : values) orig_set.insert(value);
+           for (size_t i = 0; i < n; i += 2) orig_set.erase(orig_set.begin());
+           for (int value : values) orig_set.insert(value);
+           sink = sink + orig_set.size();
+         }) / static_cast<double>(n));
+}
+
+void BenchMultisetCopy(size_t n) {
+  std::mt19937 rng(11);
+  s21::multiset<int> my_set;
+  std::multiset<int> orig_set;
+  for (size_t i = 0; i < n; ++i) {
+    int value = static_cast<int>(rng());
+    my_set.insert(value);
+    orig_set.insert(value);
+  }
+
+  const size_t ops = 10;
+  s21::multiset<int> my_target = my_set;
+  std::multiset<int> orig_target = orig_set;
+  Report("s21::multiset copy construct", n, MeasureNs(ops, [&](size_t) {
+           s21::multiset<int> copy(my_set);
+           sink = sink + copy.size();
+         }) / static_cast<double>(n));
+  Report("std::multiset copy construct", n, MeasureNs(ops, [&](size_t) {
+           std::multiset<int> copy(orig_set);
+           sink = sink + copy.size();
+         }) / static_cast<double>(n));
+  Report("s21::multiset copy assign", n, MeasureNs(ops, [&](size_t) {
+           my_target = my_set;
+           sink = sink + my_target.size();
+         }) / static_cast<double>(n));
+  Report("std::multiset copy assign", n, MeasureNs(ops, [&](size_t) {
+           orig_target = orig_set;
+           sink = sink + orig_target.size();
+         }) / static_cast<double>(n));
+}
+
+void BenchMultisetFromSorted(size_t n) {
+  s21::vector<int> values;
+  for (size_t i = 0; i < n; ++i) values.push_back(static_cast<int>(i));
+
+  Report("s21::multiset insert sorted", n, MeasureNs(1, [&](size_t) {
+           s21::multiset<int> my_set;
+           for (int value : values) my_set.insert(value);
+           sink = sink + my_set.size();
+         }) / static_cast<double>(n));
+  Report("s21::multiset from_sorted", n, MeasureNs(1, [&](size_t) {
+           auto my_set =
+               s21::multiset<int>::from_sorted(values.begin(), values.end());
+           sink = sink + my_set.size();
+         }) / static_cast<double>(n));
+  Report("std::multiset range constructor", n, MeasureNs(1, [&](size_t) {
+           std::multiset<int> orig_set(values.begin(), values.end());
+           sink = sink + orig_set.size();
+         }) / static_cast<double>(n));
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  BenchSetInsertFind(n);
+  BenchStringSetFind(n);
+  BenchSetMemory(n);
+  BenchBTree(n);
+  BenchFlat(n);
+  BenchFrozen(n);
+  BenchFindMany(n);
+  BenchSplitJoin(n);
+  BenchSetAlgebra(n);
+  BenchNodeHandles(n);
+  BenchMerge<s21::map<int, int>>("s21::map merge of equal sizes", n, 1);
+  BenchMerge<s21::btree_map<int, int>>("s21::btree_map merge of equal sizes",
+                                       n, 1);
+  BenchMerge<std::map<int, int>>("std::map merge of equal sizes", n, 1);
+  BenchMerge<s21::map<int, int>>("s21::map merge of n / 16", n, 16);
+  BenchMerge<std::map<int, int>>("std::map merge of n / 16", n, 16);
+  BenchMapAppend(n);
+  BenchMultisetRange(n);
+  BenchMultisetInsertErase(n);
+  BenchMultisetCopy(n);
+  BenchMultisetFromSorted(n);
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+
+#include "BTree.h"
+#include "s21_map.h"
+#include "s21_multiset.h"
+#include "s21_set.h"
+
+// The containers on a B-tree instead of a red-black tree: the same public
+// interface, with fewer cache misses per search and a few bytes of overhead
+// per element instead of a node each. Unlike with the default trees, every
+// insert and erase invalidates all iterators and references to elements.
+namespace s21 {
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>>
+using btree_set = set<Key, Compare, Allocator, BTree>;
+
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>>
+using btree_multiset = multiset<Key, Compare, Allocator, BTree>;
+
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<s21_pair<Key, T>>>
+using btree_map = map<Key, T, Compare, Allocator, BTree>;
+
+namespace pmr {
+template <typename Key>
+using btree_set =
+    s21::btree_set<Key, std::less<Key>, std::pmr::polymorphic_allocator<Key>>;
+
+template <typename Key>
+using btree_multiset =
+    s21::btree_multiset<Key, std::less<Key>,
+                        std::pmr::polymorphic_allocator<Key>>;
+
+template <typename Key, typename T>
+using btree_map =
+    s21::btree_map<Key, T, std::less<Key>,
+                   std::pmr::polymorphic_allocator<s21_pair<Key, T>>>;
+}  // namespace pmr
+}  // namespace s21
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "s21_btree.h"
+
+// BTREE
+TEST(btree, RandomInsertEraseMatchesStd) {
+  std::mt19937 rng(17);
+  for (int range : {40, 100000}) {
+    s21::btree_multiset<int> my_set;
+    std::multiset<int> orig_set;
+    for (int i = 0; i < 5000; ++i) {
+      int value = static_cast<int>(rng() % range);
+      my_set.insert(value);
+      orig_set.insert(value);
+    }
+    EXPECT_EQ(my_set.size(), orig_set.size());
+
+    for (int i = 0; i < 4000; ++i) {
+      int value = static_cast<int>(rng() % range);
+      auto my_it = my_set.find(value);
+      auto orig_it = orig_set.find(value);
+      ASSERT_EQ(my_it != my_set.end(), orig_it != orig_set.end());
+      if (orig_it != orig_set.end()) {
+        my_set.erase(my_it);
+        orig_set.erase(orig_it);
+      }
+      EXPECT_EQ(my_set.count(value), orig_set.count(value));
+    }
+    EXPECT_EQ(my_set.size(), orig_set.size());
+
+    auto my_it = my_set.begin();
+    for (int value : orig_set) EXPECT_EQ(*my_it++, value);
+    EXPECT_TRUE(my_it == my_set.end());
+    for (auto it = orig_set.rbegin(); it != orig_set.rend(); ++it)
+      EXPECT_EQ(*--my_it, *it);
+    EXPECT_TRUE(--my_it == my_set.end());
+  }
+}
+
+TEST(btree, OrderStatistics) {
+  s21::btree_set<int> my_set;
+  for (int i = 0; i < 10000; ++i) my_set.insert((i * 37) % 10000);
+
+  EXPECT_EQ(my_set.size(), 10000U);
+  for (int i = 0; i < 10000; i += 99) {
+    EXPECT_EQ(*my_set.nth(i), i);
+    EXPECT_EQ(static_cast<int>(my_set.rank(i)), i);
+  }
+  EXPECT_TRUE(my_set.nth(10000) == my_set.end());
+  EXPECT_EQ(my_set.count_range(100, 2000), 1900U);
+
+  for (int i = 0; i < 10000; i += 2) my_set.erase(my_set.find(i));
+  EXPECT_EQ(my_set.size(), 5000U);
+  EXPECT_EQ(*my_set.nth(0), 1);
+  EXPECT_EQ(*my_set.nth(4999), 9999);
+  EXPECT_EQ(my_set.rank(5000), 2500U);
+}
+
+TEST(btree, EraseToEmptyFromBothEnds) {
+  s21::btree_set<int> my_set;
+  for (int i = 0; i < 3000; ++i) my_set.insert(my_set.end(), i);
+
+  for (int i = 0; i < 1500; ++i) {
+    EXPECT_EQ(*my_set.begin(), i);
+    my_set.erase(my_set.begin());
+    EXPECT_EQ(*(--my_set.end()), 2999 - i);
+    my_set.erase(--my_set.end());
+  }
+  EXPECT_TRUE(my_set.empty());
+  EXPECT_TRUE(my_set.begin() == my_set.end());
+
+  my_set.insert(7);
+  EXPECT_EQ(*my_set.begin(), 7);
+}
+
+TEST(btree, InsertUniqueAndHints) {
+  s21::btree_set<int> my_set = {4, 2, 4, 6, 2};
+  EXPECT_EQ(my_set.size(), 3U);
+  EXPECT_FALSE(my_set.insert(4).second);
+  EXPECT_EQ(*my_set.insert(my_set.begin(), 5), 5);
+  EXPECT_EQ(*my_set.insert(my_set.end(), 2), 2);
+  EXPECT_EQ(my_set.size(), 4U);
+
+  auto result = my_set.insert_many(1, 2, 7, 1);
+  EXPECT_TRUE(result[0].second);
+  EXPECT_FALSE(result[1].second);
+  EXPECT_TRUE(result[2].second);
+  EXPECT_FALSE(result[3].second);
+  EXPECT_EQ(*result[3].first, 1);
+
+  // a wrong hint still inserts in order
+  for (int i = 1000; i > 0; --i) my_set.insert(my_set.end(), i * 10);
+  int prev = 0;
+  for (int value : my_set) {
+    EXPECT_LT(prev, value);
+    prev = value;
+  }
+  EXPECT_EQ(my_set.size(), 1006U);
+}
+
+TEST(btree, CopyMoveSwap) {
+  s21::btree_set<std::string> my_set;
+  for (int i = 0; i < 500; ++i) my_set.insert(std::to_string(i));
+
+  s21::btree_set<std::string> copy(my_set);
+  EXPECT_EQ(copy.size(), 500U);
+  copy.erase(copy.find("42"));
+  EXPECT_TRUE(my_set.contains("42"));
+  EXPECT_FALSE(copy.contains("42"));
+
+  s21::btree_set<std::string> moved(std::move(copy));
+  EXPECT_EQ(moved.size(), 499U);
+  EXPECT_TRUE(copy.empty());
+
+  s21::btree_set<std::string> other = {"x"};
+  moved.swap(other);
+  EXPECT_EQ(moved.size(), 1U);
+  EXPECT_EQ(*(--other.end()), "99");
+
+  s21::btree_set<std::string> sorted = s21::btree_set<std::string>::from_sorted(
+      my_set.begin(), my_set.end());
+  EXPECT_EQ(sorted.size(), 500U);
+  EXPECT_EQ(*sorted.nth(0), "0");
+  EXPECT_EQ(sorted.rank("5"), my_set.rank("5"));
+}
+
+TEST(btree, MultisetRanges) {
+  s21::btree_multiset<int> my_set;
+  std::multiset<int> orig_set;
+  for (int i = 0; i < 2000; ++i) {
+    my_set.insert(i % 50);
+    orig_set.insert(i % 50);
+  }
+
+  for (int key = -1; key <= 50; ++key) {
+    auto range = my_set.equal_range(key);
+    EXPECT_EQ(static_cast<size_t>(std::distance(
+                  orig_set.begin(), orig_set.lower_bound(key))),
+              my_set.rank(key));
+    size_t count = 0;
+    for (auto it = range.first; it != range.second; ++it) ++count;
+    EXPECT_EQ(count, orig_set.count(key));
+    EXPECT_TRUE(range.first == my_set.lower_bound(key));
+    EXPECT_TRUE(range.second == my_set.upper_bound(key));
+  }
+
+  s21::btree_multiset<int> other = {3, 3, 60};
+  my_set.merge(other);
+  EXPECT_EQ(my_set.count(3), 42U);
+  EXPECT_EQ(my_set.size(), 2003U);
+  EXPECT_TRUE(other.empty());
+}
+
+TEST(btree, Map) {
+  s21::btree_map<std::string, int> my_map;
+  std::map<std::string, int> orig_map;
+  std::mt19937 rng(23);
+  for (int i = 0; i < 5000; ++i) {
+    std::string key = std::to_string(rng() % 1000);
+    my_map[key] += i;
+    orig_map[key] += i;
+  }
+
+  EXPECT_EQ(my_map.size(), orig_map.size());
+  for (const auto &value : orig_map)
+    EXPECT_EQ(my_map.at(value.first), value.second);
+  EXPECT_THROW(my_map.at("none"), std::out_of_range);
+
+  EXPECT_FALSE(my_map.try_emplace("1", -1).second);
+  EXPECT_TRUE(my_map.insert_or_assign("1", -1).second);
+  EXPECT_EQ(my_map.at("1"), -1);
+
+  s21::btree_map<std::string, int> other = {{"1", 5}, {"new", 6}};
+  my_map.merge(other);
+  EXPECT_EQ(my_map.at("1"), -1);
+  EXPECT_EQ(my_map.at("new"), 6);
+}
+
+TEST(btree, MoveOnlyKeys) {
+  s21::btree_set<std::unique_ptr<int>> my_set;
+  for (int i = 0; i < 300; ++i) my_set.emplace(new int(i));
+  EXPECT_EQ(my_set.size(), 300U);
+
+  for (int i = 0; i < 200; ++i) my_set.erase(my_set.nth(i % my_set.size()));
+  int count = 0;
+  for (const auto &ptr : my_set) count += ptr != nullptr;
+  EXPECT_EQ(count, 100);
+}
+
+TEST(btree, PolymorphicAllocator) {
+  alignas(std::max_align_t) unsigned char buffer[16384];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  s21::pmr::btree_set<int> my_set(&resource);
+  for (int i = 0; i < 100; ++i) my_set.insert(i % 50);
+  EXPECT_EQ(my_set.size(), 50U);
+  EXPECT_EQ(*my_set.nth(25), 25);
+  EXPECT_TRUE(my_set.get_allocator().resource() == &resource);
+
+  s21::pmr::btree_set<int> moved = std::move(my_set);
+  EXPECT_EQ(moved.size(), 50U);
+  moved.clear();
+  moved.insert(7);
+  EXPECT_TRUE(moved.contains(7));
+}
+
+TEST(btree, SplitJoin) {
+  s21::btree_multiset<int> my_set;
+  for (int i = 0; i < 2000; ++i) my_set.insert(i % 500);
+
+  s21::btree_multiset<int> right = my_set.split(250);
+  EXPECT_EQ(my_set.size(), 1000U);
+  EXPECT_EQ(right.size(), 1000U);
+  EXPECT_EQ(*--my_set.end(), 249);
+  EXPECT_EQ(*right.begin(), 250);
+  EXPECT_EQ(right.count(250), 4U);
+
+  my_set.join(right);
+  EXPECT_TRUE(right.empty());
+  EXPECT_EQ(my_set.size(), 2000U);
+  for (int i = 0; i < 2000; i += 37) EXPECT_EQ(*my_set.nth(i), i / 4);
+}
+
+TEST(btree, SetAlgebra) {
+  s21::btree_set<int> evens, thirds;
+  for (int i = 0; i < 300000; i += 2) evens.insert(i);
+  for (int i = 0; i < 300000; i += 3) thirds.insert(i);
+
+  // large enough to be merged in parts and joined
+  s21::btree_set<int> sixths = evens.intersection_with(thirds, 4);
+  EXPECT_EQ(sixths.size(), 50000U);
+  for (int i = 0; i < 50000; i += 777) EXPECT_EQ(*sixths.nth(i), 6 * i);
+  EXPECT_EQ(evens.union_with(thirds, 4).size(), 200000U);
+  EXPECT_EQ(evens.difference_with(thirds, 4).size(), 100000U);
+
+  s21::btree_set<int> few = {3, 4, 5, 6};
+  EXPECT_EQ(evens.intersection_with(few).size(), 2U);
+  EXPECT_EQ(few.difference_with(evens).size(), 2U);
+  EXPECT_EQ(evens.difference_with(few).size(), 149998U);
+}
+
+TEST(btree, SkewedMultisetAlgebra) {
+  std::mt19937 rng(41);
+  for (int trial = 0; trial < 5; ++trial) {
+    // a few keys repeated, searched in a multiset many times larger,
+    // where equal keys spread over several nodes
+    s21::btree_multiset<std::string> large, small;
+    std::multiset<std::string> origLarge, origSmall;
+    for (int i = 0; i < 20000; ++i) {
+      std::string value = std::to_string(rng() % 4000);
+      large.insert(value);
+      origLarge.insert(value);
+    }
+    for (int i = 0; i < 100; ++i) {
+      std::string value = std::to_string(rng() % 4000);
+      for (int copies = 1 + rng() % 6; copies; --copies) {
+        small.insert(value);
+        origSmall.insert(value);
+      }
+    }
+
+    std::vector<std::string> expected;
+    std::set_intersection(origLarge.begin(), origLarge.end(),
+                          origSmall.begin(), origSmall.end(),
+                          std::back_inserter(expected));
+    s21::btree_multiset<std::string> result = large.intersection_with(small);
+    ASSERT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+    expected.clear();
+    std::set_union(origLarge.begin(), origLarge.end(), origSmall.begin(),
+                   origSmall.end(), std::back_inserter(expected));
+    result = small.union_with(large);
+    ASSERT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+    expected.clear();
+    std::set_difference(origSmall.begin(), origSmall.end(),
+                        origLarge.begin(), origLarge.end(),
+                        std::back_inserter(expected));
+    result = small.difference_with(large);
+    ASSERT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+  }
+}
+
+TEST(btree, ExtractInsertMerge) {
+  s21::btree_map<std::string, int> my_map;
+  for (int i = 0; i < 1000; ++i) my_map[std::to_string(i)] = i;
+
+  auto node = my_map.extract("500");
+  EXPECT_EQ(node.mapped(), 500);
+  node.key() = "x";
+  EXPECT_TRUE(my_map.insert(std::move(node)).inserted);
+  EXPECT_EQ(my_map.at("x"), 500);
+  EXPECT_FALSE(my_map.contains("500"));
+
+  s21::btree_map<std::string, int> other;
+  for (int i = 0; i < 1000; i += 2) other[std::to_string(i)] = -i;
+  my_map.merge(other);
+  EXPECT_EQ(my_map.size(), 1001U);
+  EXPECT_EQ(my_map.at("500"), -500);
+  EXPECT_EQ(my_map.at("2"), 2);
+  EXPECT_EQ(other.size(), 499U);
+  EXPECT_EQ(other.at("2"), -2);
+  EXPECT_TRUE(other.nth(498) == other.find("998"));
+}
+
+TEST(btree, ExtractTakesTheFirstEqual) {
+  struct FirstLess {
+    bool operator()(const std::pair<int, int> &a,
+                    const std::pair<int, int> &b) const {
+      return a.first < b.first;
+    }
+  };
+
+  // equal values spread over a node and its children
+  s21::btree_multiset<std::pair<int, int>, FirstLess> my_set;
+  for (int copy = 0; copy < 10; ++copy)
+    for (int key = 0; key < 200; ++key) my_set.insert({key, copy});
+  for (int key = 0; key < 200; ++key) {
+    const std::pair<int, int> first = *my_set.lower_bound({key, -1});
+    auto node = my_set.extract(std::pair<int, int>(key, -1));
+    ASSERT_FALSE(node.empty());
+    EXPECT_EQ(node.value(), first);
+  }
+  EXPECT_EQ(my_set.size(), 1800U);
+}
+
+TEST(btree, MergeInOneWalk) {
+  s21::btree_multiset<int> my_set, my_other;
+  std::multiset<int> orig_set, orig_other;
+  std::mt19937 rng(25);
+  for (int i = 0; i < 5000; ++i) {
+    int value = static_cast<int>(rng() % 3000);
+    my_set.insert(value);
+    orig_set.insert(value);
+    value = static_cast<int>(rng() % 3000);
+    my_other.insert(value);
+    orig_other.insert(value);
+  }
+
+  my_set.merge(my_other);
+  orig_set.merge(orig_other);
+  EXPECT_TRUE(my_other.empty());
+  ASSERT_EQ(my_set.size(), orig_set.size());
+  EXPECT_TRUE(std::equal(orig_set.begin(), orig_set.end(), my_set.begin()));
+  for (int i = 0; i < 10000; i += 97)
+    EXPECT_EQ(*my_set.nth(i), *std::next(orig_set.begin(), i));
+
+  s21::btree_set<int> unique = {1, 3, 5, 7};
+  s21::btree_set<int> more = {0, 3, 4, 7, 9};
+  unique.merge(more);
+  EXPECT_EQ(unique.size(), 7U);
+  EXPECT_EQ(more.size(), 2U);
+  EXPECT_EQ(*more.begin(), 3);
+  EXPECT_EQ(*more.nth(1), 7);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <memory_resource>
+
+#include "FlatTree.h"
+#include "s21_map.h"
+#include "s21_multiset.h"
+#include "s21_set.h"
+
+// The containers on a sorted s21::vector: the same public interface, with
+// lookups by binary search over contiguous elements and no overhead per
+// element, for small or read-mostly containers best built with from_sorted.
+// An insert or erase moves every element after it, so it takes linear time
+// and invalidates the iterators and references to those elements.
+namespace s21 {
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>>
+using flat_set = set<Key, Compare, Allocator, FlatTree>;
+
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>>
+using flat_multiset = multiset<Key, Compare, Allocator, FlatTree>;
+
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<s21_pair<Key, T>>>
+using flat_map = map<Key, T, Compare, Allocator, FlatTree>;
+
+namespace pmr {
+template <typename Key>
+using flat_set =
+    s21::flat_set<Key, std::less<Key>, std::pmr::polymorphic_allocator<Key>>;
+
+template <typename Key>
+using flat_multiset =
+    s21::flat_multiset<Key, std::less<Key>,
+                       std::pmr::polymorphic_allocator<Key>>;
+
+template <typename Key, typename T>
+using flat_map =
+    s21::flat_map<Key, T, std::less<Key>,
+                  std::pmr::polymorphic_allocator<s21_pair<Key, T>>>;
+}  // namespace pmr
+}  // namespace s21
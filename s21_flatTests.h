@@ -0,0 +1,274 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "s21_flat.h"
+
+// FLAT
+TEST(flat, RandomInsertEraseMatchesStd) {
+  std::mt19937 rng(19);
+  for (int range : {40, 100000}) {
+    s21::flat_multiset<int> my_set;
+    std::multiset<int> orig_set;
+    for (int i = 0; i < 3000; ++i) {
+      int value = static_cast<int>(rng() % range);
+      my_set.insert(value);
+      orig_set.insert(value);
+    }
+    EXPECT_EQ(my_set.size(), orig_set.size());
+
+    for (int i = 0; i < 2000; ++i) {
+      int value = static_cast<int>(rng() % range);
+      auto my_it = my_set.find(value);
+      auto orig_it = orig_set.find(value);
+      ASSERT_EQ(my_it != my_set.end(), orig_it != orig_set.end());
+      if (orig_it != orig_set.end()) {
+        my_set.erase(my_it);
+        orig_set.erase(orig_it);
+      }
+      EXPECT_EQ(my_set.count(value), orig_set.count(value));
+    }
+    EXPECT_EQ(my_set.size(), orig_set.size());
+
+    auto my_it = my_set.begin();
+    for (int value : orig_set) EXPECT_EQ(*my_it++, value);
+    EXPECT_TRUE(my_it == my_set.end());
+    EXPECT_TRUE(++my_it == my_set.end());
+    for (auto it = orig_set.rbegin(); it != orig_set.rend(); ++it)
+      EXPECT_EQ(*--my_it, *it);
+    EXPECT_TRUE(--my_it == my_set.end());
+  }
+}
+
+TEST(flat, SearchesEverySize) {
+  // the halving search has a different shape for every length
+  for (int size = 0; size < 70; ++size) {
+    s21::vector<int> values;
+    for (int i = 0; i < size; ++i) values.push_back(2 * i);
+    auto my_set = s21::flat_set<int>::from_sorted(values.begin(), values.end());
+    ASSERT_EQ(my_set.size(), static_cast<size_t>(size));
+
+    for (int key = -1; key <= 2 * size; ++key) {
+      EXPECT_EQ(my_set.contains(key), key % 2 == 0 && key < 2 * size);
+      EXPECT_EQ(my_set.rank(key), static_cast<size_t>((key + 1) / 2));
+    }
+  }
+}
+
+TEST(flat, OrderStatistics) {
+  s21::flat_set<int> my_set;
+  for (int i = 0; i < 2000; ++i) my_set.insert((i * 37) % 2000);
+
+  EXPECT_EQ(my_set.size(), 2000U);
+  for (int i = 0; i < 2000; i += 33) {
+    EXPECT_EQ(*my_set.nth(i), i);
+    EXPECT_EQ(static_cast<int>(my_set.rank(i)), i);
+  }
+  EXPECT_TRUE(my_set.nth(2000) == my_set.end());
+  EXPECT_EQ(my_set.count_range(100, 500), 400U);
+  EXPECT_EQ(my_set.count_range(500, 100), 0U);
+}
+
+TEST(flat, InsertUniqueAndHints) {
+  s21::flat_set<int> my_set = {4, 2, 4, 6, 2};
+  EXPECT_EQ(my_set.size(), 3U);
+  EXPECT_FALSE(my_set.insert(4).second);
+  EXPECT_EQ(*my_set.insert(my_set.begin(), 5), 5);
+  EXPECT_EQ(*my_set.insert(my_set.end(), 2), 2);
+  EXPECT_EQ(my_set.size(), 4U);
+
+  auto result = my_set.insert_many(1, 2, 7, 1);
+  EXPECT_TRUE(result[0].second);
+  EXPECT_FALSE(result[1].second);
+  EXPECT_TRUE(result[2].second);
+  EXPECT_FALSE(result[3].second);
+  EXPECT_EQ(*result[3].first, 1);
+
+  // a wrong hint still inserts in order
+  for (int i = 100; i > 0; --i) my_set.insert(my_set.end(), i * 10);
+  int prev = 0;
+  for (int value : my_set) {
+    EXPECT_LT(prev, value);
+    prev = value;
+  }
+  EXPECT_EQ(my_set.size(), 106U);
+}
+
+TEST(flat, CopyMoveSwap) {
+  s21::flat_set<std::string> my_set;
+  for (int i = 0; i < 300; ++i) my_set.insert(std::to_string(i));
+
+  s21::flat_set<std::string> copy(my_set);
+  copy.erase(copy.find("42"));
+  EXPECT_TRUE(my_set.contains("42"));
+  EXPECT_FALSE(copy.contains("42"));
+
+  s21::flat_set<std::string> moved(std::move(copy));
+  EXPECT_EQ(moved.size(), 299U);
+  EXPECT_TRUE(copy.empty());
+
+  s21::flat_set<std::string> other = {"x"};
+  moved.swap(other);
+  EXPECT_EQ(moved.size(), 1U);
+  EXPECT_EQ(*(--other.end()), "99");
+
+  s21::vector<int> none;
+  s21::flat_multiset<int> multi =
+      s21::flat_multiset<int>::from_sorted(none.begin(), none.end());
+  EXPECT_TRUE(multi.empty());
+  multi = {3, 1, 3, 2, 3};
+  EXPECT_EQ(multi.count(3), 3U);
+  EXPECT_EQ(*multi.begin(), 1);
+}
+
+TEST(flat, Map) {
+  s21::flat_map<std::string, int> my_map;
+  std::map<std::string, int> orig_map;
+  std::mt19937 rng(29);
+  for (int i = 0; i < 3000; ++i) {
+    std::string key = std::to_string(rng() % 500);
+    my_map[key] += i;
+    orig_map[key] += i;
+  }
+
+  EXPECT_EQ(my_map.size(), orig_map.size());
+  for (const auto &value : orig_map)
+    EXPECT_EQ(my_map.at(value.first), value.second);
+  EXPECT_THROW(my_map.at("none"), std::out_of_range);
+
+  EXPECT_FALSE(my_map.try_emplace("1", -1).second);
+  EXPECT_TRUE(my_map.insert_or_assign("1", -1).second);
+  EXPECT_EQ(my_map.at("1"), -1);
+
+  s21::flat_map<std::string, int> other = {{"1", 5}, {"new", 6}};
+  my_map.merge(other);
+  EXPECT_EQ(my_map.at("1"), -1);
+  EXPECT_EQ(my_map.at("new"), 6);
+
+  auto sorted = s21::flat_map<std::string, int>::from_sorted(orig_map.begin(),
+                                                            orig_map.end());
+  EXPECT_EQ(sorted.size(), orig_map.size());
+  EXPECT_EQ(sorted.begin()->first, orig_map.begin()->first);
+}
+
+TEST(flat, PolymorphicAllocator) {
+  alignas(std::max_align_t) unsigned char buffer[16384];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  s21::pmr::flat_set<int> my_set(&resource);
+  for (int i = 0; i < 100; ++i) my_set.insert(i % 50);
+  EXPECT_EQ(my_set.size(), 50U);
+  EXPECT_EQ(*my_set.nth(25), 25);
+  EXPECT_TRUE(my_set.get_allocator().resource() == &resource);
+
+  s21::pmr::flat_set<int> moved = std::move(my_set);
+  EXPECT_EQ(moved.size(), 50U);
+  moved.clear();
+  moved.insert(7);
+  EXPECT_TRUE(moved.contains(7));
+}
+
+TEST(flat, SplitJoin) {
+  s21::flat_map<std::string, int> my_map;
+  for (int i = 0; i < 100; ++i) my_map[std::to_string(i)] = i;
+
+  s21::flat_map<std::string, int> right = my_map.split("5");
+  EXPECT_EQ(my_map.size(), 45U);
+  EXPECT_EQ(right.size(), 55U);
+  EXPECT_EQ(right.begin()->first, "5");
+  EXPECT_EQ(right.at("99"), 99);
+
+  EXPECT_THROW(right.join(my_map), std::invalid_argument);
+  my_map.join(right);
+  EXPECT_TRUE(right.empty());
+  EXPECT_EQ(my_map.size(), 100U);
+  EXPECT_EQ(my_map.at("42"), 42);
+}
+
+TEST(flat, SetAlgebra) {
+  s21::flat_set<int> evens, thirds;
+  for (int i = 0; i < 300000; i += 2) evens.insert(evens.end(), i);
+  for (int i = 0; i < 300000; i += 3) thirds.insert(thirds.end(), i);
+
+  s21::flat_set<int> sixths = evens.intersection_with(thirds, 4);
+  EXPECT_EQ(sixths.size(), 50000U);
+  for (int i = 0; i < 50000; i += 777) EXPECT_EQ(*sixths.nth(i), 6 * i);
+  EXPECT_EQ(evens.union_with(thirds, 4).size(), 200000U);
+  EXPECT_EQ(evens.difference_with(thirds, 4).size(), 100000U);
+
+  s21::flat_set<int> few = {3, 4, 5, 6};
+  EXPECT_EQ(evens.intersection_with(few).size(), 2U);
+  EXPECT_EQ(few.union_with(evens).size(), 150002U);
+}
+
+TEST(flat, SkewedMultisetAlgebra) {
+  std::mt19937 rng(41);
+  for (int trial = 0; trial < 5; ++trial) {
+    // a few keys repeated, searched in a multiset many times larger
+    s21::flat_multiset<std::string> large, small;
+    std::multiset<std::string> origLarge, origSmall;
+    for (int i = 0; i < 20000; ++i)
+      origLarge.insert(std::to_string(rng() % 4000));
+    for (int i = 0; i < 100; ++i) {
+      std::string value = std::to_string(rng() % 4000);
+      for (int copies = 1 + rng() % 6; copies; --copies)
+        origSmall.insert(value);
+    }
+    for (const std::string &value : origLarge) large.insert(large.end(), value);
+    for (const std::string &value : origSmall) small.insert(small.end(), value);
+
+    std::vector<std::string> expected;
+    std::set_intersection(origLarge.begin(), origLarge.end(),
+                          origSmall.begin(), origSmall.end(),
+                          std::back_inserter(expected));
+    s21::flat_multiset<std::string> result = large.intersection_with(small);
+    ASSERT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+    expected.clear();
+    std::set_union(origLarge.begin(), origLarge.end(), origSmall.begin(),
+                   origSmall.end(), std::back_inserter(expected));
+    result = small.union_with(large);
+    ASSERT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+    expected.clear();
+    std::set_difference(origSmall.begin(), origSmall.end(),
+                        origLarge.begin(), origLarge.end(),
+                        std::back_inserter(expected));
+    result = small.difference_with(large);
+    ASSERT_EQ(result.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+  }
+}
+
+TEST(flat, ExtractInsertMerge) {
+  s21::flat_multiset<int> my_set = {1, 3, 3, 5};
+  auto node = my_set.extract(3);
+  node.value() = 4;
+  my_set.insert(std::move(node));
+  EXPECT_EQ(my_set.count(3), 1U);
+  EXPECT_EQ(*my_set.nth(2), 4);
+
+  s21::flat_multiset<int> other = {0, 3, 6};
+  my_set.merge(other);
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(my_set.size(), 7U);
+  EXPECT_EQ(my_set.count(3), 2U);
+
+  s21::flat_set<int> unique = {1, 2};
+  s21::flat_set<int> more = {2, 3};
+  unique.merge(more);
+  EXPECT_EQ(unique.size(), 3U);
+  EXPECT_EQ(more.size(), 1U);
+  EXPECT_EQ(*more.begin(), 2);
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+#include "FrozenTree.h"
+#include "s21_pair.h"
+
+// Read-only snapshots for containers that are built once and then only
+// queried, made by set::freeze(), multiset::freeze() and map::freeze() or
+// from a sorted range. The elements are laid out for searching (see
+// FrozenTree.h) and cannot change; iteration still visits them in order.
+// A frozen multiset is a frozen_set holding the repeated keys.
+namespace s21 {
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>>
+class frozen_set {
+  using Tree = FrozenTree<Key, Allocator, Identity, Compare>;
+
+ public:
+  using key_type = Key;
+  using value_type = Key;
+  using reference = const value_type &;
+  using const_reference = const value_type &;
+  using iterator = typename Tree::Iterator;
+  using const_iterator = const typename Tree::Iterator;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+
+ public:
+  frozen_set() = default;
+  explicit frozen_set(const Compare &comp,
+                      const Allocator &alloc = Allocator())
+      : tree_(comp, alloc) {}
+
+  // the snapshot of a range sorted in the order of comp, repeated keys
+  // are kept
+  template <typename ForwardIt>
+  static frozen_set from_sorted(ForwardIt first, ForwardIt last,
+                                const Compare &comp = Compare(),
+                                const Allocator &alloc = Allocator()) {
+    frozen_set result(comp, alloc);
+    result.tree_.AssignSorted(first, last);
+    return result;
+  }
+
+ public:
+  allocator_type get_allocator() const { return tree_.GetAllocator(); }
+  key_compare key_comp() const { return tree_.GetCompare(); }
+
+ public:
+  iterator begin() const { return tree_.begin(); }
+  iterator end() const { return tree_.end(); }
+
+ public:
+  bool empty() const noexcept { return tree_.Empty(); }
+  size_type size() const noexcept { return tree_.Size(); }
+
+ public:
+  template <typename K = Key>
+  iterator find(const K &key) const {
+    return tree_.Find(key);
+  }
+  template <typename K = Key>
+  bool contains(const K &key) const {
+    return tree_.Contains(key);
+  }
+  template <typename K = Key>
+  size_type count(const K &key) const {
+    return tree_.Count(key);
+  }
+  template <typename K = Key>
+  std::pair<iterator, iterator> equal_range(const K &key) const {
+    return tree_.equal_range(key);
+  }
+  template <typename K = Key>
+  iterator lower_bound(const K &key) const {
+    return tree_.lower_bound(key);
+  }
+  template <typename K = Key>
+  iterator upper_bound(const K &key) const {
+    return tree_.upper_bound(key);
+  }
+
+ private:
+  Tree tree_;
+};
+
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<s21_pair<Key, T>>>
+class frozen_map {
+  using Tree = FrozenTree<s21_pair<Key, T>, Allocator, SelectFirst, Compare>;
+
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = s21_pair<Key, T>;
+  using reference = const value_type &;
+  using const_reference = const value_type &;
+  using iterator = typename Tree::Iterator;
+  using const_iterator = const typename Tree::Iterator;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+
+ public:
+  frozen_map() = default;
+  explicit frozen_map(const Compare &comp,
+                      const Allocator &alloc = Allocator())
+      : tree_(comp, alloc) {}
+
+  // the snapshot of a range of value_type or std::pair sorted by key in
+  // the order of comp, which must not repeat keys
+  template <typename ForwardIt>
+  static frozen_map from_sorted(ForwardIt first, ForwardIt last,
+                                const Compare &comp = Compare(),
+                                const Allocator &alloc = Allocator()) {
+    frozen_map result(comp, alloc);
+    result.tree_.AssignSorted(first, last);
+    return result;
+  }
+
+ public:
+  allocator_type get_allocator() const { return tree_.GetAllocator(); }
+  key_compare key_comp() const { return tree_.GetCompare(); }
+
+ public:
+  const T &at(const Key &key) const {
+    iterator it = tree_.Find(key);
+    if (it)
+      return (*it).second;
+    else
+      throw std::out_of_range("out of map range");
+  }
+
+ public:
+  iterator begin() const { return tree_.begin(); }
+  iterator end() const { return tree_.end(); }
+
+ public:
+  bool empty() const noexcept { return tree_.Empty(); }
+  size_type size() const noexcept { return tree_.Size(); }
+
+ public:
+  template <typename K = Key>
+  iterator find(const K &key) const {
+    return tree_.Find(key);
+  }
+  template <typename K = Key>
+  bool contains(const K &key) const {
+    return tree_.Contains(key);
+  }
+  template <typename K = Key>
+  size_type count(const K &key) const {
+    return tree_.Count(key);
+  }
+  template <typename K = Key>
+  std::pair<iterator, iterator> equal_range(const K &key) const {
+    return tree_.equal_range(key);
+  }
+  template <typename K = Key>
+  iterator lower_bound(const K &key) const {
+    return tree_.lower_bound(key);
+  }
+  template <typename K = Key>
+  iterator upper_bound(const K &key) const {
+    return tree_.upper_bound(key);
+  }
+
+ private:
+  Tree tree_;
+};
+}  // namespace s21
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+
+#include "s21_map.h"
+#include "s21_multiset.h"
+#include "s21_set.h"
+
+// FROZEN
+TEST(frozen, SearchesAndIteratesEverySize) {
+  // every size gives the implicit tree a different last level
+  for (int size = 0; size < 70; ++size) {
+    s21::set<int> my_set;
+    for (int i = 0; i < size; ++i) my_set.insert(2 * i);
+    s21::frozen_set<int> frozen = my_set.freeze();
+    ASSERT_EQ(frozen.size(), static_cast<size_t>(size));
+
+    for (int key = -1; key <= 2 * size; ++key) {
+      EXPECT_EQ(frozen.contains(key), key % 2 == 0 && key < 2 * size);
+      auto it = frozen.lower_bound(key);
+      if (key < 2 * size - 1) {
+        EXPECT_EQ(*it, (key + 1) / 2 * 2);
+      } else {
+        EXPECT_TRUE(it == frozen.end());
+      }
+    }
+
+    int expected = 0;
+    for (int value : frozen) {
+      EXPECT_EQ(value, expected);
+      expected += 2;
+    }
+    EXPECT_EQ(expected, 2 * size);
+    auto it = frozen.end();
+    for (int i = size - 1; i >= 0; --i) EXPECT_EQ(*--it, 2 * i);
+    EXPECT_TRUE(--it == frozen.end());
+  }
+}
+
+TEST(frozen, MatchesStdSet) {
+  std::mt19937 rng(41);
+  s21::set<int> my_set;
+  std::set<int> orig_set;
+  for (int i = 0; i < 5000; ++i) {
+    int value = static_cast<int>(rng() % 20000);
+    my_set.insert(value);
+    orig_set.insert(value);
+  }
+
+  s21::frozen_set<int> frozen = my_set.freeze();
+  EXPECT_EQ(frozen.size(), orig_set.size());
+  for (int key = -1; key <= 20000; key += 7) {
+    auto my_it = frozen.upper_bound(key);
+    auto orig_it = orig_set.upper_bound(key);
+    ASSERT_EQ(my_it == frozen.end(), orig_it == orig_set.end());
+    if (orig_it != orig_set.end()) {
+      EXPECT_EQ(*my_it, *orig_it);
+    }
+    EXPECT_EQ(frozen.count(key), orig_set.count(key));
+  }
+
+  // the snapshot does not follow later changes
+  my_set.insert(-5);
+  EXPECT_FALSE(frozen.contains(-5));
+}
+
+TEST(frozen, Multiset) {
+  s21::multiset<int> my_set = {5, 1, 5, 3, 5, 1};
+  s21::frozen_set<int> frozen = my_set.freeze();
+
+  EXPECT_EQ(frozen.size(), 6U);
+  EXPECT_EQ(frozen.count(5), 3U);
+  EXPECT_EQ(frozen.count(1), 2U);
+  EXPECT_EQ(frozen.count(2), 0U);
+  auto range = frozen.equal_range(5);
+  EXPECT_EQ(*--range.first, 3);
+  EXPECT_TRUE(range.second == frozen.end());
+}
+
+TEST(frozen, Map) {
+  s21::map<std::string, int> my_map;
+  std::map<std::string, int> orig_map;
+  for (int i = 0; i < 1000; ++i) {
+    my_map[std::to_string(i)] = i;
+    orig_map[std::to_string(i)] = i;
+  }
+
+  s21::frozen_map<std::string, int> frozen = my_map.freeze();
+  EXPECT_EQ(frozen.size(), 1000U);
+  for (const auto &value : orig_map)
+    EXPECT_EQ(frozen.at(value.first), value.second);
+  EXPECT_THROW(frozen.at("none"), std::out_of_range);
+  EXPECT_TRUE(frozen.find("x") == frozen.end());
+  EXPECT_EQ(frozen.find("42")->second, 42);
+
+  auto orig_it = orig_map.begin();
+  for (auto it = frozen.begin(); it != frozen.end(); ++it, ++orig_it)
+    EXPECT_EQ((*it).first, orig_it->first);
+
+  auto sorted = s21::frozen_map<std::string, int>::from_sorted(
+      orig_map.begin(), orig_map.end());
+  EXPECT_EQ(sorted.size(), 1000U);
+  EXPECT_EQ(sorted.at("999"), 999);
+}
+
+TEST(frozen, TransparentCompare) {
+  s21::set<std::string, std::less<>> my_set = {"alpha", "beta", "gamma"};
+  s21::frozen_set<std::string, std::less<>> frozen = my_set.freeze();
+
+  EXPECT_TRUE(frozen.contains(std::string_view("beta")));
+  EXPECT_FALSE(frozen.contains("delta"));
+  EXPECT_EQ(*frozen.lower_bound("b"), "beta");
+}
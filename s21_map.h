@@ -1,225 +1,556 @@
-#pragma once
-
-#include <initializer_list>
-#include <limits>
-#include <stdexcept>
-
-#include "RBTree.h"
-#include "s21_pair.h"
-#include "s21_vector.h"
-
-namespace s21 {
-
-template <typename Key, typename T, typename value_type = s21_pair<Key, T>>
-class map {
- public:
-  using iterator = typename RBTree<value_type>::RBIterator;
-  using const_iterator = const typename RBTree<value_type>::RBIterator;
-  using size_type = std::size_t;
-
- public:
-  map() = default;
-  map(std::initializer_list<value_type> const &items);
-  map(const map &m);
-  map(map &&m);
-  ~map();
-
- public:
-  map &operator=(const map &m);
-  map &operator=(map &&m);
-
- public:
-  T &at(const Key &key);
-  T &operator[](const Key &key);
-
- public:
-  iterator begin();
-  iterator end();
-
- public:
-  bool contains(const Key &key);
-  bool empty();
-  size_type size();
-  size_type max_size();
-  void clear();
-
- public:
-  std::pair<iterator, bool> insert(const value_type &value);
-  std::pair<iterator, bool> insert(const std::pair<Key, T> value);
-  std::pair<iterator, bool> insert(const Key &key, const T &obj);
-  std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj);
-  void erase(iterator pos);
-  void swap(map &other);
-  void merge(map &other);
-
- public:
-  template <typename... Args>
-  s21::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
-    s21::vector<std::pair<iterator, bool>> result;
-    InsertManyRec(result, args...);
-    return result;
-  }
-
- private:
-  template <typename T0, typename... Args>
-  void InsertManyRec(s21::vector<std::pair<iterator, bool>> &vec, const T0 &v0,
-                     Args &&...args) {
-    if constexpr (sizeof...(args) != 0) {
-      if (rbTree_.Contains(value_type{v0}))
-        vec.push_back({rbTree_.Find(value_type{v0}), false});
-      else
-        vec.push_back(insert(v0));
-      InsertManyRec(vec, args...);
-    } else {
-      if (rbTree_.Contains(value_type{v0}))
-        vec.push_back({rbTree_.Find(value_type{v0}), false});
-      else
-        vec.push_back(insert(v0));
-    }
-  }
-
- private:
-  RBTree<value_type> rbTree_;
-};
-}  // namespace s21
-
-template <typename Key, typename T, typename value_type>
-s21::map<Key, T, value_type>::map(
-    std::initializer_list<value_type> const &items) {
-  for (const value_type &val : items) rbTree_.Insert(val);
-}
-
-template <typename Key, typename T, typename value_type>
-s21::map<Key, T, value_type>::map(const map &m) {
-  if (rbTree_ != m.rbTree_) rbTree_ = m.rbTree_;
-}
-
-template <typename Key, typename T, typename value_type>
-s21::map<Key, T, value_type>::map(map &&m) {
-  if (rbTree_ != m.rbTree_) rbTree_ = std::move(m.rbTree_);
-}
-
-template <typename Key, typename T, typename value_type>
-s21::map<Key, T, value_type>::~map() {
-  rbTree_.Clear();
-}
-
-template <typename Key, typename T, typename value_type>
-s21::map<Key, T, value_type> &s21::map<Key, T, value_type>::operator=(map &&m) {
-  if (rbTree_ != m.rbTree_) rbTree_ = std::move(m.rbTree_);
-  return *this;
-}
-
-template <typename Key, typename T, typename value_type>
-s21::map<Key, T, value_type> &s21::map<Key, T, value_type>::operator=(
-    const map &m) {
-  if (rbTree_ != m.rbTree_) rbTree_ = m.rbTree_;
-  return *this;
-}
-
-template <typename Key, typename T, typename value_type>
-T &s21::map<Key, T, value_type>::at(const Key &key) {
-  iterator it = rbTree_.Find({key, {}});
-  if (it && it != rbTree_.end())
-    return (*it).second;
-  else
-    throw std::out_of_range("out of map range");
-}
-
-template <typename Key, typename T, typename value_type>
-T &s21::map<Key, T, value_type>::operator[](const Key &key) {
-  return (*rbTree_.Find({key, {}})).second;
-}
-
-template <typename Key, typename T, typename value_type>
-typename s21::map<Key, T, value_type>::iterator
-s21::map<Key, T, value_type>::begin() {
-  return rbTree_.begin();
-}
-
-template <typename Key, typename T, typename value_type>
-typename s21::map<Key, T, value_type>::iterator
-s21::map<Key, T, value_type>::end() {
-  return rbTree_.end();
-}
-
-template <typename Key, typename T, typename value_type>
-bool s21::map<Key, T, value_type>::contains(const Key &key) {
-  return rbTree_.Contains({key, {}});
-}
-
-template <typename Key, typename T, typename value_type>
-bool s21::map<Key, T, value_type>::empty() {
-  return rbTree_.Empty();
-}
-
-template <typename Key, typename T, typename value_type>
-typename s21::map<Key, T, value_type>::size_type
-s21::map<Key, T, value_type>::size() {
-  return rbTree_.Size();
-}
-
-template <typename Key, typename T, typename value_type>
-typename s21::map<Key, T, value_type>::size_type
-s21::map<Key, T, value_type>::max_size() {
-  return std::numeric_limits<value_type>::max();  // need test
-}
-
-template <typename Key, typename T, typename value_type>
-void s21::map<Key, T, value_type>::clear() {
-  rbTree_.Clear();
-}
-
-template <typename Key, typename T, typename value_type>
-std::pair<typename s21::map<Key, T, value_type>::iterator, bool>
-s21::map<Key, T, value_type>::insert(const value_type &value) {
-  if (rbTree_.Contains(value))
-    return {rbTree_.Find(value), false};
-  else
-    return rbTree_.Insert(value);
-}
-
-template <typename Key, typename T, typename value_type>
-std::pair<typename s21::map<Key, T, value_type>::iterator, bool>
-s21::map<Key, T, value_type>::insert(const std::pair<Key, T> value) {
-  if (rbTree_.Contains(value_type{value.first, value.second}))
-    return {rbTree_.Find(value_type{value.first, value.second}), false};
-  else
-    return rbTree_.Insert(value_type{value.first, value.second});
-}
-
-template <typename Key, typename T, typename value_type>
-std::pair<typename s21::map<Key, T, value_type>::iterator, bool>
-s21::map<Key, T, value_type>::insert(const Key &key, const T &obj) {
-  if (rbTree_.Contains({key, {}}))
-    return {rbTree_.Find({key, {}}), false};
-  else
-    return rbTree_.Insert({key, obj});
-}
-
-template <typename Key, typename T, typename value_type>
-std::pair<typename s21::map<Key, T, value_type>::iterator, bool>
-s21::map<Key, T, value_type>::insert_or_assign(const Key &key, const T &obj) {
-  if (rbTree_.Contains({key, {}})) {
-    iterator it = rbTree_.Find({key, {}});
-    (*it).second = obj;
-    return {it, true};
-  } else
-    return rbTree_.Insert({key, obj});
-}
-
-template <typename Key, typename T, typename value_type>
-void s21::map<Key, T, value_type>::erase(iterator pos) {
-  if (pos != rbTree_.end()) rbTree_.Erase(pos);
-}
-
-template <typename Key, typename T, typename value_type>
-void s21::map<Key, T, value_type>::swap(map &other) {
-  rbTree_.Swap(other.rbTree_);
-}
-
-template <typename Key, typename T, typename value_type>
-void s21::map<Key, T, value_type>::merge(map &other) {
-  for (const auto &val : other)
-    if (!rbTree_.Contains(val)) rbTree_.Insert(val);
-}
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+
+#include "RBTree.h"
+#include "s21_frozen.h"
+#include "s21_node_handle.h"
+#include "s21_pair.h"
+#include "s21_vector.h"
+
+namespace s21 {
+
+// the elements are kept in a Tree, RBTree by default, BTree (see
+// s21_btree.h) or FlatTree (see s21_flat.h); all have the same interface
+template <typename Key, typename T, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<s21_pair<Key, T>>,
+          template <typename, typename, typename, typename> class Tree = RBTree>
+class map {
+ public:
+  using value_type = s21_pair<Key, T>;
+  using iterator =
+      typename Tree<value_type, Allocator, SelectFirst, Compare>::Iterator;
+  using const_iterator = const iterator;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using node_type = map_node_handle<
+      typename Tree<value_type, Allocator, SelectFirst, Compare>::NodeHandle,
+      Key, T, Allocator>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
+
+ public:
+  map() = default;
+  explicit map(const Compare &comp, const Allocator &alloc = Allocator());
+  explicit map(const Allocator &alloc);
+  map(std::initializer_list<value_type> const &items,
+      const Compare &comp = Compare(), const Allocator &alloc = Allocator());
+  map(std::initializer_list<value_type> const &items, const Allocator &alloc);
+  map(const map &m);
+  map(map &&m);
+  ~map();
+
+ public:
+  template <typename InputIt>
+  map(InputIt first, InputIt last, const Compare &comp = Compare(),
+      const Allocator &alloc = Allocator())
+      : tree_(comp, alloc) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      if (std::is_sorted(first, last, [&comp](const auto &a, const auto &b) {
+            return comp(a.first, b.first);
+          })) {
+        AssignSorted(first, last);
+        return;
+      }
+    }
+    for (; first != last; ++first) insert(end(), *first);
+  }
+
+  template <typename InputIt>
+  map(InputIt first, InputIt last, const Allocator &alloc)
+      : map(first, last, Compare(), alloc) {}
+
+  // builds the map in O(n) from a range of value_type or std::pair sorted by
+  // key in the order of comp, only the first pair of equal keys is kept
+  template <typename InputIt>
+  static map from_sorted(InputIt first, InputIt last,
+                         const Compare &comp = Compare(),
+                         const Allocator &alloc = Allocator()) {
+    map result(comp, alloc);
+    result.AssignSorted(first, last);
+    return result;
+  }
+
+ public:
+  allocator_type get_allocator() const;
+  key_compare key_comp() const;
+
+ public:
+  map &operator=(const map &m);
+  map &operator=(map &&m);
+
+ public:
+  T &at(const Key &key);
+  T &operator[](const Key &key);
+
+ public:
+  iterator begin();
+  iterator end();
+
+ public:
+  // with a transparent Compare such as std::less<> key may be of any type
+  // comparable with Key, e.g. std::string_view for std::string keys, and is
+  // looked up as it is; otherwise it is converted to Key once
+  template <typename K = Key>
+  iterator find(const K &key);
+  template <typename K = Key>
+  bool contains(const K &key);
+  // appends to out the result of find for every key of [first, last),
+  // running the searches side by side so that their cache misses overlap
+  template <typename ForwardIt>
+  void find_many(ForwardIt first, ForwardIt last,
+                 s21::vector<iterator> &out);
+
+ public:
+  bool empty();
+  size_type size();
+  size_type max_size();
+  void clear();
+
+ public:
+  std::pair<iterator, bool> insert(const value_type &value);
+  std::pair<iterator, bool> insert(value_type &&value);
+  iterator insert(iterator hint, const value_type &value);
+  iterator insert(iterator hint, value_type &&value);
+  std::pair<iterator, bool> insert(const std::pair<Key, T> &value);
+  std::pair<iterator, bool> insert(std::pair<Key, T> &&value);
+  std::pair<iterator, bool> insert(const Key &key, const T &obj);
+  std::pair<iterator, bool> insert_or_assign(const Key &key, const T &obj);
+  void erase(iterator pos);
+  void swap(map &other);
+  // moves the elements of other with keys this map lacks into it, the
+  // nodes themselves on RBTree, and leaves the others in other
+  void merge(map &other);
+  // moves the elements with keys from key on to the returned map and
+  // keeps the ones before it, without copying any element; on RBTree in
+  // O(log n) plus O(min(k, n / 4096) log n) for the k elements of the
+  // smaller part
+  template <typename K = Key>
+  map split(const K &key);
+  // the counterpart of split: appends the elements of other, whose keys
+  // must all follow the keys of this map, and leaves other empty
+  void join(map &other);
+
+ public:
+  // takes the element at pos, or the first with key if there is one, out
+  // of the map into a node handle, see s21_node_handle.h
+  node_type extract(iterator pos);
+  template <typename K = Key>
+  node_type extract(const K &key);
+  insert_return_type insert(node_type &&node);
+  iterator insert(iterator hint, node_type &&node);
+
+ public:
+  iterator nth(size_type k);
+  size_type rank(const Key &key);
+  size_type count_range(const Key &lo, const Key &hi);
+
+ public:
+  // a read-only snapshot laid out for faster searches, see s21_frozen.h
+  frozen_map<Key, T, Compare, Allocator> freeze() const;
+
+ public:
+  // the element is constructed from args in place, inside its tree node
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return tree_.EmplaceUnique(std::forward<Args>(args)...);
+  }
+
+  // hint is the position the new element is expected to precede
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args) {
+    return tree_.EmplaceHintUnique(hint, std::forward<Args>(args)...).first;
+  }
+
+  // unlike emplace, leaves args untouched when the key is already present
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args) {
+    return TryEmplace(key, std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+    return TryEmplace(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <typename... Args>
+  s21::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
+    s21::vector<std::pair<iterator, bool>> result;
+    InsertManyRec(result, std::forward<Args>(args)...);
+    return result;
+  }
+
+ private:
+  template <typename K, typename... Args>
+  std::pair<iterator, bool> TryEmplace(K &&key, Args &&...args) {
+    iterator it = tree_.lower_bound(key);
+    if (it != end() && !key_comp()(key, (*it).first)) return {it, false};
+
+    return tree_.EmplaceHintUnique(
+        it, std::piecewise_construct,
+        std::forward_as_tuple(std::forward<K>(key)),
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename T0, typename... Args>
+  void InsertManyRec(s21::vector<std::pair<iterator, bool>> &vec, T0 &&v0,
+                     Args &&...args) {
+    // hinting with the successor of the previous value makes ascending
+    // arguments take the constant time path
+    iterator hint = vec.empty() ? end() : ++iterator(vec.back().first);
+    vec.push_back(tree_.InsertUnique(hint, value_type{std::forward<T0>(v0)}));
+    if constexpr (sizeof...(args) != 0)
+      InsertManyRec(vec, std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename InputIt>
+  void AssignSorted(InputIt first, InputIt last) {
+    tree_.AssignSorted(first, last,
+                       [comp = key_comp()](const auto &a, const auto &b) {
+                         return !comp(a.first, b.first);
+                       });
+  }
+
+ private:
+  Tree<value_type, Allocator, SelectFirst, Compare> tree_;
+};
+
+namespace pmr {
+template <typename Key, typename T>
+using map = s21::map<Key, T, std::less<Key>,
+                     std::pmr::polymorphic_allocator<s21_pair<Key, T>>>;
+}  // namespace pmr
+}  // namespace s21
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::map(const Compare &comp,
+                                                const Allocator &alloc)
+    : tree_(comp, alloc) {}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::map(const Allocator &alloc)
+    : tree_(alloc) {}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::map(
+    std::initializer_list<value_type> const &items, const Compare &comp,
+    const Allocator &alloc)
+    : map(items.begin(), items.end(), comp, alloc) {}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::map(
+    std::initializer_list<value_type> const &items, const Allocator &alloc)
+    : map(items.begin(), items.end(), alloc) {}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::map(const map &m)
+    : tree_(m.tree_) {}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::map(map &&m)
+    : tree_(m.tree_.GetCompare(), m.tree_.GetAllocator()) {
+  tree_ = std::move(m.tree_);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::~map() {
+  tree_.Clear();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>
+&s21::map<Key, T, Compare, Allocator, Tree>::operator=(map &&m) {
+  if (this != &m) tree_ = std::move(m.tree_);
+  return *this;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::map<Key, T, Compare, Allocator, Tree>
+&s21::map<Key, T, Compare, Allocator, Tree>::operator=(const map &m) {
+  if (this != &m) tree_ = m.tree_;
+  return *this;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+T &s21::map<Key, T, Compare, Allocator, Tree>::at(const Key &key) {
+  iterator it = tree_.Find(key);
+  if (it && it != tree_.end())
+    return (*it).second;
+  else
+    throw std::out_of_range("out of map range");
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+T &s21::map<Key, T, Compare, Allocator, Tree>::operator[](const Key &key) {
+  return (*try_emplace(key).first).second;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::begin() {
+  return tree_.begin();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::end() {
+  return tree_.end();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::allocator_type
+s21::map<Key, T, Compare, Allocator, Tree>::get_allocator() const {
+  return tree_.GetAllocator();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::key_compare
+s21::map<Key, T, Compare, Allocator, Tree>::key_comp() const {
+  return tree_.GetCompare();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::find(const K &key) {
+  return tree_.Find(key);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+bool s21::map<Key, T, Compare, Allocator, Tree>::contains(const K &key) {
+  return tree_.Contains(key);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename ForwardIt>
+void s21::map<Key, T, Compare, Allocator, Tree>::find_many(
+    ForwardIt first, ForwardIt last, s21::vector<iterator> &out) {
+  tree_.FindMany(first, last, out);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+bool s21::map<Key, T, Compare, Allocator, Tree>::empty() {
+  return tree_.Empty();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::size_type
+s21::map<Key, T, Compare, Allocator, Tree>::size() {
+  return tree_.Size();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::size_type
+s21::map<Key, T, Compare, Allocator, Tree>::max_size() {
+  return std::numeric_limits<value_type>::max();  // need test
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::map<Key, T, Compare, Allocator, Tree>::clear() {
+  tree_.Clear();
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::map<Key, T, Compare, Allocator, Tree>::iterator, bool>
+s21::map<Key, T, Compare, Allocator, Tree>::insert(const value_type &value) {
+  return tree_.InsertUnique(value);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::map<Key, T, Compare, Allocator, Tree>::iterator, bool>
+s21::map<Key, T, Compare, Allocator, Tree>::insert(value_type &&value) {
+  return tree_.InsertUnique(std::move(value));
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::insert(
+    iterator hint, const value_type &value) {
+  return tree_.InsertUnique(hint, value).first;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::insert(
+    iterator hint, value_type &&value) {
+  return tree_.InsertUnique(hint, std::move(value)).first;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::map<Key, T, Compare, Allocator, Tree>::iterator, bool>
+s21::map<Key, T, Compare, Allocator, Tree>::insert(
+    const std::pair<Key, T> &value) {
+  return tree_.EmplaceUnique(value);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::map<Key, T, Compare, Allocator, Tree>::iterator, bool>
+s21::map<Key, T, Compare, Allocator, Tree>::insert(std::pair<Key, T> &&value) {
+  return tree_.EmplaceUnique(std::move(value));
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::map<Key, T, Compare, Allocator, Tree>::iterator, bool>
+s21::map<Key, T, Compare, Allocator, Tree>::insert(
+    const Key &key, const T &obj) {
+  return try_emplace(key, obj);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::map<Key, T, Compare, Allocator, Tree>::iterator, bool>
+s21::map<Key, T, Compare, Allocator, Tree>::insert_or_assign(
+    const Key &key, const T &obj) {
+  std::pair<iterator, bool> result = try_emplace(key, obj);
+  if (!result.second) {
+    (*result.first).second = obj;
+    result.second = true;
+  }
+
+  return result;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::map<Key, T, Compare, Allocator, Tree>::erase(iterator pos) {
+  if (pos != tree_.end()) tree_.Erase(pos);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::map<Key, T, Compare, Allocator, Tree>::swap(map &other) {
+  tree_.Swap(other.tree_);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::map<Key, T, Compare, Allocator, Tree>::merge(map &other) {
+  tree_.MergeUnique(other.tree_);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::node_type
+s21::map<Key, T, Compare, Allocator, Tree>::extract(iterator pos) {
+  node_type node;
+  NodeAccess::Handle(node) = tree_.Extract(pos);
+
+  return node;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::map<Key, T, Compare, Allocator, Tree>::node_type
+s21::map<Key, T, Compare, Allocator, Tree>::extract(const K &key) {
+  iterator pos = tree_.Find(key);
+
+  return pos == end() ? node_type() : extract(pos);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::insert_return_type
+s21::map<Key, T, Compare, Allocator, Tree>::insert(node_type &&node) {
+  std::pair<iterator, bool> result =
+      tree_.InsertNodeUnique(NodeAccess::Handle(node));
+  if (result.second) return {result.first, true, node_type()};
+
+  return {result.first, false, std::move(node)};
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::insert(iterator hint,
+                                                  node_type &&node) {
+  return tree_.InsertNodeUnique(hint, NodeAccess::Handle(node)).first;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+s21::map<Key, T, Compare, Allocator, Tree>
+s21::map<Key, T, Compare, Allocator, Tree>::split(const K &key) {
+  map right(key_comp(), get_allocator());
+  tree_.Split(key, right.tree_);
+
+  return right;
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::map<Key, T, Compare, Allocator, Tree>::join(map &other) {
+  if (!empty() && !other.empty() &&
+      !key_comp()((*--end()).first, (*other.begin()).first))
+    throw std::invalid_argument("join of overlapping maps");
+  tree_.Join(other.tree_);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::iterator
+s21::map<Key, T, Compare, Allocator, Tree>::nth(size_type k) {
+  return tree_.Nth(k);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::size_type
+s21::map<Key, T, Compare, Allocator, Tree>::rank(const Key &key) {
+  return tree_.Rank(key);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::map<Key, T, Compare, Allocator, Tree>::size_type
+s21::map<Key, T, Compare, Allocator, Tree>::count_range(
+    const Key &lo, const Key &hi) {
+  return tree_.CountRange(lo, hi);
+}
+
+template <typename Key, typename T, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::frozen_map<Key, T, Compare, Allocator>
+s21::map<Key, T, Compare, Allocator, Tree>::freeze() const {
+  return frozen_map<Key, T, Compare, Allocator>::from_sorted(
+      tree_.begin(), tree_.end(), tree_.GetCompare(), tree_.GetAllocator());
+}
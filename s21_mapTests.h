@@ -2,7 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <cctype>
 #include <map>
+#include <memory>
+#include <string>
+#include <string_view>
 
 #include "s21_map.h"
 
@@ -296,7 +300,7 @@ TEST(map, MergeMap) {
     EXPECT_TRUE((*my_it).second == (*orig_it).second);
   }
   EXPECT_EQ(my_map_merge.contains(4), (orig_map_merge.count(4) == 1));
-  EXPECT_EQ(my_map_merge.contains(3), (orig_map_merge.count(3) == 0));
+  EXPECT_EQ(my_map_merge.contains(3), (orig_map_merge.count(3) == 1));
 }
 
 TEST(map, DefaultConstructor) {
@@ -448,7 +452,7 @@ TEST(map, Merge) {
 
   // Проверяем, что карты были успешно объединены
   EXPECT_EQ(static_cast<int>(map1.size()), 20);
-  EXPECT_EQ(static_cast<int>(map2.size()), 10);
+  EXPECT_EQ(static_cast<int>(map2.size()), 0);
 
   // Проверяем, что все элементы из второй карты перенеслись в первую
   for (int i = 1; i <= 20; ++i) {
@@ -570,4 +574,330 @@ TEST(MapTest, InsertManyVariadic) {
   EXPECT_EQ(map.at(4), "four");
 }
 
+TEST(map, OrderStatistics) {
+  s21::map<int, int> map = {{50, 5}, {10, 1}, {40, 4}, {20, 2}, {30, 3}};
+
+  EXPECT_EQ((*map.nth(0)).first, 10);
+  EXPECT_EQ((*map.nth(2)).first, 30);
+  EXPECT_EQ((*map.nth(4)).second, 5);
+  EXPECT_TRUE(map.nth(5) == map.end());
+
+  EXPECT_EQ(static_cast<int>(map.rank(10)), 0);
+  EXPECT_EQ(static_cast<int>(map.rank(35)), 3);
+  EXPECT_EQ(static_cast<int>(map.rank(100)), 5);
+  EXPECT_EQ(static_cast<int>(map.count_range(20, 50)), 3);
+  EXPECT_EQ(static_cast<int>(map.count_range(50, 20)), 0);
+
+  map.erase(map.nth(1));
+  EXPECT_EQ(static_cast<int>(map.size()), 4);
+  EXPECT_EQ((*map.nth(1)).first, 30);
+}
+
+TEST(map, PolymorphicAllocator) {
+  alignas(std::max_align_t) unsigned char buffer[16384];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  s21::pmr::map<int, int> map({{3, 30}, {1, 10}, {2, 20}}, &resource);
+  for (int i = 4; i <= 100; ++i) map.insert(i, i * 10);
+  EXPECT_EQ(map.size(), 100U);
+  EXPECT_EQ(map.at(42), 420);
+  EXPECT_TRUE(map.get_allocator().resource() == &resource);
+
+  s21::pmr::map<int, int> other(&resource);
+  other.insert(1000, 1);
+  map.swap(other);
+  EXPECT_EQ(map.size(), 1U);
+  EXPECT_EQ(other.at(1), 10);
+}
+
+TEST(map, CopyAssignmentReplaces) {
+  s21::map<int, std::string> map = {{1, "one"}, {2, "two"}, {3, "three"}};
+  s21::map<int, std::string> other = {{0, "zero"}, {2, "old"}, {9, "nine"}};
+  for (int i = 10; i < 100; ++i) other.insert(i, "x");
+
+  other = map;
+  EXPECT_EQ(other.size(), 3U);
+  EXPECT_FALSE(other.contains(0));
+  EXPECT_EQ(other.at(2), "two");
+  EXPECT_EQ((*other.nth(2)).first, 3);
+  EXPECT_EQ(other.rank(3), 2U);
+
+  other.insert(4, "four");
+  EXPECT_EQ(other.size(), 4U);
+  EXPECT_EQ(map.size(), 3U);
+  EXPECT_EQ((*(--other.end())).first, 4);
+}
+
+TEST(map, RangeConstructor) {
+  s21::vector<std::pair<int, std::string>> pairs = {
+      {1, "one"}, {2, "two"}, {2, "second two"}, {3, "three"}};
+  s21::map<int, std::string> map(pairs.begin(), pairs.end());
+  std::map<int, std::string> orig_map(pairs.begin(), pairs.end());
+  EXPECT_EQ(map.size(), orig_map.size());
+  for (const auto &pair : orig_map) EXPECT_EQ(map.at(pair.first), pair.second);
+
+  auto sorted =
+      s21::map<int, std::string>::from_sorted(pairs.begin(), pairs.end());
+  EXPECT_EQ(sorted.size(), 3U);
+  EXPECT_EQ(sorted.at(2), "two");
+  EXPECT_EQ((*sorted.nth(2)).first, 3);
+
+  s21::map<int, int> unsorted = {{3, 3}, {1, 1}, {3, 30}, {2, 2}};
+  EXPECT_EQ(unsorted.size(), 3U);
+  EXPECT_EQ(unsorted.at(3), 3);
+}
+
+TEST(map, InsertUnique) {
+  s21::map<int, std::string> map = {{1, "one"}, {1, "uno"}, {2, "two"}};
+  EXPECT_EQ(map.size(), 2U);
+  EXPECT_EQ(map.at(1), "one");
+
+  auto result = map.insert(2, "dos");
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ((*result.first).second, "two");
+
+  map[3] += "three";
+  EXPECT_EQ(map.size(), 3U);
+  EXPECT_EQ(map.at(3), "three");
+  map[3] = "tres";
+  EXPECT_EQ(map.size(), 3U);
+  EXPECT_EQ(map.at(3), "tres");
+}
+
+TEST(map, HintedInsert) {
+  s21::map<int, int> map;
+  for (int i = 0; i < 1000; ++i) map.emplace_hint(map.end(), i, i * 2);
+  EXPECT_EQ(map.size(), 1000U);
+  EXPECT_EQ(map.at(999), 1998);
+  EXPECT_EQ((*map.nth(500)).first, 500);
+
+  auto it = map.insert(map.nth(10), {5, 0});
+  EXPECT_EQ((*it).second, 10);
+  it = map.insert(map.begin(), {-1, -1});
+  EXPECT_TRUE(it == map.begin());
+  it = map.insert(map.begin(), {2000, 1});
+  EXPECT_TRUE(it == --map.end());
+  EXPECT_EQ(map.size(), 1002U);
+
+  auto result = map.insert_many(std::pair<int, int>{1500, 0},
+                                std::pair<int, int>{1501, 0},
+                                std::pair<int, int>{1501, 1},
+                                std::pair<int, int>{1200, 0});
+  EXPECT_TRUE(result[1].second);
+  EXPECT_FALSE(result[2].second);
+  EXPECT_TRUE(result[3].second);
+  EXPECT_EQ(map.size(), 1005U);
+  EXPECT_EQ(map.rank(1500), 1002U);
+}
+
+TEST(map, MoveOnlyValues) {
+  s21::map<int, std::unique_ptr<int>> map;
+  auto result = map.try_emplace(1, std::make_unique<int>(10));
+  EXPECT_TRUE(result.second);
+  auto value = std::make_unique<int>(20);
+  result = map.try_emplace(1, std::move(value));
+  EXPECT_FALSE(result.second);
+  EXPECT_NE(value, nullptr);
+  EXPECT_EQ(*(*result.first).second, 10);
+
+  EXPECT_TRUE(map.emplace(2, std::make_unique<int>(30)).second);
+  EXPECT_EQ(map[3], nullptr);
+  map[3] = std::move(value);
+  using value_type = s21::map<int, std::unique_ptr<int>>::value_type;
+  EXPECT_TRUE(map.insert(value_type(4, std::make_unique<int>(50))).second);
+  map.emplace_hint(map.end(), 5, std::make_unique<int>(60));
+  EXPECT_EQ(map.size(), 5U);
+  EXPECT_EQ(*map.at(2), 30);
+  EXPECT_EQ(*map.at(3), 20);
+  EXPECT_EQ(*map.at(5), 60);
+}
+
+TEST(map, TryEmplaceMovesKey) {
+  s21::map<std::string, std::string> map;
+  std::string key(64, 'k');
+  std::string obj(64, 'v');
+  map.try_emplace(std::move(key), std::move(obj));
+  EXPECT_TRUE(key.empty());
+  EXPECT_TRUE(obj.empty());
+
+  key.assign(64, 'k');
+  obj.assign(64, 'w');
+  EXPECT_FALSE(map.try_emplace(std::move(key), std::move(obj)).second);
+  EXPECT_EQ(key.size(), 64U);
+  EXPECT_EQ(obj.size(), 64U);
+  EXPECT_EQ(map.at(key), std::string(64, 'v'));
+}
+
+struct NoDefault {
+  explicit NoDefault(int v) : value(v) {}
+  int value;
+};
+
+TEST(map, HeterogeneousLookup) {
+  s21::map<std::string, int, std::less<>> map = {
+      {"one", 1}, {"two", 2}, {"three", 3}};
+  std::string_view key = "two";
+  EXPECT_EQ((*map.find(key)).second, 2);
+  EXPECT_TRUE(map.find(std::string_view("four")) == map.end());
+  EXPECT_TRUE(map.contains("three"));
+  EXPECT_FALSE(map.contains(std::string_view("zero")));
+  EXPECT_EQ((*map.find(std::string("one"))).second, 1);
+
+  s21::map<int, NoDefault> no_default;
+  no_default.try_emplace(2, 20);
+  no_default.try_emplace(1, 10);
+  EXPECT_EQ(no_default.at(1).value, 10);
+  EXPECT_TRUE(no_default.contains(2));
+  EXPECT_EQ(no_default.rank(2), 1U);
+  EXPECT_THROW(no_default.at(3), std::out_of_range);
+}
+
+struct CaseInsensitiveLess {
+  bool operator()(const std::string &a, const std::string &b) const {
+    for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+      int ca = std::tolower(static_cast<unsigned char>(a[i]));
+      int cb = std::tolower(static_cast<unsigned char>(b[i]));
+      if (ca != cb) return ca < cb;
+    }
+    return a.size() < b.size();
+  }
+};
+
+TEST(map, CustomCompare) {
+  s21::map<std::string, int, CaseInsensitiveLess> map = {
+      {"Beta", 2}, {"alpha", 1}, {"GAMMA", 3}};
+  EXPECT_EQ((*map.begin()).first, "alpha");
+  EXPECT_EQ(map.at("BETA"), 2);
+  EXPECT_TRUE(map.contains("gamma"));
+  EXPECT_FALSE(map.insert("ALPHA", 10).second);
+  map["Delta"] = 4;
+  map["DELTA"] += 1;
+  EXPECT_EQ(map.size(), 4U);
+  EXPECT_EQ(map.at("delta"), 5);
+  EXPECT_EQ(map.rank("c"), 2U);
+}
+
+struct DirectedLess {
+  bool operator()(int a, int b) const { return reversed ? b < a : a < b; }
+  bool reversed = false;
+};
+
+TEST(map, AssignEmptyTakesCompare) {
+  using Map = s21::map<int, int, DirectedLess>;
+  const Map reversed(DirectedLess{true});
+
+  // the comparator goes over even when both maps hold nothing
+  Map copied;
+  copied = reversed;
+  copied.insert(1, 1);
+  copied.insert(2, 2);
+  EXPECT_EQ((*copied.begin()).first, 2);
+
+  Map source(DirectedLess{true});
+  Map moved;
+  moved = std::move(source);
+  moved.insert(1, 1);
+  moved.insert(2, 2);
+  EXPECT_EQ((*moved.begin()).first, 2);
+}
+
+TEST(map, FindMany) {
+  s21::map<std::string, int> map;
+  for (int i = 0; i < 200; ++i) map[std::to_string(i)] = i;
+
+  s21::vector<std::string> keys = {"7", "x", "150", "7", "", "199"};
+  s21::vector<s21::map<std::string, int>::iterator> found;
+  map.find_many(keys.begin(), keys.end(), found);
+  ASSERT_EQ(found.size(), keys.size());
+  EXPECT_EQ((*found[0]).second, 7);
+  EXPECT_TRUE(found[1] == map.end());
+  EXPECT_EQ((*found[2]).second, 150);
+  EXPECT_TRUE(found[3] == found[0]);
+  EXPECT_TRUE(found[4] == map.end());
+  EXPECT_EQ((*found[5]).second, 199);
+
+  // keys converted to std::string are searched one by one
+  const char *names[] = {"12", "nope"};
+  map.find_many(std::begin(names), std::end(names), found);
+  ASSERT_EQ(found.size(), keys.size() + 2);
+  EXPECT_EQ((*found[6]).second, 12);
+  EXPECT_TRUE(found[7] == map.end());
+}
+
+TEST(map, SplitJoin) {
+  s21::map<int, std::string> shard;
+  for (int i = 0; i < 1000; ++i) shard[i * 2] = std::to_string(i);
+
+  // cut into four ranges, change them apart and join them back in order
+  s21::map<int, std::string> third = shard.split(1000);
+  s21::map<int, std::string> second = shard.split(500);
+  s21::map<int, std::string> fourth = third.split(1500);
+  EXPECT_EQ(shard.size(), 250U);
+  EXPECT_EQ(second.size(), 250U);
+  EXPECT_EQ(third.size(), 250U);
+  EXPECT_EQ(fourth.size(), 250U);
+  EXPECT_EQ((*second.begin()).first, 500);
+  EXPECT_EQ(third.at(1200), "600");
+  EXPECT_THROW(second.at(1200), std::out_of_range);
+
+  second[777] = "new";
+  fourth.erase(fourth.begin());
+  EXPECT_THROW(second.join(shard), std::invalid_argument);
+  shard.join(second);
+  shard.join(third);
+  shard.join(fourth);
+  EXPECT_EQ(shard.size(), 1000U);
+  EXPECT_TRUE(second.empty());
+  int prev = -1;
+  for (auto it = shard.begin(); it != shard.end(); ++it) {
+    EXPECT_LT(prev, (*it).first);
+    prev = (*it).first;
+  }
+  EXPECT_EQ(shard.at(777), "new");
+  EXPECT_EQ((*shard.nth(999)).first, 1998);
+  EXPECT_EQ(shard.rank(1500), 751U);
+
+  // a transparent compare splits at a key of another type
+  s21::map<std::string, int, std::less<>> names = {
+      {"ann", 1}, {"bob", 2}, {"cid", 3}};
+  auto tail = names.split(std::string_view("b"));
+  EXPECT_EQ(names.size(), 1U);
+  EXPECT_EQ(tail.at("cid"), 3);
+}
+
+TEST(map, ExtractInsert) {
+  s21::map<std::string, int> my_map = {{"one", 1}, {"two", 2}, {"six", 6}};
+  auto node = my_map.extract("two");
+  EXPECT_EQ(node.key(), "two");
+  EXPECT_EQ(node.mapped(), 2);
+  EXPECT_FALSE(my_map.contains("two"));
+
+  node.key() = "three";
+  node.mapped() = 3;
+  auto result = my_map.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(my_map.at("three"), 3);
+  EXPECT_EQ((*result.position).first, "three");
+
+  node = my_map.extract(my_map.find("one"));
+  node.key() = "six";
+  result = my_map.insert(std::move(node));
+  EXPECT_FALSE(result.inserted);
+  EXPECT_EQ(result.node.mapped(), 1);
+  EXPECT_EQ(my_map.at("six"), 6);
+  EXPECT_EQ(my_map.size(), 2U);
+
+  // a node moves between maps without its value being copied
+  s21::map<std::string, int> other;
+  auto it = other.insert(other.end(), std::move(result.node));
+  EXPECT_EQ((*it).second, 1);
+  other.merge(my_map);
+  EXPECT_EQ(my_map.size(), 1U);
+  EXPECT_EQ(my_map.at("six"), 6);
+  EXPECT_EQ(other.size(), 2U);
+  EXPECT_EQ(other.at("six"), 1);
+  EXPECT_EQ(other.at("three"), 3);
+}
+
 // MAP END
@@ -1,193 +1,549 @@
-#pragma once
-
-#include <initializer_list>
-#include <limits>
-
-#include "RBTree.h"
-#include "s21_vector.h"
-
-namespace s21 {
-template <typename Key>
-class multiset {
- public:
-  using iterator = typename RBTree<Key>::RBIterator;
-  using const_iterator = const typename RBTree<Key>::RBIterator;
-  using size_type = std::size_t;
-
- public:
-  multiset() = default;
-  multiset(std::initializer_list<Key> const &items);
-  multiset(const multiset &s);
-  multiset(multiset &&s);
-  ~multiset();
-
- public:
-  void operator=(multiset &&s);
-  void operator=(multiset &s);
-
- public:
-  iterator begin();
-  iterator end();
-  const_iterator cbegin();
-  const_iterator cend();
-
- public:
-  bool empty();
-  size_type size();
-  size_type max_size();
-
- public:
-  void clear();
-  std::pair<iterator, bool> insert(const Key &value);
-  void erase(iterator pos);
-  void swap(multiset &other);
-  void merge(multiset &other);
-
- public:
-  iterator find(const Key &key);
-  bool contains(const Key &key);
-  size_t count(const Key &key);
-
- public:
-  std::pair<iterator, iterator> equal_range(const Key &key);
-  iterator lower_bound(const Key &key);
-  iterator upper_bound(const Key &key);
-
- public:
-  template <typename... Args>
-  s21::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
-    return rbTree_.insert_many(args...);
-  }
-
- private:
-  RBTree<Key> rbTree_;
-};
-}  // namespace s21
-
-template <typename Key>
-s21::multiset<Key>::multiset(std::initializer_list<Key> const &items) {
-  for (const Key &val : items) rbTree_.Insert(val);
-}
-
-template <typename Key>
-s21::multiset<Key>::multiset(const multiset &s) {
-  rbTree_ = s.rbTree_;
-}
-
-template <typename Key>
-s21::multiset<Key>::multiset(multiset &&s) {
-  rbTree_ = std::move(s.rbTree_);
-}
-
-template <typename Key>
-s21::multiset<Key>::~multiset() {
-  rbTree_.Clear();
-}
-
-template <typename Key>
-void s21::multiset<Key>::operator=(multiset &&s) {
-  rbTree_ = std::move(s.rbTree_);
-}
-
-template <typename Key>
-void s21::multiset<Key>::operator=(multiset &s) {
-  clear();
-  rbTree_ = s.rbTree_;
-}
-
-template <typename Key>
-typename s21::multiset<Key>::iterator s21::multiset<Key>::begin() {
-  return rbTree_.begin();
-}
-
-template <typename Key>
-typename s21::multiset<Key>::iterator s21::multiset<Key>::end() {
-  return rbTree_.end();
-}
-
-template <typename Key>
-typename s21::multiset<Key>::const_iterator s21::multiset<Key>::cbegin() {
-  return rbTree_.begin();
-}
-
-template <typename Key>
-typename s21::multiset<Key>::const_iterator s21::multiset<Key>::cend() {
-  return rbTree_.end();
-}
-
-template <typename Key>
-bool s21::multiset<Key>::empty() {
-  return rbTree_.Empty();
-}
-
-template <typename Key>
-typename s21::multiset<Key>::size_type s21::multiset<Key>::size() {
-  return rbTree_.Size();
-}
-
-template <typename Key>
-typename s21::multiset<Key>::size_type s21::multiset<Key>::max_size() {
-  return std::numeric_limits<Key>::max();  // need test
-}
-
-template <typename Key>
-void s21::multiset<Key>::clear() {
-  rbTree_.Clear();
-}
-
-template <typename Key>
-void s21::multiset<Key>::erase(iterator pos) {
-  if (pos != rbTree_.end()) rbTree_.Erase(pos);
-}
-
-template <typename Key>
-void s21::multiset<Key>::swap(multiset &other) {
-  rbTree_.Swap(other.rbTree_);
-}
-
-template <typename Key>
-typename s21::multiset<Key>::iterator s21::multiset<Key>::find(const Key &key) {
-  return rbTree_.Find(key);
-}
-
-template <typename Key>
-bool s21::multiset<Key>::contains(const Key &key) {
-  return rbTree_.Contains(key);
-}
-
-template <typename Key>
-size_t s21::multiset<Key>::count(const Key &key) {
-  return rbTree_.Count(key);
-}
-
-template <typename Key>
-std::pair<typename s21::multiset<Key>::iterator,
-          typename s21::multiset<Key>::iterator>
-s21::multiset<Key>::equal_range(const Key &key) {
-  return rbTree_.equal_range(key);
-}
-
-template <typename Key>
-typename s21::multiset<Key>::iterator s21::multiset<Key>::lower_bound(
-    const Key &key) {
-  return rbTree_.lower_bound(key);
-}
-
-template <typename Key>
-typename s21::multiset<Key>::iterator s21::multiset<Key>::upper_bound(
-    const Key &key) {
-  return rbTree_.upper_bound(key);
-}
-
-template <typename Key>
-std::pair<typename s21::multiset<Key>::iterator, bool>
-s21::multiset<Key>::insert(const Key &value) {
-  return rbTree_.Insert(value);
-}
-
-template <typename Key>
-void s21::multiset<Key>::merge(multiset &other) {
-  for (const auto &val : other) rbTree_.Insert(val);
-
-  other.clear();
-}
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+
+#include "RBTree.h"
+#include "SetAlgebra.h"
+#include "s21_frozen.h"
+#include "s21_node_handle.h"
+#include "s21_vector.h"
+
+namespace s21 {
+// the elements are kept in a Tree, RBTree by default, BTree (see
+// s21_btree.h) or FlatTree (see s21_flat.h); all have the same interface
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>,
+          template <typename, typename, typename, typename> class Tree = RBTree>
+class multiset {
+ public:
+  using iterator =
+      typename Tree<Key, Allocator, Identity, Compare>::Iterator;
+  using const_iterator =
+      const typename Tree<Key, Allocator, Identity, Compare>::Iterator;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using node_type = set_node_handle<
+      typename Tree<Key, Allocator, Identity, Compare>::NodeHandle, Key,
+      Allocator>;
+
+ public:
+  multiset() = default;
+  explicit multiset(const Compare &comp, const Allocator &alloc = Allocator());
+  explicit multiset(const Allocator &alloc);
+  multiset(std::initializer_list<Key> const &items,
+           const Compare &comp = Compare(),
+           const Allocator &alloc = Allocator());
+  multiset(std::initializer_list<Key> const &items, const Allocator &alloc);
+  multiset(const multiset &s);
+  multiset(multiset &&s);
+  ~multiset();
+
+ public:
+  template <typename InputIt>
+  multiset(InputIt first, InputIt last, const Compare &comp = Compare(),
+           const Allocator &alloc = Allocator())
+      : tree_(comp, alloc) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      if (std::is_sorted(first, last, comp)) {
+        AssignSorted(first, last);
+        return;
+      }
+    }
+    for (; first != last; ++first) tree_.Insert(end(), *first);
+  }
+
+  template <typename InputIt>
+  multiset(InputIt first, InputIt last, const Allocator &alloc)
+      : multiset(first, last, Compare(), alloc) {}
+
+  // builds the multiset in O(n) from a range sorted in the order of comp,
+  // equal keys are all kept
+  template <typename InputIt>
+  static multiset from_sorted(InputIt first, InputIt last,
+                              const Compare &comp = Compare(),
+                              const Allocator &alloc = Allocator()) {
+    multiset result(comp, alloc);
+    result.AssignSorted(first, last);
+    return result;
+  }
+
+ public:
+  allocator_type get_allocator() const;
+  key_compare key_comp() const;
+
+ public:
+  void operator=(multiset &&s);
+  void operator=(multiset &s);
+
+ public:
+  iterator begin();
+  iterator end();
+  const_iterator cbegin();
+  const_iterator cend();
+
+ public:
+  bool empty();
+  size_type size();
+  size_type max_size();
+
+ public:
+  void clear();
+  std::pair<iterator, bool> insert(const Key &value);
+  std::pair<iterator, bool> insert(Key &&value);
+  iterator insert(iterator hint, const Key &value);
+  iterator insert(iterator hint, Key &&value);
+  void erase(iterator pos);
+  void swap(multiset &other);
+  // moves every key of other into this multiset, the nodes themselves on
+  // RBTree, after the keys equal to it
+  void merge(multiset &other);
+  // moves the keys from key on to the returned multiset and keeps the
+  // ones before it, without copying any element; on RBTree in O(log n)
+  // plus O(min(k, n / 4096) log n) for the k elements of the smaller part
+  template <typename K = Key>
+  multiset split(const K &key);
+  // the counterpart of split: appends the keys of other, none of which may
+  // order before the keys of this multiset, and leaves other empty
+  void join(multiset &other);
+
+ public:
+  // takes the element at pos, or the first with key if there is one, out
+  // of the multiset into a node handle, see s21_node_handle.h
+  node_type extract(iterator pos);
+  template <typename K = Key>
+  node_type extract(const K &key);
+  iterator insert(node_type &&node);
+  iterator insert(iterator hint, node_type &&node);
+
+ public:
+  // new multisets with a key as many times as the most, the fewest, and
+  // the surplus of its copies here over the ones in other, as
+  // std::set_union, std::set_intersection and std::set_difference count
+  // them; the algorithms are the ones of set, see SetAlgebra.h. With
+  // threads above 1 the allocator must be usable from several threads
+  multiset union_with(const multiset &other, size_type threads = 1) const;
+  multiset intersection_with(const multiset &other,
+                             size_type threads = 1) const;
+  multiset difference_with(const multiset &other, size_type threads = 1) const;
+
+ public:
+  // with a transparent Compare such as std::less<> key may be of any type
+  // comparable with Key, e.g. std::string_view for std::string keys, and is
+  // looked up as it is; otherwise it is converted to Key once
+  template <typename K = Key>
+  iterator find(const K &key);
+  template <typename K = Key>
+  bool contains(const K &key);
+  // appends to out the result of find for every key of [first, last),
+  // running the searches side by side so that their cache misses overlap
+  template <typename ForwardIt>
+  void find_many(ForwardIt first, ForwardIt last,
+                 s21::vector<iterator> &out);
+  template <typename K = Key>
+  size_t count(const K &key);
+
+ public:
+  iterator nth(size_type k);
+  size_type rank(const Key &key);
+  size_type count_range(const Key &lo, const Key &hi);
+
+ public:
+  // a read-only snapshot laid out for faster searches, see s21_frozen.h
+  frozen_set<Key, Compare, Allocator> freeze() const;
+
+ public:
+  template <typename K = Key>
+  std::pair<iterator, iterator> equal_range(const K &key);
+  template <typename K = Key>
+  iterator lower_bound(const K &key);
+  template <typename K = Key>
+  iterator upper_bound(const K &key);
+
+ public:
+  // the element is constructed from args in place, inside its tree node
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return tree_.Emplace(std::forward<Args>(args)...);
+  }
+
+  // hint is the position the new element is expected to precede
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args) {
+    return tree_.EmplaceHint(hint, std::forward<Args>(args)...).first;
+  }
+
+  template <typename... Args>
+  s21::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
+    return tree_.insert_many(std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename InputIt>
+  void AssignSorted(InputIt first, InputIt last) {
+    tree_.AssignSorted(first, last,
+                       [](const Key &, const Key &) { return false; });
+  }
+
+ private:
+  Tree<Key, Allocator, Identity, Compare> tree_;
+};
+
+namespace pmr {
+template <typename Key>
+using multiset =
+    s21::multiset<Key, std::less<Key>, std::pmr::polymorphic_allocator<Key>>;
+}  // namespace pmr
+}  // namespace s21
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::multiset(const Compare &comp,
+                                                       const Allocator &alloc)
+    : tree_(comp, alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::multiset(const Allocator &alloc)
+    : tree_(alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::multiset(
+    std::initializer_list<Key> const &items, const Compare &comp,
+    const Allocator &alloc)
+    : multiset(items.begin(), items.end(), comp, alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::multiset(
+    std::initializer_list<Key> const &items, const Allocator &alloc)
+    : multiset(items.begin(), items.end(), alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::multiset(const multiset &s)
+    : tree_(s.tree_) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::multiset(multiset &&s)
+    : tree_(s.tree_.GetCompare(), s.tree_.GetAllocator()) {
+  tree_ = std::move(s.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::~multiset() {
+  tree_.Clear();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::operator=(multiset &&s) {
+  tree_ = std::move(s.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::operator=(multiset &s) {
+  tree_ = s.tree_;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::begin() {
+  return tree_.begin();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::end() {
+  return tree_.end();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::const_iterator
+s21::multiset<Key, Compare, Allocator, Tree>::cbegin() {
+  return tree_.begin();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::const_iterator
+s21::multiset<Key, Compare, Allocator, Tree>::cend() {
+  return tree_.end();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::allocator_type
+s21::multiset<Key, Compare, Allocator, Tree>::get_allocator() const {
+  return tree_.GetAllocator();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::key_compare
+s21::multiset<Key, Compare, Allocator, Tree>::key_comp() const {
+  return tree_.GetCompare();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+bool s21::multiset<Key, Compare, Allocator, Tree>::empty() {
+  return tree_.Empty();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::size_type
+s21::multiset<Key, Compare, Allocator, Tree>::size() {
+  return tree_.Size();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::size_type
+s21::multiset<Key, Compare, Allocator, Tree>::max_size() {
+  return std::numeric_limits<Key>::max();  // need test
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::clear() {
+  tree_.Clear();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::erase(iterator pos) {
+  if (pos != tree_.end()) tree_.Erase(pos);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::swap(multiset &other) {
+  tree_.Swap(other.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::find(const K &key) {
+  return tree_.Find(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+bool s21::multiset<Key, Compare, Allocator, Tree>::contains(const K &key) {
+  return tree_.Contains(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename ForwardIt>
+void s21::multiset<Key, Compare, Allocator, Tree>::find_many(
+    ForwardIt first, ForwardIt last, s21::vector<iterator> &out) {
+  tree_.FindMany(first, last, out);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+size_t s21::multiset<Key, Compare, Allocator, Tree>::count(const K &key) {
+  return tree_.Count(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+std::pair<typename s21::multiset<Key, Compare, Allocator, Tree>::iterator,
+          typename s21::multiset<Key, Compare, Allocator, Tree>::iterator>
+s21::multiset<Key, Compare, Allocator, Tree>::equal_range(const K &key) {
+  return tree_.equal_range(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::lower_bound(const K &key) {
+  return tree_.lower_bound(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::upper_bound(const K &key) {
+  return tree_.upper_bound(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::multiset<Key, Compare, Allocator, Tree>::iterator, bool>
+s21::multiset<Key, Compare, Allocator, Tree>::insert(const Key &value) {
+  return tree_.Insert(value);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::multiset<Key, Compare, Allocator, Tree>::iterator, bool>
+s21::multiset<Key, Compare, Allocator, Tree>::insert(Key &&value) {
+  return tree_.Insert(std::move(value));
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::insert(
+    iterator hint, const Key &value) {
+  return tree_.Insert(hint, value).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::insert(
+    iterator hint, Key &&value) {
+  return tree_.Insert(hint, std::move(value)).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::merge(multiset &other) {
+  tree_.Merge(other.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::node_type
+s21::multiset<Key, Compare, Allocator, Tree>::extract(iterator pos) {
+  node_type node;
+  NodeAccess::Handle(node) = tree_.Extract(pos);
+
+  return node;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::multiset<Key, Compare, Allocator, Tree>::node_type
+s21::multiset<Key, Compare, Allocator, Tree>::extract(const K &key) {
+  iterator pos = tree_.lower_bound(key);
+
+  return pos == end() || key_comp()(key, *pos) ? node_type() : extract(pos);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::insert(node_type &&node) {
+  return tree_.InsertNode(NodeAccess::Handle(node)).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::insert(iterator hint,
+                                                    node_type &&node) {
+  return tree_.InsertNode(hint, NodeAccess::Handle(node)).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+s21::multiset<Key, Compare, Allocator, Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::split(const K &key) {
+  multiset right(key_comp(), get_allocator());
+  tree_.Split(key, right.tree_);
+
+  return right;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::multiset<Key, Compare, Allocator, Tree>::join(multiset &other) {
+  if (!empty() && !other.empty() && key_comp()(*other.begin(), *--end()))
+    throw std::invalid_argument("join of overlapping multisets");
+  tree_.Join(other.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::union_with(
+    const multiset &other, size_type threads) const {
+  multiset result(tree_.GetCompare(), tree_.GetAllocator());
+  SetAlgebra<Tree<Key, Allocator, Identity, Compare>>::Union(
+      tree_, other.tree_, threads, result.tree_);
+
+  return result;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::intersection_with(
+    const multiset &other, size_type threads) const {
+  multiset result(tree_.GetCompare(), tree_.GetAllocator());
+  SetAlgebra<Tree<Key, Allocator, Identity, Compare>>::Intersection(
+      tree_, other.tree_, threads, result.tree_);
+
+  return result;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::multiset<Key, Compare, Allocator, Tree>
+s21::multiset<Key, Compare, Allocator, Tree>::difference_with(
+    const multiset &other, size_type threads) const {
+  multiset result(tree_.GetCompare(), tree_.GetAllocator());
+  SetAlgebra<Tree<Key, Allocator, Identity, Compare>>::Difference(
+      tree_, other.tree_, threads, result.tree_);
+
+  return result;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::iterator
+s21::multiset<Key, Compare, Allocator, Tree>::nth(size_type k) {
+  return tree_.Nth(k);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::size_type
+s21::multiset<Key, Compare, Allocator, Tree>::rank(const Key &key) {
+  return tree_.Rank(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::multiset<Key, Compare, Allocator, Tree>::size_type
+s21::multiset<Key, Compare, Allocator, Tree>::count_range(
+    const Key &lo, const Key &hi) {
+  return tree_.CountRange(lo, hi);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::frozen_set<Key, Compare, Allocator>
+s21::multiset<Key, Compare, Allocator, Tree>::freeze() const {
+  return frozen_set<Key, Compare, Allocator>::from_sorted(
+      tree_.begin(), tree_.end(), tree_.GetCompare(), tree_.GetAllocator());
+}
@@ -1,245 +1,651 @@
-#pragma once
-
-#include <gtest/gtest.h>
-
-#include "s21_array.h"
-#include "s21_multiset.h"
-
-// MULTISET
-TEST(multiset, DefaultConstructor) {
-  s21::multiset<int> t;
-  EXPECT_TRUE(t.empty());
-  EXPECT_EQ(static_cast<int>(t.size()), 0);
-}
-
-TEST(multiset, InitializerListConstructor) {
-  s21::multiset<int> t = {1,  5,  2,  55, -9, -5, 18, 56,  10,  3,  13, 23,
-                          27, 20, 22, 57, 60, 59, 75, -10, -11, 55, -11};
-  EXPECT_FALSE(t.empty());
-  EXPECT_EQ(static_cast<int>(t.size()), 23);
-
-  EXPECT_EQ(*t.cbegin(), -11);
-  EXPECT_EQ(*(--t.cend()), 75);
-}
-
-TEST(multiset, CopyConstructor) {
-  s21::multiset<int> t1 = {1,  5,  2,  55, -9, -5, 18, 56,  10,  3,  13, 23,
-                           27, 20, 22, 57, 60, 59, 75, -10, -11, 55, -11};
-  s21::multiset<int> t2 = t1;
-  EXPECT_EQ(static_cast<int>(t1.size()), 23);
-  EXPECT_EQ(static_cast<int>(t2.size()), 23);
-
-  EXPECT_EQ(*t1.cbegin(), -11);
-  EXPECT_EQ(*t2.cbegin(), -11);
-
-  EXPECT_EQ(*(--t1.cend()), 75);
-  EXPECT_EQ(*(--t2.cend()), 75);
-}
-
-TEST(multiset, MoveConstructor) {
-  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
-  s21::multiset<int> t2 = std::move(t1);
-
-  EXPECT_TRUE(t1.empty());
-  EXPECT_EQ(static_cast<int>(t1.size()), 0);
-  EXPECT_FALSE(t2.empty());
-  EXPECT_EQ(static_cast<int>(t2.size()), 6);
-
-  EXPECT_EQ(*t2.cbegin(), 1);
-  EXPECT_EQ(*(--t2.cend()), 5);
-}
-
-TEST(multiset, AssignmentOperatorCopy) {
-  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
-  s21::multiset<int> t2 = {6, 7, 8, 6};
-
-  EXPECT_EQ(static_cast<int>(t1.size()), 6);
-  EXPECT_EQ(static_cast<int>(t2.size()), 4);
-
-  t2 = t1;
-  EXPECT_EQ(static_cast<int>(t1.size()), 6);
-  EXPECT_EQ(static_cast<int>(t2.size()), 6);
-}
-
-TEST(multiset, AssignmentOperatorMove) {
-  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
-  s21::multiset<int> t2 = {6, 7, 8, 6};
-
-  EXPECT_EQ(static_cast<int>(t1.size()), 6);
-  EXPECT_EQ(static_cast<int>(t2.size()), 4);
-
-  t2 = std::move(t1);
-
-  EXPECT_TRUE(t1.empty());
-  EXPECT_EQ(static_cast<int>(t1.size()), 0);
-  EXPECT_EQ(static_cast<int>(t2.size()), 6);
-}
-
-TEST(multiset, Insert) {
-  s21::multiset<int> t = {1, 2, 3, 4, 5, 5};
-
-  EXPECT_EQ(static_cast<int>(t.size()), 6);
-  t.insert(1);
-
-  EXPECT_EQ(static_cast<int>(t.size()), 7);
-
-  EXPECT_EQ(*(--t.cend()), 5);
-  t.insert(11);
-  t.insert(12);
-  t.insert(11);
-  t.insert(12);
-  EXPECT_EQ(static_cast<int>(t.size()), 11);
-}
-
-TEST(multiset, InsertMany) {
-  s21::multiset<int> t = {1, 2, 3, 4, 5, 5};
-  t.insert_many(100, 99, 99);
-  EXPECT_EQ(*(--t.cend()), 100);
-
-  EXPECT_EQ(static_cast<int>(t.size()), 9);
-  t.insert_many(-6, -6, 8);
-  EXPECT_EQ(static_cast<int>(t.size()), 12);
-  EXPECT_EQ(*(t.cbegin()), -6);
-}
-
-TEST(multiset, Swap) {
-  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
-  s21::multiset<int> t2 = {6, 7, 8, 6};
-  EXPECT_EQ(static_cast<int>(t1.size()), 6);
-  EXPECT_EQ(static_cast<int>(t2.size()), 4);
-
-  t1.swap(t2);
-  EXPECT_EQ(static_cast<int>(t1.size()), 4);
-  EXPECT_EQ(static_cast<int>(t2.size()), 6);
-}
-
-TEST(multiset, MemoryManagment) {
-  s21::multiset<int> t = {1, 2, 3, 4, 5, 5};
-  EXPECT_EQ(static_cast<int>(t.size()), 6);
-
-  t.clear();
-  EXPECT_EQ(static_cast<int>(t.size()), 0);
-
-  std::set<int> s;
-  // на разных системах могут не сходить значения
-  // EXPECT_EQ(s.max_size(), t.max_size());
-}
-
-TEST(multiset, UsingIterator) {
-  s21::multiset<int> t = {1,   5,  2,   55, -9, -5, 18,   56,  10, 3,
-                          13,  23, 27,  20, 22, 57, 60,   59,  75, -10,
-                          -11, 55, -11, 1,  1,  1,  -100, -99, -88};
-
-  s21::array<int, 40> res = {-100, -99, -88, -11, -11, -10, -9, -5, 1,  1,
-                             1,    1,   2,   3,   5,   10,  13, 18, 20, 22,
-                             23,   27,  55,  55,  56,  57,  59, 60, 75};
-
-  int i = 0;
-  for (auto it = t.begin(); it != t.end(); ++it, ++i) {
-    EXPECT_EQ(*it, res[i]);
-  }
-
-  s21::multiset<int> x;
-  //     EXPECT_THROW(*x.cbegin(), std::domain_error);
-  //     EXPECT_THROW(*x.cend(), std::domain_error);
-  //     EXPECT_THROW(*x.begin(), std::domain_error);
-  //     EXPECT_THROW(*x.end(), std::domain_error);
-  //     EXPECT_THROW(*(--x.end()), std::domain_error);
-
-  s21::multiset<int> z = {1,   5,  2,   55, -9, -5, 18,   56,  10, 3,
-                          13,  23, 27,  20, 22, 57, 60,   59,  75, -10,
-                          -11, 55, -11, 1,  1,  1,  -100, -99, -88};
-  s21::array<int, 30> res_reverse = {75, 60, 59, 57,  56,  55,  55,  27, 23, 22,
-                                     20, 18, 13, 10,  5,   3,   2,   1,  1,  1,
-                                     1,  -5, -9, -10, -11, -11, -88, -99};
-
-  int j = 0;
-  for (auto it = --z.cend(); it != z.cbegin(); --it, ++j) {
-    EXPECT_EQ(*it, res_reverse[j]);
-  }
-}
-
-TEST(multiset, Erase) {
-  s21::multiset<int> t = {1,  5,   2,   55, -9,  -5, 18, 56, 10,
-                          3,  13,  23,  27, 20,  22, 57, 60, 59,
-                          75, -10, -11, 55, -11, 1,  1,  1,  12};
-
-  t.erase(t.begin());
-  t.erase(t.find(1));
-  t.erase(t.find(10));
-  t.erase(t.find(13));
-  t.erase(t.find(56));
-
-  s21::array<int, 22> res = {-11, -10, -9, -5, 1,  1,  1,  2,  3,  5,  12,
-                             18,  20,  22, 23, 27, 55, 55, 57, 59, 60, 75};
-
-  EXPECT_EQ(static_cast<int>(t.size()), 22);
-
-  int i = 0;
-  for (auto it = t.begin(); it != t.end(); ++it, ++i) {
-    EXPECT_EQ(*it, res[i]);
-  }
-}
-
-TEST(multiset, Merge) {
-  s21::multiset<int> t1 = {1,  5,   2,   55, -9,  -5, 18, 56, 10,
-                           3,  13,  23,  27, 20,  22, 57, 60, 59,
-                           75, -10, -11, 55, -11, 1,  1,  1};
-  s21::multiset<int> t2 = {-100, -99, -88, -88};
-
-  s21::array<int, 40> res = {-100, -99, -88, -88, -11, -11, -10, -9, -5, 1,
-                             1,    1,   1,   2,   3,   5,   10,  13, 18, 20,
-                             22,   23,  27,  55,  55,  56,  57,  59, 60, 75};
-
-  t1.merge(t2);
-
-  int i = 0;
-  for (auto it = t1.begin(); it != t1.end(); ++it, ++i) {
-    EXPECT_EQ(*it, res[i]);
-  }
-
-  EXPECT_TRUE(t2.empty());
-}
-
-TEST(multiset, Contains) {
-  s21::multiset<int> t = {1,  5,  2,  55, -9, -5, 18,  56,  10, 3,   13, 23, 27,
-                          20, 22, 57, 60, 59, 75, -10, -11, 55, -11, 1,  1,  1};
-
-  EXPECT_EQ(static_cast<int>(t.count(1)), 4);
-  EXPECT_EQ(static_cast<int>(t.count(-1000)), 0);
-
-  //     EXPECT_THROW(*t.find(-1000), std::domain_error);
-  EXPECT_TRUE(t.contains(55));
-}
-
-TEST(multiset, Range) {
-  s21::multiset<int> t = {1,  5,  2,  55, -9, -5, 18,  56,  10, 3,   13, 23, 27,
-                          20, 22, 57, 60, 59, 75, -10, -11, 55, -11, 1,  1,  1};
-
-  auto test = t.lower_bound(19);
-
-  EXPECT_EQ(*test, 20);
-  EXPECT_EQ(*(t.lower_bound(18)), 18);
-  EXPECT_EQ(*(t.upper_bound(1)), 2);
-
-  auto pair1 = t.equal_range(1);
-  auto pair2 = t.equal_range(-500);
-  auto pair3 = t.equal_range(56);
-  int i1 = 0;
-  int i2 = 0;
-  int i3 = 0;
-  for (auto it = pair1.first; it != pair1.second; ++it) {
-    ++i1;
-  }
-
-  for (auto it = pair2.first; it != pair2.second; ++it) {
-    ++i2;
-  }
-  for (auto it = pair3.first; it != pair3.second; ++it) {
-    ++i3;
-  }
-
-  EXPECT_EQ(i1, 4);
-  EXPECT_EQ(i2, 0);
-  EXPECT_EQ(i3, 1);
-}
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "s21_array.h"
+#include "s21_multiset.h"
+
+// MULTISET
+TEST(multiset, DefaultConstructor) {
+  s21::multiset<int> t;
+  EXPECT_TRUE(t.empty());
+  EXPECT_EQ(static_cast<int>(t.size()), 0);
+}
+
+TEST(multiset, InitializerListConstructor) {
+  s21::multiset<int> t = {1,  5,  2,  55, -9, -5, 18, 56,  10,  3,  13, 23,
+                          27, 20, 22, 57, 60, 59, 75, -10, -11, 55, -11};
+  EXPECT_FALSE(t.empty());
+  EXPECT_EQ(static_cast<int>(t.size()), 23);
+
+  EXPECT_EQ(*t.cbegin(), -11);
+  EXPECT_EQ(*(--t.cend()), 75);
+}
+
+TEST(multiset, CopyConstructor) {
+  s21::multiset<int> t1 = {1,  5,  2,  55, -9, -5, 18, 56,  10,  3,  13, 23,
+                           27, 20, 22, 57, 60, 59, 75, -10, -11, 55, -11};
+  s21::multiset<int> t2 = t1;
+  EXPECT_EQ(static_cast<int>(t1.size()), 23);
+  EXPECT_EQ(static_cast<int>(t2.size()), 23);
+
+  EXPECT_EQ(*t1.cbegin(), -11);
+  EXPECT_EQ(*t2.cbegin(), -11);
+
+  EXPECT_EQ(*(--t1.cend()), 75);
+  EXPECT_EQ(*(--t2.cend()), 75);
+}
+
+TEST(multiset, MoveConstructor) {
+  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
+  s21::multiset<int> t2 = std::move(t1);
+
+  EXPECT_TRUE(t1.empty());
+  EXPECT_EQ(static_cast<int>(t1.size()), 0);
+  EXPECT_FALSE(t2.empty());
+  EXPECT_EQ(static_cast<int>(t2.size()), 6);
+
+  EXPECT_EQ(*t2.cbegin(), 1);
+  EXPECT_EQ(*(--t2.cend()), 5);
+}
+
+TEST(multiset, AssignmentOperatorCopy) {
+  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
+  s21::multiset<int> t2 = {6, 7, 8, 6};
+
+  EXPECT_EQ(static_cast<int>(t1.size()), 6);
+  EXPECT_EQ(static_cast<int>(t2.size()), 4);
+
+  t2 = t1;
+  EXPECT_EQ(static_cast<int>(t1.size()), 6);
+  EXPECT_EQ(static_cast<int>(t2.size()), 6);
+}
+
+TEST(multiset, AssignmentOperatorMove) {
+  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
+  s21::multiset<int> t2 = {6, 7, 8, 6};
+
+  EXPECT_EQ(static_cast<int>(t1.size()), 6);
+  EXPECT_EQ(static_cast<int>(t2.size()), 4);
+
+  t2 = std::move(t1);
+
+  EXPECT_TRUE(t1.empty());
+  EXPECT_EQ(static_cast<int>(t1.size()), 0);
+  EXPECT_EQ(static_cast<int>(t2.size()), 6);
+}
+
+TEST(multiset, Insert) {
+  s21::multiset<int> t = {1, 2, 3, 4, 5, 5};
+
+  EXPECT_EQ(static_cast<int>(t.size()), 6);
+  t.insert(1);
+
+  EXPECT_EQ(static_cast<int>(t.size()), 7);
+
+  EXPECT_EQ(*(--t.cend()), 5);
+  t.insert(11);
+  t.insert(12);
+  t.insert(11);
+  t.insert(12);
+  EXPECT_EQ(static_cast<int>(t.size()), 11);
+}
+
+TEST(multiset, InsertMany) {
+  s21::multiset<int> t = {1, 2, 3, 4, 5, 5};
+  t.insert_many(100, 99, 99);
+  EXPECT_EQ(*(--t.cend()), 100);
+
+  EXPECT_EQ(static_cast<int>(t.size()), 9);
+  t.insert_many(-6, -6, 8);
+  EXPECT_EQ(static_cast<int>(t.size()), 12);
+  EXPECT_EQ(*(t.cbegin()), -6);
+}
+
+TEST(multiset, Swap) {
+  s21::multiset<int> t1 = {1, 2, 3, 4, 5, 5};
+  s21::multiset<int> t2 = {6, 7, 8, 6};
+  EXPECT_EQ(static_cast<int>(t1.size()), 6);
+  EXPECT_EQ(static_cast<int>(t2.size()), 4);
+
+  t1.swap(t2);
+  EXPECT_EQ(static_cast<int>(t1.size()), 4);
+  EXPECT_EQ(static_cast<int>(t2.size()), 6);
+}
+
+TEST(multiset, MemoryManagment) {
+  s21::multiset<int> t = {1, 2, 3, 4, 5, 5};
+  EXPECT_EQ(static_cast<int>(t.size()), 6);
+
+  t.clear();
+  EXPECT_EQ(static_cast<int>(t.size()), 0);
+
+  std::set<int> s;
+  // на разных системах могут не сходить значения
+  // EXPECT_EQ(s.max_size(), t.max_size());
+}
+
+TEST(multiset, UsingIterator) {
+  s21::multiset<int> t = {1,   5,  2,   55, -9, -5, 18,   56,  10, 3,
+                          13,  23, 27,  20, 22, 57, 60,   59,  75, -10,
+                          -11, 55, -11, 1,  1,  1,  -100, -99, -88};
+
+  s21::array<int, 40> res = {-100, -99, -88, -11, -11, -10, -9, -5, 1,  1,
+                             1,    1,   2,   3,   5,   10,  13, 18, 20, 22,
+                             23,   27,  55,  55,  56,  57,  59, 60, 75};
+
+  int i = 0;
+  for (auto it = t.begin(); it != t.end(); ++it, ++i) {
+    EXPECT_EQ(*it, res[i]);
+  }
+
+  s21::multiset<int> x;
+  //     EXPECT_THROW(*x.cbegin(), std::domain_error);
+  //     EXPECT_THROW(*x.cend(), std::domain_error);
+  //     EXPECT_THROW(*x.begin(), std::domain_error);
+  //     EXPECT_THROW(*x.end(), std::domain_error);
+  //     EXPECT_THROW(*(--x.end()), std::domain_error);
+
+  s21::multiset<int> z = {1,   5,  2,   55, -9, -5, 18,   56,  10, 3,
+                          13,  23, 27,  20, 22, 57, 60,   59,  75, -10,
+                          -11, 55, -11, 1,  1,  1,  -100, -99, -88};
+  s21::array<int, 30> res_reverse = {75, 60, 59, 57,  56,  55,  55,  27, 23, 22,
+                                     20, 18, 13, 10,  5,   3,   2,   1,  1,  1,
+                                     1,  -5, -9, -10, -11, -11, -88, -99};
+
+  int j = 0;
+  for (auto it = --z.cend(); it != z.cbegin(); --it, ++j) {
+    EXPECT_EQ(*it, res_reverse[j]);
+  }
+}
+
+TEST(multiset, Erase) {
+  s21::multiset<int> t = {1,  5,   2,   55, -9,  -5, 18, 56, 10,
+                          3,  13,  23,  27, 20,  22, 57, 60, 59,
+                          75, -10, -11, 55, -11, 1,  1,  1,  12};
+
+  t.erase(t.begin());
+  t.erase(t.find(1));
+  t.erase(t.find(10));
+  t.erase(t.find(13));
+  t.erase(t.find(56));
+
+  s21::array<int, 22> res = {-11, -10, -9, -5, 1,  1,  1,  2,  3,  5,  12,
+                             18,  20,  22, 23, 27, 55, 55, 57, 59, 60, 75};
+
+  EXPECT_EQ(static_cast<int>(t.size()), 22);
+
+  int i = 0;
+  for (auto it = t.begin(); it != t.end(); ++it, ++i) {
+    EXPECT_EQ(*it, res[i]);
+  }
+}
+
+TEST(multiset, Merge) {
+  s21::multiset<int> t1 = {1,  5,   2,   55, -9,  -5, 18, 56, 10,
+                           3,  13,  23,  27, 20,  22, 57, 60, 59,
+                           75, -10, -11, 55, -11, 1,  1,  1};
+  s21::multiset<int> t2 = {-100, -99, -88, -88};
+
+  s21::array<int, 40> res = {-100, -99, -88, -88, -11, -11, -10, -9, -5, 1,
+                             1,    1,   1,   2,   3,   5,   10,  13, 18, 20,
+                             22,   23,  27,  55,  55,  56,  57,  59, 60, 75};
+
+  t1.merge(t2);
+
+  int i = 0;
+  for (auto it = t1.begin(); it != t1.end(); ++it, ++i) {
+    EXPECT_EQ(*it, res[i]);
+  }
+
+  EXPECT_TRUE(t2.empty());
+}
+
+TEST(multiset, Contains) {
+  s21::multiset<int> t = {1,  5,  2,  55, -9, -5, 18,  56,  10, 3,   13, 23, 27,
+                          20, 22, 57, 60, 59, 75, -10, -11, 55, -11, 1,  1,  1};
+
+  EXPECT_EQ(static_cast<int>(t.count(1)), 4);
+  EXPECT_EQ(static_cast<int>(t.count(-1000)), 0);
+
+  //     EXPECT_THROW(*t.find(-1000), std::domain_error);
+  EXPECT_TRUE(t.contains(55));
+}
+
+TEST(multiset, Range) {
+  s21::multiset<int> t = {1,  5,  2,  55, -9, -5, 18,  56,  10, 3,   13, 23, 27,
+                          20, 22, 57, 60, 59, 75, -10, -11, 55, -11, 1,  1,  1};
+
+  auto test = t.lower_bound(19);
+
+  EXPECT_EQ(*test, 20);
+  EXPECT_EQ(*(t.lower_bound(18)), 18);
+  EXPECT_EQ(*(t.upper_bound(1)), 2);
+
+  auto pair1 = t.equal_range(1);
+  auto pair2 = t.equal_range(-500);
+  auto pair3 = t.equal_range(56);
+  int i1 = 0;
+  int i2 = 0;
+  int i3 = 0;
+  for (auto it = pair1.first; it != pair1.second; ++it) {
+    ++i1;
+  }
+
+  for (auto it = pair2.first; it != pair2.second; ++it) {
+    ++i2;
+  }
+  for (auto it = pair3.first; it != pair3.second; ++it) {
+    ++i3;
+  }
+
+  EXPECT_EQ(i1, 4);
+  EXPECT_EQ(i2, 0);
+  EXPECT_EQ(i3, 1);
+}
+
+TEST(multiset, OrderStatistics) {
+  s21::multiset<int> t = {5, 1, 3, 3, 3, 9, 7, 3};
+
+  EXPECT_EQ(*t.nth(0), 1);
+  EXPECT_EQ(*t.nth(4), 3);
+  EXPECT_EQ(*t.nth(5), 5);
+  EXPECT_EQ(*t.nth(7), 9);
+  EXPECT_TRUE(t.nth(8) == t.end());
+
+  EXPECT_EQ(static_cast<int>(t.rank(3)), 1);
+  EXPECT_EQ(static_cast<int>(t.rank(4)), 5);
+  EXPECT_EQ(static_cast<int>(t.count_range(3, 4)), 4);
+  EXPECT_EQ(static_cast<int>(t.count_range(0, 100)), 8);
+}
+
+TEST(multiset, RangeManyDuplicates) {
+  s21::multiset<int> t;
+  for (int i = 0; i < 300; ++i) t.insert(i % 3);
+
+  EXPECT_EQ(static_cast<int>(t.count(0)), 100);
+  EXPECT_EQ(static_cast<int>(t.count(1)), 100);
+  EXPECT_EQ(static_cast<int>(t.count(2)), 100);
+  EXPECT_EQ(static_cast<int>(t.count(3)), 0);
+
+  EXPECT_TRUE(t.lower_bound(0) == t.begin());
+  EXPECT_TRUE(t.upper_bound(2) == t.end());
+  EXPECT_TRUE(t.lower_bound(3) == t.end());
+  EXPECT_EQ(*t.upper_bound(-1), 0);
+  EXPECT_EQ(*t.lower_bound(1), 1);
+  EXPECT_EQ(*(--t.lower_bound(1)), 0);
+
+  auto range = t.equal_range(1);
+  int i = 0;
+  for (auto it = range.first; it != range.second; ++it, ++i)
+    EXPECT_EQ(*it, 1);
+  EXPECT_EQ(i, 100);
+  EXPECT_EQ(*range.second, 2);
+}
+
+struct CountedValue {
+  static int alive;
+
+  CountedValue(int v) : value(v) { ++alive; }
+  CountedValue(const CountedValue &other) : value(other.value) { ++alive; }
+  ~CountedValue() { --alive; }
+
+  bool operator<(const CountedValue &other) const {
+    return value < other.value;
+  }
+  bool operator>(const CountedValue &other) const {
+    return value > other.value;
+  }
+  bool operator==(const CountedValue &other) const {
+    return value == other.value;
+  }
+
+  int value;
+};
+
+int CountedValue::alive = 0;
+
+TEST(multiset, NodeReuseAndRelease) {
+  {
+    s21::multiset<CountedValue> t;
+    for (int round = 0; round < 3; ++round) {
+      for (int i = 0; i < 100; ++i) t.insert(CountedValue(i % 10));
+      EXPECT_EQ(CountedValue::alive, 100);
+      while (static_cast<int>(t.size()) > 50) t.erase(t.begin());
+      EXPECT_EQ(CountedValue::alive, 50);
+      EXPECT_EQ((*t.begin()).value, 5);
+      t.clear();
+      EXPECT_EQ(CountedValue::alive, 0);
+    }
+    t.insert_many(CountedValue(3), CountedValue(1), CountedValue(2));
+    EXPECT_EQ(CountedValue::alive, 3);
+  }
+  EXPECT_EQ(CountedValue::alive, 0);
+}
+
+TEST(multiset, CopyReusesNodes) {
+  s21::pmr::multiset<CountedValue> source;
+  for (int i = 0; i < 200; ++i) source.insert(CountedValue(i % 50));
+
+  alignas(std::max_align_t) unsigned char buffer[32768];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+  s21::pmr::multiset<CountedValue> copy(&resource);
+  // a buffer that fits the nodes only a few times over proves that repeated
+  // copies go into the same memory
+  for (int round = 0; round < 20; ++round) {
+    copy.insert(CountedValue(-1));
+    copy = source;
+  }
+  EXPECT_EQ(CountedValue::alive, 400);
+  EXPECT_EQ(copy.size(), 200U);
+  EXPECT_EQ(copy.count(CountedValue(7)), 4U);
+  EXPECT_EQ((*copy.nth(4)).value, 1);
+  EXPECT_EQ((*(--copy.end())).value, 49);
+}
+
+TEST(multiset, FromSorted) {
+  s21::vector<int> values;
+  for (int i = 0; i < 1000; ++i) values.push_back(i / 4);
+  auto t = s21::multiset<int>::from_sorted(values.begin(), values.end());
+
+  EXPECT_EQ(t.size(), 1000U);
+  EXPECT_EQ(t.count(100), 4U);
+  EXPECT_EQ(*t.nth(999), 249);
+  EXPECT_EQ(*(--t.end()), 249);
+  for (int i = 0; i < 1000; i += 3) t.erase(t.find(i / 4));
+  for (int i = 0; i < 100; ++i) t.insert(i);
+  EXPECT_EQ(t.size(), 766U);
+  int previous = -1;
+  for (int value : t) {
+    EXPECT_LE(previous, value);
+    previous = value;
+  }
+
+  s21::multiset<int> empty =
+      s21::multiset<int>::from_sorted(values.begin(), values.begin());
+  EXPECT_TRUE(empty.empty());
+  EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(multiset, HintedInsert) {
+  s21::multiset<int> t = {1, 3, 3, 5};
+  auto hint = t.upper_bound(3);
+  auto it = t.insert(hint, 3);
+  EXPECT_TRUE(++it == hint);
+
+  it = t.insert(t.begin(), 4);
+  EXPECT_EQ(*it, 4);
+  EXPECT_EQ(*(++it), 5);
+  t.emplace_hint(t.end(), 9);
+  t.emplace_hint(t.end(), 0);
+  EXPECT_EQ(t.size(), 8U);
+  EXPECT_EQ(*t.begin(), 0);
+  EXPECT_EQ(*(--t.end()), 9);
+  EXPECT_EQ(t.count(3), 3U);
+}
+
+TEST(multiset, HeterogeneousLookup) {
+  s21::multiset<std::string, std::less<>> words = {"pear", "apple", "pear",
+                                                   "fig", "pear"};
+  std::string_view pear = "pear";
+  EXPECT_EQ(words.count(pear), 3U);
+  EXPECT_TRUE(words.contains(std::string_view("fig")));
+  EXPECT_TRUE(words.find(std::string_view("plum")) == words.end());
+  EXPECT_EQ(*words.lower_bound(std::string_view("b")), "fig");
+  EXPECT_TRUE(words.upper_bound(pear) == words.end());
+  auto range = words.equal_range(pear);
+  EXPECT_TRUE(range.first == words.nth(2));
+  EXPECT_TRUE(range.second == words.end());
+}
+
+TEST(multiset, CustomCompare) {
+  s21::multiset<int, std::greater<int>> t = {1, 5, 3, 5, 1, 5};
+  EXPECT_EQ(*t.begin(), 5);
+  EXPECT_EQ(t.count(5), 3U);
+  EXPECT_EQ(*t.lower_bound(4), 3);
+  EXPECT_EQ(*t.upper_bound(5), 3);
+  auto range = t.equal_range(1);
+  EXPECT_TRUE(range.first == t.nth(4));
+  EXPECT_TRUE(range.second == t.end());
+
+  s21::multiset<int, std::greater<int>> copy = t;
+  copy.insert(4);
+  EXPECT_EQ(*copy.nth(3), 4);
+}
+
+TEST(multiset, FindMany) {
+  s21::multiset<int> t = {4, 1, 4, 2, 4, 9, 1};
+  s21::vector<int> keys = {1, 1, 3, 4, 9, 10};
+  s21::vector<s21::multiset<int>::iterator> found;
+  t.find_many(keys.begin(), keys.end(), found);
+
+  ASSERT_EQ(found.size(), 6U);
+  EXPECT_TRUE(found[0] == t.nth(0));
+  EXPECT_TRUE(found[1] == t.nth(0));
+  EXPECT_TRUE(found[2] == t.end());
+  EXPECT_TRUE(found[3] == t.nth(3));
+  EXPECT_TRUE(found[4] == t.nth(6));
+  EXPECT_TRUE(found[5] == t.end());
+}
+
+TEST(multiset, SplitJoin) {
+  std::mt19937 rng(31);
+  for (int round = 0; round < 40; ++round) {
+    s21::multiset<int> t;
+    std::multiset<int> orig;
+    int range = 1 + round * 5;
+    for (int i = 0; i < 60 * round; ++i) {
+      int value = static_cast<int>(rng() % range);
+      t.insert(value);
+      orig.insert(value);
+    }
+
+    // every copy of the key goes right
+    int key = static_cast<int>(rng() % range);
+    s21::multiset<int> right = t.split(key);
+    EXPECT_EQ(t.size(), static_cast<size_t>(std::distance(
+                            orig.begin(), orig.lower_bound(key))));
+    EXPECT_EQ(right.count(key), orig.count(key));
+    EXPECT_FALSE(t.contains(key));
+
+    // the last key of the left may repeat the first of the right
+    if (!right.empty()) {
+      t.insert(*right.begin());
+      orig.insert(*right.begin());
+    }
+    t.join(right);
+    EXPECT_TRUE(right.empty());
+    ASSERT_EQ(t.size(), orig.size());
+    auto it = t.begin();
+    for (int value : orig) EXPECT_EQ(*it++, value);
+    EXPECT_EQ(t.count(key), orig.count(key));
+  }
+
+  s21::multiset<int> low = {1, 2};
+  s21::multiset<int> high = {1, 3};
+  EXPECT_THROW(low.join(high), std::invalid_argument);
+}
+
+TEST(multiset, SetAlgebra) {
+  std::mt19937 rng(37);
+  const std::pair<int, int> sizes[] = {
+      {500, 800}, {20000, 30}, {30, 20000}, {200000, 150000}};
+  for (const auto &[aSize, bSize] : sizes) {
+    s21::multiset<int> a, b;
+    std::multiset<int> origA, origB;
+    // few distinct keys, so that most of them repeat on both sides
+    const int range = std::max(aSize, bSize) / 4 + 1;
+    for (int i = 0; i < aSize; ++i) {
+      int value = static_cast<int>(rng() % range);
+      a.insert(value);
+      origA.insert(value);
+    }
+    for (int i = 0; i < bSize; ++i) {
+      int value = static_cast<int>(rng() % range);
+      b.insert(value);
+      origB.insert(value);
+    }
+
+    for (size_t threads : {1, 3}) {
+      std::vector<int> expected;
+      std::set_union(origA.begin(), origA.end(), origB.begin(), origB.end(),
+                     std::back_inserter(expected));
+      s21::multiset<int> result = a.union_with(b, threads);
+      ASSERT_EQ(result.size(), expected.size());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+      expected.clear();
+      std::set_intersection(origA.begin(), origA.end(), origB.begin(),
+                            origB.end(), std::back_inserter(expected));
+      result = a.intersection_with(b, threads);
+      ASSERT_EQ(result.size(), expected.size());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+      expected.clear();
+      std::set_difference(origA.begin(), origA.end(), origB.begin(),
+                          origB.end(), std::back_inserter(expected));
+      result = a.difference_with(b, threads);
+      ASSERT_EQ(result.size(), expected.size());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+    }
+  }
+
+  // a key counts as many times as the most, the fewest and the surplus of
+  // its copies
+  s21::multiset<int> a = {1, 1, 1, 2, 3, 3};
+  s21::multiset<int> b = {1, 3, 3, 3, 4};
+  EXPECT_EQ(a.union_with(b).count(3), 3U);
+  EXPECT_EQ(a.intersection_with(b).count(1), 1U);
+  EXPECT_EQ(a.difference_with(b).count(1), 2U);
+  EXPECT_EQ(a.difference_with(b).count(3), 0U);
+  EXPECT_EQ(b.difference_with(a).size(), 2U);
+}
+
+TEST(multiset, ExtractInsert) {
+  s21::multiset<int> my_set = {1, 2, 2, 2, 3};
+  auto node = my_set.extract(2);
+  EXPECT_EQ(node.value(), 2);
+  EXPECT_EQ(my_set.count(2), 2U);
+
+  // an equal key takes the node all the same
+  auto it = my_set.insert(std::move(node));
+  EXPECT_TRUE(node.empty());
+  EXPECT_EQ(my_set.count(2), 3U);
+  EXPECT_EQ(*it, 2);
+
+  node = my_set.extract(my_set.begin());
+  node.value() = 5;
+  it = my_set.insert(my_set.end(), std::move(node));
+  EXPECT_EQ(*it, 5);
+  EXPECT_EQ(*my_set.begin(), 2);
+  EXPECT_EQ(my_set.size(), 5U);
+
+  s21::multiset<int> other = {2, 9};
+  other.merge(my_set);
+  EXPECT_TRUE(my_set.empty());
+  EXPECT_EQ(other.count(2), 4U);
+  EXPECT_EQ(other.size(), 7U);
+}
+
+// orders pairs by their first value only, so equal keys stay apart
+struct FirstLess {
+  bool operator()(const std::pair<int, int> &a,
+                  const std::pair<int, int> &b) const {
+    return a.first < b.first;
+  }
+};
+
+// FirstLess with a three-way compare(), which lookups stop at as soon as
+// it finds a value equal to the key
+struct FirstCompare : FirstLess {
+  int compare(const std::pair<int, int> &a,
+              const std::pair<int, int> &b) const {
+    return (a.first > b.first) - (a.first < b.first);
+  }
+};
+
+TEST(multiset, ExtractTakesTheFirstEqual) {
+  s21::multiset<std::pair<int, int>, FirstCompare> my_set;
+  for (int key = 0; key < 200; ++key)
+    for (int copy = 0; copy < 10; ++copy) my_set.insert({key, copy});
+  for (int key = 0; key < 200; ++key) {
+    const std::pair<int, int> first = *my_set.lower_bound({key, -1});
+    auto node = my_set.extract(std::pair<int, int>(key, -1));
+    ASSERT_FALSE(node.empty());
+    EXPECT_EQ(node.value(), first);
+  }
+  EXPECT_EQ(my_set.size(), 1800U);
+  EXPECT_TRUE(my_set.extract(std::pair<int, int>(200, 0)).empty());
+}
+
+TEST(multiset, InsertNodeGoesAfterTheEqual) {
+  s21::multiset<std::pair<int, int>, FirstLess> my_set;
+  std::multiset<std::pair<int, int>, FirstLess> orig_set;
+  for (int i = 0; i < 100; ++i) {
+    my_set.insert({i % 4, i});
+    orig_set.insert({i % 4, i});
+  }
+  for (int key = 0; key < 4; ++key) {
+    my_set.insert(my_set.extract(std::pair<int, int>(key, 0)));
+    orig_set.insert(orig_set.extract(std::pair<int, int>(key, 0)));
+  }
+  ASSERT_EQ(my_set.size(), orig_set.size());
+  EXPECT_TRUE(std::equal(orig_set.begin(), orig_set.end(), my_set.begin()));
+}
+
+TEST(multiset, InsertKeepsEqualValuesInOrder) {
+  using Alloc = std::pmr::polymorphic_allocator<std::pair<int, int>>;
+  std::pmr::monotonic_buffer_resource resource;
+  s21::multiset<std::pair<int, int>, FirstLess, Alloc> inserted, emplaced;
+  std::multiset<std::pair<int, int>, FirstLess> orig_set;
+  for (int i = 0; i < 300; ++i) {
+    const std::pair<int, int> value(i * 7 % 5, i);
+    inserted.insert(value);
+    emplaced.emplace(value.first, value.second);
+    orig_set.insert(value);
+  }
+  // nodes of another resource are moved over one by one
+  s21::multiset<std::pair<int, int>, FirstLess, Alloc> moved(FirstLess(),
+                                                             &resource);
+  moved = std::move(emplaced);
+
+  ASSERT_EQ(inserted.size(), orig_set.size());
+  ASSERT_EQ(moved.size(), orig_set.size());
+  EXPECT_TRUE(std::equal(orig_set.begin(), orig_set.end(), inserted.begin()));
+  EXPECT_TRUE(std::equal(orig_set.begin(), orig_set.end(), moved.begin()));
+}
+
+TEST(multiset, MergeKeepsEqualValuesInOrder) {
+  // comparable sizes are merged in one walk, the others by searches
+  for (int size : {0, 40, 1000}) {
+    s21::multiset<std::pair<int, int>, FirstLess> my_set, my_other;
+    for (int i = 0; i < size; ++i) my_set.insert({i % 7, i});
+    for (int i = 0; i < 40; ++i) my_other.insert({i % 5, -i});
+    std::vector<std::pair<int, int>> mine, others, expected;
+    for (auto it = my_set.begin(); it != my_set.end(); ++it)
+      mine.push_back(*it);
+    for (auto it = my_other.begin(); it != my_other.end(); ++it)
+      others.push_back(*it);
+    std::merge(mine.begin(), mine.end(), others.begin(), others.end(),
+               std::back_inserter(expected), FirstLess());
+
+    my_set.merge(my_other);
+    EXPECT_TRUE(my_other.empty());
+    ASSERT_EQ(my_set.size(), expected.size());
+    EXPECT_TRUE(std::equal(expected.begin(), expected.end(), my_set.begin()));
+    for (size_t i = 0; i < expected.size(); i += 11)
+      EXPECT_EQ(*my_set.nth(i), expected[i]);
+  }
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <utility>
+
+// The node_type of set, multiset and map, made by extract(). It owns the
+// element taken out of a container until insert() puts it into one of the
+// same type, and the element may be changed meanwhile, even its key. On
+// RBTree the element stays in its tree node, which the new container links
+// as it is, without allocating or copying anything, if the allocators are
+// equal; on the other trees, and in the S21_INDEX_NODES layout, the
+// element is moved in and out of the handle.
+namespace s21 {
+// how the containers reach the tree handle in their node_type
+struct NodeAccess {
+  template <typename NodeType>
+  static auto &Handle(NodeType &node) noexcept {
+    return node.handle_;
+  }
+};
+
+template <typename TreeHandle, typename Value, typename Allocator>
+class set_node_handle {
+ public:
+  using value_type = Value;
+  using allocator_type = Allocator;
+
+ public:
+  set_node_handle() = default;
+
+ public:
+  bool empty() const noexcept { return handle_.Empty(); }
+  explicit operator bool() const noexcept { return !empty(); }
+  allocator_type get_allocator() const { return handle_.GetAllocator(); }
+  value_type &value() const { return *handle_.Get(); }
+  void swap(set_node_handle &other) { std::swap(handle_, other.handle_); }
+
+ private:
+  friend struct NodeAccess;
+  TreeHandle handle_;
+};
+
+template <typename TreeHandle, typename Key, typename T, typename Allocator>
+class map_node_handle {
+ public:
+  using key_type = Key;
+  using mapped_type = T;
+  using allocator_type = Allocator;
+
+ public:
+  map_node_handle() = default;
+
+ public:
+  bool empty() const noexcept { return handle_.Empty(); }
+  explicit operator bool() const noexcept { return !empty(); }
+  allocator_type get_allocator() const { return handle_.GetAllocator(); }
+  key_type &key() const { return handle_.Get()->first; }
+  mapped_type &mapped() const { return handle_.Get()->second; }
+  void swap(map_node_handle &other) { std::swap(handle_, other.handle_); }
+
+ private:
+  friend struct NodeAccess;
+  TreeHandle handle_;
+};
+
+// what insert(node_type &&) of set and map returns: where the element is,
+// whether it was inserted, and the node when an equal key kept it out
+template <typename Iterator, typename NodeType>
+struct node_insert_return {
+  Iterator position;
+  bool inserted;
+  NodeType node;
+};
+}  // namespace s21
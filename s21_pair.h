@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstddef>
 #include <iostream>
+#include <tuple>
 #include <utility>
 
 namespace s21 {
@@ -10,15 +12,31 @@ class s21_pair {
  public:
   s21_pair() = default;
   s21_pair(const Type1 &v1, const Type2 &v2);
-  s21_pair(std::pair<Type1, Type2> pair);
+  s21_pair(const std::pair<Type1, Type2> &pair);
+  s21_pair(std::pair<Type1, Type2> &&pair);
+
+  template <typename U1, typename U2>
+  s21_pair(U1 &&v1, U2 &&v2);
+
+  // constructs first and second in place from the elements of the tuples
+  template <typename... Args1, typename... Args2>
+  s21_pair(std::piecewise_construct_t, std::tuple<Args1...> args1,
+           std::tuple<Args2...> args2);
 
  public:
-  bool operator<(const s21_pair &other);
-  bool operator>(const s21_pair &other);
+  // lexicographic, first then second, as for std::pair
+  bool operator<(const s21_pair &other) const;
+  bool operator>(const s21_pair &other) const;
 
  public:
   Type1 first;
   Type2 second;
+
+ private:
+  template <typename... Args1, typename... Args2, std::size_t... I1,
+            std::size_t... I2>
+  s21_pair(std::tuple<Args1...> &args1, std::tuple<Args2...> &args2,
+           std::index_sequence<I1...>, std::index_sequence<I2...>);
 };
 
 }  // namespace s21
@@ -28,15 +46,43 @@ s21::s21_pair<Type1, Type2>::s21_pair(const Type1 &v1, const Type2 &v2)
     : first(v1), second(v2) {}
 
 template <typename Type1, typename Type2>
-s21::s21_pair<Type1, Type2>::s21_pair(std::pair<Type1, Type2> pair)
+s21::s21_pair<Type1, Type2>::s21_pair(const std::pair<Type1, Type2> &pair)
     : first(pair.first), second(pair.second) {}
 
 template <typename Type1, typename Type2>
-bool s21::s21_pair<Type1, Type2>::operator<(const s21_pair &other) {
-  return first < other.first;
+s21::s21_pair<Type1, Type2>::s21_pair(std::pair<Type1, Type2> &&pair)
+    : first(std::move(pair.first)), second(std::move(pair.second)) {}
+
+template <typename Type1, typename Type2>
+template <typename U1, typename U2>
+s21::s21_pair<Type1, Type2>::s21_pair(U1 &&v1, U2 &&v2)
+    : first(std::forward<U1>(v1)), second(std::forward<U2>(v2)) {}
+
+template <typename Type1, typename Type2>
+template <typename... Args1, typename... Args2>
+s21::s21_pair<Type1, Type2>::s21_pair(std::piecewise_construct_t,
+                                      std::tuple<Args1...> args1,
+                                      std::tuple<Args2...> args2)
+    : s21_pair(args1, args2, std::index_sequence_for<Args1...>(),
+               std::index_sequence_for<Args2...>()) {}
+
+template <typename Type1, typename Type2>
+template <typename... Args1, typename... Args2, std::size_t... I1,
+          std::size_t... I2>
+s21::s21_pair<Type1, Type2>::s21_pair(std::tuple<Args1...> &args1,
+                                      std::tuple<Args2...> &args2,
+                                      std::index_sequence<I1...>,
+                                      std::index_sequence<I2...>)
+    : first(std::forward<Args1>(std::get<I1>(args1))...),
+      second(std::forward<Args2>(std::get<I2>(args2))...) {}
+
+template <typename Type1, typename Type2>
+bool s21::s21_pair<Type1, Type2>::operator<(const s21_pair &other) const {
+  if (first < other.first) return true;
+  return !(other.first < first) && second < other.second;
 }
 
 template <typename Type1, typename Type2>
-bool s21::s21_pair<Type1, Type2>::operator>(const s21_pair &other) {
-  return first > other.first;
+bool s21::s21_pair<Type1, Type2>::operator>(const s21_pair &other) const {
+  return other < *this;
 }
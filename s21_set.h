@@ -1,173 +1,501 @@
-#pragma once
-
-#include <initializer_list>
-#include <limits>
-
-#include "RBTree.h"
-#include "s21_vector.h"
-
-namespace s21 {
-template <typename Key>
-class set {
- public:
-  using iterator = typename RBTree<Key>::RBIterator;
-  using const_iterator = const typename RBTree<Key>::RBIterator;
-  using size_type = std::size_t;
-
- public:
-  set() = default;
-  set(std::initializer_list<Key> const &items);
-  set(const set &s);
-  set(set &&s);
-  ~set();
-
- public:
-  void operator=(set &&s);
-
- public:
-  iterator begin();
-  iterator end();
-
- public:
-  bool empty();
-  size_type size();
-  size_type max_size();
-
- public:
-  void clear();
-  std::pair<iterator, bool> insert(const Key &value);
-  void erase(iterator pos);
-  void swap(set &other);
-  void merge(set &other);
-
- public:
-  iterator find(const Key &key);
-  bool contains(const Key &key);
-
- public:
-  template <typename... Args>
-  s21::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
-    s21::vector<std::pair<iterator, bool>> result;
-    InsertManyRec(result, args...);
-    return result;
-  }
-
- private:
-  template <typename T0, typename... Args>
-  void InsertManyRec(s21::vector<std::pair<iterator, bool>> &vec, const T0 &v0,
-                     Args &&...args) {
-    if constexpr (sizeof...(args) != 0) {
-      if (rbTree_.Contains(v0))
-        vec.push_back({rbTree_.Find(v0), false});
-      else
-        vec.push_back(insert(v0));
-      InsertManyRec(vec, args...);
-    } else {
-      if (rbTree_.Contains(v0))
-        vec.push_back({rbTree_.Find(v0), false});
-      else
-        vec.push_back(insert(v0));
-    }
-  }
-
- private:
-  RBTree<Key> rbTree_;
-};
-}  // namespace s21
-
-template <typename Key>
-s21::set<Key>::set(std::initializer_list<Key> const &items) {
-  for (const Key &val : items) rbTree_.Insert(val);
-}
-
-template <typename Key>
-s21::set<Key>::set(const set &s) {
-  rbTree_ = s.rbTree_;
-}
-
-template <typename Key>
-s21::set<Key>::set(set &&s) {
-  rbTree_ = std::move(s.rbTree_);
-}
-
-template <typename Key>
-s21::set<Key>::~set() {
-  rbTree_.Clear();
-}
-
-template <typename Key>
-void s21::set<Key>::operator=(set &&s) {
-  rbTree_ = std::move(s.rbTree_);
-}
-
-template <typename Key>
-typename s21::set<Key>::iterator s21::set<Key>::begin() {
-  return rbTree_.begin();
-}
-
-template <typename Key>
-typename s21::set<Key>::iterator s21::set<Key>::end() {
-  return rbTree_.end();
-}
-
-template <typename Key>
-bool s21::set<Key>::empty() {
-  return rbTree_.Empty();
-}
-
-template <typename Key>
-typename s21::set<Key>::size_type s21::set<Key>::size() {
-  return rbTree_.Size();
-}
-
-template <typename Key>
-typename s21::set<Key>::size_type s21::set<Key>::max_size() {
-  return std::numeric_limits<Key>::max();  // need test
-}
-
-template <typename Key>
-void s21::set<Key>::clear() {
-  rbTree_.Clear();
-}
-
-template <typename Key>
-void s21::set<Key>::erase(iterator pos) {
-  if (pos != rbTree_.end()) rbTree_.Erase(pos);
-}
-
-template <typename Key>
-void s21::set<Key>::swap(set &other) {
-  rbTree_.Swap(other.rbTree_);
-}
-
-template <typename Key>
-typename s21::set<Key>::iterator s21::set<Key>::find(const Key &key) {
-  return rbTree_.Find(key);
-}
-
-template <typename Key>
-bool s21::set<Key>::contains(const Key &key) {
-  return rbTree_.Contains(key);
-}
-
-template <typename Key>
-std::pair<typename s21::set<Key>::iterator, bool> s21::set<Key>::insert(
-    const Key &value) {
-  if (rbTree_.Contains(value))
-    return {rbTree_.Find(value), false};
-  else
-    return rbTree_.Insert(value);
-}
-
-template <typename Key>
-void s21::set<Key>::merge(set &other) {
-  s21::set<Key> deleteValues;
-
-  for (const auto &val : other)
-    if (!contains(val)) {
-      rbTree_.Insert(val);
-      deleteValues.insert(val);
-    }
-
-  for (const auto &val : deleteValues) other.rbTree_.Erase(val);
-}
+#pragma once
+
+#include <algorithm>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <stdexcept>
+
+#include "RBTree.h"
+#include "SetAlgebra.h"
+#include "s21_frozen.h"
+#include "s21_node_handle.h"
+#include "s21_vector.h"
+
+namespace s21 {
+// the elements are kept in a Tree, RBTree by default, BTree (see
+// s21_btree.h) or FlatTree (see s21_flat.h); all have the same interface
+template <typename Key, typename Compare = std::less<Key>,
+          typename Allocator = std::allocator<Key>,
+          template <typename, typename, typename, typename> class Tree = RBTree>
+class set {
+ public:
+  using iterator =
+      typename Tree<Key, Allocator, Identity, Compare>::Iterator;
+  using const_iterator =
+      const typename Tree<Key, Allocator, Identity, Compare>::Iterator;
+  using size_type = std::size_t;
+  using key_compare = Compare;
+  using allocator_type = Allocator;
+  using node_type = set_node_handle<
+      typename Tree<Key, Allocator, Identity, Compare>::NodeHandle, Key,
+      Allocator>;
+  using insert_return_type = node_insert_return<iterator, node_type>;
+
+ public:
+  set() = default;
+  explicit set(const Compare &comp, const Allocator &alloc = Allocator());
+  explicit set(const Allocator &alloc);
+  set(std::initializer_list<Key> const &items,
+      const Compare &comp = Compare(), const Allocator &alloc = Allocator());
+  set(std::initializer_list<Key> const &items, const Allocator &alloc);
+  set(const set &s);
+  set(set &&s);
+  ~set();
+
+ public:
+  template <typename InputIt>
+  set(InputIt first, InputIt last, const Compare &comp = Compare(),
+      const Allocator &alloc = Allocator())
+      : tree_(comp, alloc) {
+    using Category = typename std::iterator_traits<InputIt>::iterator_category;
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+      if (std::is_sorted(first, last, comp)) {
+        AssignSorted(first, last);
+        return;
+      }
+    }
+    for (; first != last; ++first) insert(end(), *first);
+  }
+
+  template <typename InputIt>
+  set(InputIt first, InputIt last, const Allocator &alloc)
+      : set(first, last, Compare(), alloc) {}
+
+  // builds the set in O(n) from a range sorted in the order of comp,
+  // repeated keys are dropped
+  template <typename InputIt>
+  static set from_sorted(InputIt first, InputIt last,
+                         const Compare &comp = Compare(),
+                         const Allocator &alloc = Allocator()) {
+    set result(comp, alloc);
+    result.AssignSorted(first, last);
+    return result;
+  }
+
+ public:
+  allocator_type get_allocator() const;
+  key_compare key_comp() const;
+
+ public:
+  void operator=(set &&s);
+
+ public:
+  iterator begin();
+  iterator end();
+
+ public:
+  bool empty();
+  size_type size();
+  size_type max_size();
+
+ public:
+  void clear();
+  std::pair<iterator, bool> insert(const Key &value);
+  std::pair<iterator, bool> insert(Key &&value);
+  iterator insert(iterator hint, const Key &value);
+  iterator insert(iterator hint, Key &&value);
+  void erase(iterator pos);
+  void swap(set &other);
+  // moves the keys of other that this set lacks into it, the nodes
+  // themselves on RBTree, and leaves the others in other
+  void merge(set &other);
+  // moves the keys from key on to the returned set and keeps the ones
+  // before it, without copying any element; on RBTree in O(log n) plus
+  // O(min(k, n / 4096) log n) for the k elements of the smaller part
+  template <typename K = Key>
+  set split(const K &key);
+  // the counterpart of split: appends the keys of other, which must all
+  // follow the keys of this set, and leaves other empty
+  void join(set &other);
+
+ public:
+  // takes the element at pos, or the first with key if there is one, out
+  // of the set into a node handle, see s21_node_handle.h
+  node_type extract(iterator pos);
+  template <typename K = Key>
+  node_type extract(const K &key);
+  insert_return_type insert(node_type &&node);
+  iterator insert(iterator hint, node_type &&node);
+
+ public:
+  // new sets of the keys in this set or other, in both, and in this set
+  // but not in other; comparable sizes are merged in O(n + m), split over
+  // up to threads threads for large ones, and a set much smaller than the
+  // other is searched in it in O(m log(n / m + 1)), see SetAlgebra.h. With
+  // threads above 1 the allocator must be usable from several threads
+  set union_with(const set &other, size_type threads = 1) const;
+  set intersection_with(const set &other, size_type threads = 1) const;
+  set difference_with(const set &other, size_type threads = 1) const;
+
+ public:
+  // with a transparent Compare such as std::less<> key may be of any type
+  // comparable with Key, e.g. std::string_view for std::string keys, and is
+  // looked up as it is; otherwise it is converted to Key once
+  template <typename K = Key>
+  iterator find(const K &key);
+  template <typename K = Key>
+  bool contains(const K &key);
+  // appends to out the result of find for every key of [first, last),
+  // running the searches side by side so that their cache misses overlap
+  template <typename ForwardIt>
+  void find_many(ForwardIt first, ForwardIt last,
+                 s21::vector<iterator> &out);
+
+ public:
+  iterator nth(size_type k);
+  size_type rank(const Key &key);
+  size_type count_range(const Key &lo, const Key &hi);
+
+ public:
+  // a read-only snapshot laid out for faster searches, see s21_frozen.h
+  frozen_set<Key, Compare, Allocator> freeze() const;
+
+ public:
+  // the element is constructed from args in place, inside its tree node
+  template <typename... Args>
+  std::pair<iterator, bool> emplace(Args &&...args) {
+    return tree_.EmplaceUnique(std::forward<Args>(args)...);
+  }
+
+  // hint is the position the new element is expected to precede
+  template <typename... Args>
+  iterator emplace_hint(iterator hint, Args &&...args) {
+    return tree_.EmplaceHintUnique(hint, std::forward<Args>(args)...).first;
+  }
+
+  template <typename... Args>
+  s21::vector<std::pair<iterator, bool>> insert_many(Args &&...args) {
+    s21::vector<std::pair<iterator, bool>> result;
+    InsertManyRec(result, std::forward<Args>(args)...);
+    return result;
+  }
+
+ private:
+  template <typename T0, typename... Args>
+  void InsertManyRec(s21::vector<std::pair<iterator, bool>> &vec, T0 &&v0,
+                     Args &&...args) {
+    // hinting with the successor of the previous value makes ascending
+    // arguments take the constant time path
+    iterator hint = vec.empty() ? end() : ++iterator(vec.back().first);
+    vec.push_back(tree_.InsertUnique(hint, Key(std::forward<T0>(v0))));
+    if constexpr (sizeof...(args) != 0)
+      InsertManyRec(vec, std::forward<Args>(args)...);
+  }
+
+ private:
+  template <typename InputIt>
+  void AssignSorted(InputIt first, InputIt last) {
+    tree_.AssignSorted(first, last,
+                       [comp = key_comp()](const Key &a, const Key &b) {
+                         return !comp(a, b);
+                       });
+  }
+
+ private:
+  Tree<Key, Allocator, Identity, Compare> tree_;
+};
+
+namespace pmr {
+template <typename Key>
+using set =
+    s21::set<Key, std::less<Key>, std::pmr::polymorphic_allocator<Key>>;
+}  // namespace pmr
+}  // namespace s21
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::set(const Compare &comp,
+                                             const Allocator &alloc)
+    : tree_(comp, alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::set(const Allocator &alloc)
+    : tree_(alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::set(
+    std::initializer_list<Key> const &items, const Compare &comp,
+    const Allocator &alloc)
+    : set(items.begin(), items.end(), comp, alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::set(
+    std::initializer_list<Key> const &items, const Allocator &alloc)
+    : set(items.begin(), items.end(), alloc) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::set(const set &s) : tree_(s.tree_) {}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::set(set &&s)
+    : tree_(s.tree_.GetCompare(), s.tree_.GetAllocator()) {
+  tree_ = std::move(s.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>::~set() {
+  tree_.Clear();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::set<Key, Compare, Allocator, Tree>::operator=(set &&s) {
+  tree_ = std::move(s.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::begin() {
+  return tree_.begin();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::end() {
+  return tree_.end();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::allocator_type
+s21::set<Key, Compare, Allocator, Tree>::get_allocator() const {
+  return tree_.GetAllocator();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::key_compare
+s21::set<Key, Compare, Allocator, Tree>::key_comp() const {
+  return tree_.GetCompare();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+bool s21::set<Key, Compare, Allocator, Tree>::empty() {
+  return tree_.Empty();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::size_type
+s21::set<Key, Compare, Allocator, Tree>::size() {
+  return tree_.Size();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::size_type
+s21::set<Key, Compare, Allocator, Tree>::max_size() {
+  return std::numeric_limits<Key>::max();  // need test
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::set<Key, Compare, Allocator, Tree>::clear() {
+  tree_.Clear();
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::set<Key, Compare, Allocator, Tree>::erase(iterator pos) {
+  if (pos != tree_.end()) tree_.Erase(pos);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::set<Key, Compare, Allocator, Tree>::swap(set &other) {
+  tree_.Swap(other.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::find(const K &key) {
+  return tree_.Find(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+bool s21::set<Key, Compare, Allocator, Tree>::contains(const K &key) {
+  return tree_.Contains(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename ForwardIt>
+void s21::set<Key, Compare, Allocator, Tree>::find_many(
+    ForwardIt first, ForwardIt last, s21::vector<iterator> &out) {
+  tree_.FindMany(first, last, out);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::set<Key, Compare, Allocator, Tree>::iterator, bool>
+s21::set<Key, Compare, Allocator, Tree>::insert(const Key &value) {
+  return tree_.InsertUnique(value);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+std::pair<typename s21::set<Key, Compare, Allocator, Tree>::iterator, bool>
+s21::set<Key, Compare, Allocator, Tree>::insert(Key &&value) {
+  return tree_.InsertUnique(std::move(value));
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::insert(
+    iterator hint, const Key &value) {
+  return tree_.InsertUnique(hint, value).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::insert(iterator hint, Key &&value) {
+  return tree_.InsertUnique(hint, std::move(value)).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::set<Key, Compare, Allocator, Tree>::merge(set &other) {
+  tree_.MergeUnique(other.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::node_type
+s21::set<Key, Compare, Allocator, Tree>::extract(iterator pos) {
+  node_type node;
+  NodeAccess::Handle(node) = tree_.Extract(pos);
+
+  return node;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+typename s21::set<Key, Compare, Allocator, Tree>::node_type
+s21::set<Key, Compare, Allocator, Tree>::extract(const K &key) {
+  iterator pos = tree_.Find(key);
+
+  return pos == end() ? node_type() : extract(pos);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::insert_return_type
+s21::set<Key, Compare, Allocator, Tree>::insert(node_type &&node) {
+  std::pair<iterator, bool> result =
+      tree_.InsertNodeUnique(NodeAccess::Handle(node));
+  if (result.second) return {result.first, true, node_type()};
+
+  return {result.first, false, std::move(node)};
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::insert(iterator hint,
+                                               node_type &&node) {
+  return tree_.InsertNodeUnique(hint, NodeAccess::Handle(node)).first;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+template <typename K>
+s21::set<Key, Compare, Allocator, Tree>
+s21::set<Key, Compare, Allocator, Tree>::split(const K &key) {
+  set right(key_comp(), get_allocator());
+  tree_.Split(key, right.tree_);
+
+  return right;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+void s21::set<Key, Compare, Allocator, Tree>::join(set &other) {
+  if (!empty() && !other.empty() && !key_comp()(*--end(), *other.begin()))
+    throw std::invalid_argument("join of overlapping sets");
+  tree_.Join(other.tree_);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>
+s21::set<Key, Compare, Allocator, Tree>::union_with(
+    const set &other, size_type threads) const {
+  set result(tree_.GetCompare(), tree_.GetAllocator());
+  SetAlgebra<Tree<Key, Allocator, Identity, Compare>>::Union(
+      tree_, other.tree_, threads, result.tree_);
+
+  return result;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>
+s21::set<Key, Compare, Allocator, Tree>::intersection_with(
+    const set &other, size_type threads) const {
+  set result(tree_.GetCompare(), tree_.GetAllocator());
+  SetAlgebra<Tree<Key, Allocator, Identity, Compare>>::Intersection(
+      tree_, other.tree_, threads, result.tree_);
+
+  return result;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::set<Key, Compare, Allocator, Tree>
+s21::set<Key, Compare, Allocator, Tree>::difference_with(
+    const set &other, size_type threads) const {
+  set result(tree_.GetCompare(), tree_.GetAllocator());
+  SetAlgebra<Tree<Key, Allocator, Identity, Compare>>::Difference(
+      tree_, other.tree_, threads, result.tree_);
+
+  return result;
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::iterator
+s21::set<Key, Compare, Allocator, Tree>::nth(size_type k) {
+  return tree_.Nth(k);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::size_type
+s21::set<Key, Compare, Allocator, Tree>::rank(const Key &key) {
+  return tree_.Rank(key);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+typename s21::set<Key, Compare, Allocator, Tree>::size_type
+s21::set<Key, Compare, Allocator, Tree>::count_range(
+    const Key &lo, const Key &hi) {
+  return tree_.CountRange(lo, hi);
+}
+
+template <typename Key, typename Compare, typename Allocator,
+          template <typename, typename, typename, typename> class Tree>
+s21::frozen_set<Key, Compare, Allocator>
+s21::set<Key, Compare, Allocator, Tree>::freeze() const {
+  return frozen_set<Key, Compare, Allocator>::from_sorted(
+      tree_.begin(), tree_.end(), tree_.GetCompare(), tree_.GetAllocator());
+}
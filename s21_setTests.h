@@ -2,7 +2,17 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <random>
 #include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "s21_set.h"
 
@@ -185,3 +195,663 @@ TEST(set_insert, insert_many_test_0) {
   EXPECT_EQ(v[1].second, 1);
   EXPECT_EQ(v[2].second, 1);
 }
+
+TEST(set, OrderStatistics) {
+  s21::set<int> my_set;
+  for (int i = 0; i < 1000; ++i) my_set.insert((i * 37) % 1000);
+
+  EXPECT_EQ(static_cast<int>(my_set.size()), 1000);
+  for (int i = 0; i < 1000; i += 99) {
+    EXPECT_EQ(*my_set.nth(i), i);
+    EXPECT_EQ(static_cast<int>(my_set.rank(i)), i);
+  }
+  EXPECT_EQ(static_cast<int>(my_set.count_range(100, 200)), 100);
+
+  for (int i = 0; i < 1000; i += 2) my_set.erase(my_set.find(i));
+  EXPECT_EQ(static_cast<int>(my_set.size()), 500);
+  EXPECT_EQ(*my_set.nth(0), 1);
+  EXPECT_EQ(*my_set.nth(499), 999);
+  EXPECT_EQ(static_cast<int>(my_set.rank(500)), 250);
+}
+
+TEST(set, EndIteratorStaysValid) {
+  s21::set<int> my_set;
+  auto end = my_set.end();
+  EXPECT_TRUE(my_set.begin() == end);
+
+  my_set.insert_many(5, 1, 9, 3, 7);
+  EXPECT_TRUE(my_set.end() == end);
+  EXPECT_EQ(*my_set.begin(), 1);
+  EXPECT_EQ(*(--my_set.end()), 9);
+  EXPECT_TRUE(--my_set.begin() == end);
+  EXPECT_TRUE(++(--my_set.end()) == end);
+
+  my_set.erase(--my_set.end());
+  my_set.erase(my_set.begin());
+  EXPECT_EQ(*my_set.begin(), 3);
+  EXPECT_EQ(*(--my_set.end()), 7);
+
+  s21::set<int> other = {42};
+  my_set.swap(other);
+  EXPECT_EQ(*(--my_set.end()), 42);
+  EXPECT_EQ(*(--other.end()), 7);
+  int count = 0;
+  for (auto it = other.begin(); it != other.end(); ++it) ++count;
+  EXPECT_EQ(count, 3);
+}
+
+TEST(set, PolymorphicAllocator) {
+  alignas(std::max_align_t) unsigned char buffer[16384];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  s21::pmr::set<int> my_set(&resource);
+  for (int i = 0; i < 100; ++i) my_set.insert(i % 50);
+  EXPECT_EQ(my_set.size(), 50U);
+  EXPECT_EQ(*my_set.nth(25), 25);
+  EXPECT_TRUE(my_set.get_allocator().resource() == &resource);
+
+  s21::pmr::set<int> moved = std::move(my_set);
+  EXPECT_EQ(moved.size(), 50U);
+  EXPECT_TRUE(moved.get_allocator().resource() == &resource);
+  moved.clear();
+  moved.insert(7);
+  EXPECT_TRUE(moved.contains(7));
+}
+
+TEST(set, RangeConstructor) {
+  s21::vector<int> sorted = {1, 2, 2, 3, 5, 8, 8, 8, 13};
+  s21::set<int> my_set(sorted.begin(), sorted.end());
+  std::set<int> orig_set(sorted.begin(), sorted.end());
+  EXPECT_EQ(my_set.size(), orig_set.size());
+  auto my_it = my_set.begin();
+  for (int value : orig_set) EXPECT_EQ(*my_it++, value);
+
+  s21::vector<int> unsorted = {5, 1, 5, 3, 1};
+  s21::set<int> other(unsorted.begin(), unsorted.end());
+  EXPECT_EQ(other.size(), 3U);
+  EXPECT_EQ(*other.begin(), 1);
+
+  s21::set<int> from_sorted = s21::set<int>::from_sorted(sorted.begin(),
+                                                         sorted.end());
+  EXPECT_EQ(from_sorted.size(), 6U);
+  EXPECT_EQ(*from_sorted.nth(5), 13);
+  EXPECT_EQ(from_sorted.rank(8), 4U);
+  from_sorted.insert(4);
+  from_sorted.erase(from_sorted.find(1));
+  EXPECT_EQ(*from_sorted.begin(), 2);
+  EXPECT_EQ(*from_sorted.nth(2), 4);
+}
+
+TEST(set, InsertUnique) {
+  s21::set<int> my_set = {4, 2, 4, 6, 2};
+  EXPECT_EQ(my_set.size(), 3U);
+
+  auto first = my_set.insert(5);
+  EXPECT_TRUE(first.second);
+  auto again = my_set.insert(5);
+  EXPECT_FALSE(again.second);
+  EXPECT_TRUE(again.first == first.first);
+  EXPECT_EQ(my_set.size(), 4U);
+  EXPECT_EQ(my_set.rank(6), 3U);
+
+  auto result = my_set.insert_many(1, 2, 7, 1);
+  EXPECT_TRUE(result[0].second);
+  EXPECT_FALSE(result[1].second);
+  EXPECT_TRUE(result[2].second);
+  EXPECT_FALSE(result[3].second);
+  EXPECT_TRUE(result[3].first == result[0].first);
+  EXPECT_EQ(my_set.size(), 6U);
+}
+
+TEST(set, MoveOnlyKeys) {
+  s21::set<std::unique_ptr<int>> my_set;
+  auto first = std::make_unique<int>(1);
+  EXPECT_TRUE(my_set.insert(std::move(first)).second);
+  EXPECT_EQ(first, nullptr);
+  EXPECT_TRUE(my_set.emplace(new int(2)).second);
+  my_set.emplace_hint(my_set.end(), new int(3));
+  EXPECT_EQ(my_set.size(), 3U);
+  EXPECT_FALSE(my_set.contains(std::make_unique<int>(4)));
+
+  int sum = 0;
+  for (const auto &ptr : my_set) sum += *ptr;
+  EXPECT_EQ(sum, 6);
+
+  // the values move one by one to a set of another memory resource
+  std::pmr::monotonic_buffer_resource resource;
+  s21::pmr::set<std::unique_ptr<int>> local(&resource);
+  s21::pmr::set<std::unique_ptr<int>> moved;
+  local.emplace(new int(4));
+  local.emplace(new int(5));
+  moved = std::move(local);
+  EXPECT_TRUE(local.empty());
+  ASSERT_EQ(moved.size(), 2U);
+  EXPECT_EQ(**moved.begin() + **moved.nth(1), 9);
+}
+
+TEST(set, InsertMovesValue) {
+  s21::set<std::string> my_set;
+  std::string value(64, 'a');
+  my_set.insert(std::move(value));
+  EXPECT_TRUE(value.empty());
+  value.assign(64, 'a');
+  EXPECT_FALSE(my_set.emplace(value).second);
+  EXPECT_EQ(my_set.size(), 1U);
+}
+
+// orders by the value modulo divisor_, so equal residues are one key
+struct ModuloLess {
+  explicit ModuloLess(int divisor = 10) : divisor_(divisor) {}
+  bool operator()(int a, int b) const { return a % divisor_ < b % divisor_; }
+  int divisor_;
+};
+
+TEST(set, CustomCompare) {
+  s21::set<int, std::greater<int>> descending = {3, 1, 4, 1, 5, 9, 2, 6};
+  EXPECT_EQ(descending.size(), 7U);
+  EXPECT_EQ(*descending.begin(), 9);
+  EXPECT_EQ(*descending.nth(6), 1);
+  EXPECT_EQ(descending.rank(4), 3U);
+
+  s21::vector<int> sorted = {9, 7, 7, 3};
+  auto from_sorted = s21::set<int, std::greater<int>>::from_sorted(
+      sorted.begin(), sorted.end());
+  EXPECT_EQ(from_sorted.size(), 3U);
+  EXPECT_EQ(*from_sorted.nth(1), 7);
+
+  s21::set<int, ModuloLess> residues(ModuloLess(7));
+  residues.insert_many(3, 10, 8, 15, 7);
+  EXPECT_EQ(residues.size(), 3U);
+  EXPECT_TRUE(residues.contains(17));
+  EXPECT_EQ(residues.key_comp().divisor_, 7);
+  s21::set<int, ModuloLess> copy(residues);
+  EXPECT_EQ(copy.key_comp().divisor_, 7);
+  s21::set<int, ModuloLess> other;
+  other.swap(copy);
+  EXPECT_EQ(other.key_comp().divisor_, 7);
+  EXPECT_EQ(copy.key_comp().divisor_, 10);
+
+  // a stateless comparator is not stored
+  EXPECT_EQ(sizeof(s21::set<int, std::greater<int>>), sizeof(s21::set<int>));
+  EXPECT_GT(sizeof(s21::set<int, ModuloLess>), sizeof(s21::set<int>));
+}
+
+// counts the calls of each kind, compare() orders two ints in one call
+struct CountingCompare {
+  bool operator()(int a, int b) const {
+    ++calls[0];
+    return a < b;
+  }
+  int compare(int a, int b) const {
+    ++calls[1];
+    return a < b ? -1 : a > b;
+  }
+  size_t *calls;
+};
+
+struct CountingLess {
+  bool operator()(int a, int b) const {
+    ++*calls;
+    return a < b;
+  }
+  size_t *calls;
+};
+
+TEST(set, OneComparisonPerLevel) {
+  const int n = 1023;
+  size_t calls[2] = {0, 0};
+  s21::set<int, CountingCompare> three_way(CountingCompare{calls});
+  for (int i = 0; i < n; ++i) three_way.insert(i * 2);
+  EXPECT_EQ(calls[0], 0U);
+
+  // about log2(n) = 10 calls a lookup, comparing both ways took 14.5
+  calls[1] = 0;
+  for (int i = 0; i < 2 * n; ++i) EXPECT_EQ(three_way.contains(i), i % 2 == 0);
+  EXPECT_EQ(calls[0], 0U);
+  EXPECT_LE(calls[1], 2U * n * 11);
+  EXPECT_FALSE(three_way.insert(6).second);
+
+  size_t less_calls = 0;
+  s21::set<int, CountingLess> less_only(CountingLess{&less_calls});
+  for (int i = 0; i < n; ++i) less_only.insert(i * 2);
+  less_calls = 0;
+  for (int i = 0; i < 2 * n; ++i) EXPECT_EQ(less_only.contains(i), i % 2 == 0);
+  EXPECT_LE(less_calls, 2U * n * 12);
+  less_calls = 0;
+  EXPECT_FALSE(less_only.insert(6).second);
+  EXPECT_TRUE(less_only.insert(7).second);
+  EXPECT_LE(less_calls, 2U * 12);
+}
+
+TEST(set, FindMany) {
+  s21::set<int> my_set;
+  s21::vector<int> keys;
+  s21::vector<s21::set<int>::iterator> found;
+  my_set.find_many(keys.begin(), keys.end(), found);
+  EXPECT_TRUE(found.empty());
+
+  for (int i = 0; i < 20; ++i) keys.push_back(i * 7 % 20);
+  my_set.find_many(keys.begin(), keys.end(), found);
+  ASSERT_EQ(found.size(), 20U);
+  for (const auto &it : found) EXPECT_TRUE(it == my_set.end());
+
+  for (int i = 0; i < 1000; i += 3) my_set.insert(i);
+  std::mt19937 rng(3);
+  keys.clear();
+  for (int i = 0; i < 500; ++i) keys.push_back(static_cast<int>(rng() % 1100));
+  for (bool ascending : {false, true}) {
+    if (ascending) std::sort(keys.begin(), keys.end());
+    s21::vector<s21::set<int>::iterator> results;
+    my_set.find_many(keys.begin(), keys.end(), results);
+    ASSERT_EQ(results.size(), keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      EXPECT_TRUE(results[i] == my_set.find(keys[i]));
+      EXPECT_EQ(results[i] != my_set.end(),
+                keys[i] % 3 == 0 && keys[i] < 1000);
+    }
+  }
+}
+
+// walks the set both ways, which follows the in-order links of
+// S21_THREADED_NODES when they are enabled
+static void ExpectOrdered(s21::set<int> &my_set, const std::set<int> &orig_set) {
+  auto my_it = my_set.begin();
+  for (int value : orig_set) EXPECT_EQ(*my_it++, value);
+  EXPECT_TRUE(my_it == my_set.end());
+  EXPECT_TRUE(++my_it == my_set.end());
+  for (auto it = orig_set.rbegin(); it != orig_set.rend(); ++it)
+    EXPECT_EQ(*--my_it, *it);
+  EXPECT_TRUE(--my_it == my_set.end());
+}
+
+TEST(set, IterationAfterEveryChange) {
+  std::mt19937 rng(11);
+  s21::set<int> my_set;
+  std::set<int> orig_set;
+  for (int i = 0; i < 300; ++i) {
+    int value = static_cast<int>(rng() % 200);
+    if (i % 3 == 2 && my_set.contains(value)) {
+      my_set.erase(my_set.find(value));
+      orig_set.erase(value);
+    } else {
+      my_set.insert(value);
+      orig_set.insert(value);
+    }
+  }
+  ExpectOrdered(my_set, orig_set);
+
+  s21::set<int> copy(my_set);
+  ExpectOrdered(copy, orig_set);
+  s21::set<int> moved(std::move(copy));
+  ExpectOrdered(moved, orig_set);
+  s21::set<int> other = {1000};
+  other.swap(moved);
+  ExpectOrdered(other, orig_set);
+  ExpectOrdered(moved, std::set<int>{1000});
+
+  s21::vector<int> sorted;
+  for (int value : orig_set) sorted.push_back(value);
+  s21::set<int> built =
+      s21::set<int>::from_sorted(sorted.begin(), sorted.end());
+  ExpectOrdered(built, orig_set);
+  for (int value : sorted) built.erase(built.find(value));
+  ExpectOrdered(built, std::set<int>());
+}
+
+TEST(set, SplitJoin) {
+  std::mt19937 rng(23);
+  for (int size : {0, 1, 2, 7, 100, 3000}) {
+    for (int round = 0; round < 20; ++round) {
+      s21::set<int> my_set;
+      std::set<int> orig_set;
+      for (int i = 0; i < size; ++i) {
+        int value = static_cast<int>(rng() % (2 * size + 1));
+        my_set.insert(value);
+        orig_set.insert(value);
+      }
+
+      int key = static_cast<int>(rng() % (2 * size + 3)) - 1;
+      s21::set<int> right = my_set.split(key);
+      std::set<int> orig_right(orig_set.lower_bound(key), orig_set.end());
+      orig_set.erase(orig_set.lower_bound(key), orig_set.end());
+      ExpectOrdered(my_set, orig_set);
+      ExpectOrdered(right, orig_right);
+      for (size_t i = 0; i < orig_right.size(); i += 7)
+        EXPECT_EQ(right.rank(*right.nth(i)), i);
+
+      // both halves go on as trees of their own
+      if (!orig_right.empty()) {
+        right.erase(right.begin());
+        orig_right.erase(orig_right.begin());
+      }
+      my_set.insert(key - 1);
+      orig_set.insert(key - 1);
+
+      my_set.join(right);
+      orig_set.insert(orig_right.begin(), orig_right.end());
+      EXPECT_TRUE(right.empty());
+      ExpectOrdered(my_set, orig_set);
+      for (size_t i = 0; i < orig_set.size(); i += 7)
+        EXPECT_EQ(my_set.rank(*my_set.nth(i)), i);
+    }
+  }
+}
+
+TEST(set, SplitOutlivesTheSource) {
+  s21::set<std::string> tail;
+  {
+    s21::set<std::string> head;
+    for (int i = 0; i < 500; ++i) head.insert(std::to_string(i));
+    tail = head.split("5");
+    EXPECT_EQ(head.size(), 445U);
+    EXPECT_EQ(*--head.end(), "499");
+  }
+  EXPECT_EQ(tail.size(), 55U);
+  EXPECT_EQ(*tail.begin(), "5");
+  for (int i = 0; i < 100; ++i) tail.insert("x" + std::to_string(i));
+  tail.erase(tail.find("77"));
+  EXPECT_EQ(tail.size(), 154U);
+
+  s21::set<std::string> low = {"a", "b"};
+  s21::set<std::string> high = {"b", "c"};
+  EXPECT_THROW(low.join(high), std::invalid_argument);
+  EXPECT_EQ(high.size(), 2U);
+  high.erase(high.begin());
+  low.join(high);
+  EXPECT_EQ(low.size(), 3U);
+  EXPECT_TRUE(high.empty());
+}
+
+// counts the bytes it has handed out and not yet been given back
+class CountingResource : public std::pmr::memory_resource {
+ public:
+  size_t Bytes() const noexcept { return bytes_; }
+
+ private:
+  void *do_allocate(size_t bytes, size_t align) override {
+    bytes_ += bytes;
+    return std::pmr::new_delete_resource()->allocate(bytes, align);
+  }
+
+  void do_deallocate(void *p, size_t bytes, size_t align) override {
+    bytes_ -= bytes;
+    std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+  }
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  size_t bytes_ = 0;
+};
+
+TEST(set, SplitJoinReusesMemory) {
+  CountingResource resource;
+  s21::pmr::set<int> my_set(&resource);
+  for (int i = 0; i < 10000; ++i) my_set.insert(2 * i);
+
+  // both halves take nodes and give them back between a split and a join,
+  // which the later rounds reuse
+  size_t bytes = 0;
+  for (int round = 0; round < 2000; ++round) {
+    {
+      const int key = 2 * (round * 7919 % 10000);
+      s21::pmr::set<int> right = my_set.split(key);
+      for (int i = 1; i < 8; i += 2) {
+        right.insert(key + i);
+        my_set.insert(key - i);
+      }
+      for (int i = 1; i < 8; i += 2) {
+        right.erase(right.find(key + i));
+        my_set.erase(my_set.find(key - i));
+      }
+      my_set.join(right);
+    }
+    if (round == 100) bytes = resource.Bytes();
+  }
+  EXPECT_EQ(my_set.size(), 10000U);
+  // the lists of chunks, whose capacities depend on which part kept the
+  // pool, vary a little, while nodes leaked on each round would add up
+  EXPECT_LT(resource.Bytes(), bytes + bytes / 10);
+}
+
+TEST(set, SplitOffPartKeepsOnlyItsMemory) {
+  CountingResource resource;
+  for (bool tailIsSmall : {true, false}) {
+    s21::pmr::set<int> part(&resource);
+    size_t full = 0;
+    {
+      s21::pmr::set<int> my_set(&resource);
+      for (int i = 0; i < 100000; ++i) my_set.insert(i);
+      full = resource.Bytes();
+      s21::pmr::set<int> tail = my_set.split(tailIsSmall ? 99999 : 1);
+      part = std::move(tailIsSmall ? tail : my_set);
+    }
+
+    EXPECT_EQ(part.size(), 1U);
+#ifndef S21_INDEX_NODES
+    // the chunks of the larger part went with it
+    EXPECT_LT(resource.Bytes(), full / 10);
+#endif
+    (void)full;
+    for (int i = 0; i < 100; ++i) part.insert(2 * i);
+    EXPECT_EQ(part.size(), tailIsSmall ? 101U : 100U);
+  }
+  EXPECT_EQ(resource.Bytes(), 0U);
+}
+
+TEST(set, SetAlgebra) {
+  std::mt19937 rng(23);
+  // equal sizes are merged, the skewed ones searched in the larger set,
+  // and the last pair is large enough to be cut between threads
+  const std::pair<int, int> sizes[] = {{0, 0},         {0, 50},
+                                       {700, 1000},    {100000, 100},
+                                       {100, 100000},  {3000, 40},
+                                       {300000, 300000}};
+  for (const auto &[aSize, bSize] : sizes) {
+    s21::set<int> a, b;
+    std::set<int> origA, origB;
+    const int range = 2 * std::max(aSize, bSize) + 1;
+    for (int i = 0; i < aSize; ++i) {
+      int value = static_cast<int>(rng() % range);
+      a.insert(value);
+      origA.insert(value);
+    }
+    for (int i = 0; i < bSize; ++i) {
+      int value = static_cast<int>(rng() % range);
+      b.insert(value);
+      origB.insert(value);
+    }
+
+    for (size_t threads : {1, 4}) {
+      std::vector<int> expected;
+      std::set_union(origA.begin(), origA.end(), origB.begin(), origB.end(),
+                     std::back_inserter(expected));
+      s21::set<int> result = a.union_with(b, threads);
+      ASSERT_EQ(result.size(), expected.size());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+      expected.clear();
+      std::set_intersection(origA.begin(), origA.end(), origB.begin(),
+                            origB.end(), std::back_inserter(expected));
+      result = a.intersection_with(b, threads);
+      ASSERT_EQ(result.size(), expected.size());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+
+      expected.clear();
+      std::set_difference(origA.begin(), origA.end(), origB.begin(),
+                          origB.end(), std::back_inserter(expected));
+      result = a.difference_with(b, threads);
+      ASSERT_EQ(result.size(), expected.size());
+      EXPECT_TRUE(std::equal(expected.begin(), expected.end(), result.begin()));
+    }
+    // the operands stay as they were
+    EXPECT_EQ(a.size(), origA.size());
+    EXPECT_EQ(b.size(), origB.size());
+  }
+
+  // the result is a set of its own that takes further changes
+  s21::set<std::string> small = {"b", "x"};
+  s21::set<std::string> large;
+  for (int i = 0; i < 1000; ++i) large.insert(std::to_string(i));
+  s21::set<std::string> both = large.union_with(small);
+  both.erase(both.find("b"));
+  both.insert("c");
+  EXPECT_EQ(both.size(), 1002U);
+  EXPECT_TRUE(large.intersection_with(small).empty());
+  EXPECT_EQ(small.difference_with(large).size(), 2U);
+}
+
+TEST(set, ExtractInsert) {
+  s21::set<std::string> my_set = {"a", "b", "c"};
+  s21::set<std::string>::node_type node = my_set.extract("b");
+  EXPECT_FALSE(node.empty());
+  EXPECT_EQ(my_set.size(), 2U);
+  EXPECT_TRUE(my_set.extract("z").empty());
+
+  // the key may change while the node is out of the set
+  node.value() = "d";
+  const std::string *held = &node.value();
+  auto result = my_set.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_TRUE(result.node.empty());
+  EXPECT_EQ(*result.position, "d");
+  EXPECT_EQ(*--my_set.end(), "d");
+#ifndef S21_INDEX_NODES
+  // the value stays where it was, in its own node
+  EXPECT_EQ(&*result.position, held);
+#endif
+  (void)held;
+
+  // an equal key leaves the node with the caller
+  node = my_set.extract(my_set.begin());
+  node.value() = "c";
+  result = my_set.insert(std::move(node));
+  EXPECT_FALSE(result.inserted);
+  EXPECT_EQ(result.node.value(), "c");
+  EXPECT_EQ(*result.position, "c");
+  EXPECT_EQ(my_set.size(), 2U);
+
+  s21::set<std::string> other = {"x"};
+  result.node.value() = "a";
+  auto it = other.insert(other.begin(), std::move(result.node));
+  EXPECT_EQ(*it, "a");
+  EXPECT_EQ(*other.begin(), "a");
+  EXPECT_EQ(other.size(), 2U);
+
+  s21::set<std::string>::node_type empty;
+  result = my_set.insert(std::move(empty));
+  EXPECT_FALSE(result.inserted);
+  EXPECT_TRUE(result.position == my_set.end());
+}
+
+TEST(set, NodeOutlivesTheSource) {
+  s21::set<std::string>::node_type node;
+  {
+    s21::set<std::string> source;
+    for (int i = 0; i < 300; ++i) source.insert(std::to_string(i));
+    node = source.extract("150");
+    // nodes dropped with their handles are taken again by the source
+    for (int i = 0; i < 1000; ++i) {
+      auto dropped = source.extract(source.begin());
+      source.insert("y" + std::to_string(i));
+    }
+    EXPECT_EQ(source.size(), 299U);
+  }
+  EXPECT_EQ(node.value(), "150");
+
+  s21::set<std::string> target;
+  for (int i = 0; i < 100; ++i) target.insert("x" + std::to_string(i));
+  target.insert(std::move(node));
+  EXPECT_TRUE(node.empty());
+  for (int i = 0; i < 100; i += 2)
+    target.erase(target.find("x" + std::to_string(i)));
+  EXPECT_EQ(target.size(), 51U);
+  EXPECT_EQ(*target.begin(), "150");
+}
+
+TEST(set, ExtractAcrossAllocators) {
+  std::pmr::unsynchronized_pool_resource first, second;
+  s21::pmr::set<int> my_set({1, 2, 3}, &first);
+  s21::pmr::set<int> other({5}, &second);
+
+  auto node = my_set.extract(2);
+  EXPECT_TRUE(node.get_allocator().resource() == &first);
+  auto result = other.insert(std::move(node));
+  EXPECT_TRUE(result.inserted);
+  EXPECT_EQ(*other.begin(), 2);
+
+  other.merge(my_set);
+  EXPECT_TRUE(my_set.empty());
+  EXPECT_EQ(other.size(), 4U);
+  EXPECT_EQ(*--other.end(), 5);
+}
+
+TEST(set, MergeMatchesStd) {
+  std::mt19937 rng(24);
+  for (int size : {0, 1, 10, 1000}) {
+    s21::set<int> my_set, my_other;
+    std::set<int> orig_set, orig_other;
+    for (int i = 0; i < size; ++i) {
+      int value = static_cast<int>(rng() % (2 * size));
+      my_set.insert(value);
+      orig_set.insert(value);
+      value = static_cast<int>(rng() % (2 * size));
+      my_other.insert(value);
+      orig_other.insert(value);
+    }
+
+    my_set.merge(my_other);
+    orig_set.merge(orig_other);
+    ExpectOrdered(my_set, orig_set);
+    ExpectOrdered(my_other, orig_other);
+
+    // both go on as trees of their own
+    for (int i = 0; i < size; ++i) {
+      my_set.erase(my_set.find(*my_set.nth(my_set.size() / 2)));
+      my_other.insert(-i - 1);
+    }
+    EXPECT_EQ(my_set.size(), orig_set.size() - size);
+    EXPECT_EQ(my_other.size(), orig_other.size() + size);
+  }
+}
+
+// throws on the call after the first limit ones
+struct ThrowingLess {
+  bool operator()(int a, int b) const {
+    if (!(*limit)--) throw std::runtime_error("compare");
+    return a < b;
+  }
+  int *limit;
+};
+
+TEST(set, MergeThrowingCompare) {
+  int limit = -1;
+  ThrowingLess comp{&limit};
+  s21::set<int, ThrowingLess> my_set(comp);
+  s21::set<int, ThrowingLess> my_other(comp);
+  for (int i = 0; i < 1000; ++i) {
+    my_set.insert(2 * i);
+    my_other.insert(3 * i);
+  }
+
+  // a merge stopped halfway leaves two valid sets with every value
+  limit = 900;
+  EXPECT_THROW(my_set.merge(my_other), std::runtime_error);
+  limit = -1;
+#ifndef S21_INDEX_NODES
+  // the nodes are only relinked once every comparison is made
+  EXPECT_EQ(my_set.size(), 1000U);
+#endif
+  EXPECT_EQ(my_set.size() + my_other.size(), 2000U);
+  for (size_t i = 0; i + 1 < my_set.size(); i += 7)
+    EXPECT_LT(*my_set.nth(i), *my_set.nth(i + 1));
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_TRUE(my_set.contains(3 * i) || my_other.contains(3 * i));
+
+  my_set.merge(my_other);
+  EXPECT_EQ(my_set.size(), 1666U);
+  EXPECT_EQ(my_other.size(), 334U);
+  EXPECT_EQ(my_set.rank(1500), 1000U);
+}
@@ -4,30 +4,38 @@
 #include <cstdlib>
 #include <initializer_list>
 #include <memory>
+#include <memory_resource>
 #include <new>
 #include <stdexcept>
 #include <utility>
 
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
  public:
   RawMemory() = default;
 
-  explicit RawMemory(size_t capacity)
-      : buffer_(Allocate(capacity)), capacity_(capacity) {}
+  explicit RawMemory(const Allocator &alloc) : alloc_(alloc) {}
+
+  explicit RawMemory(size_t capacity, const Allocator &alloc = Allocator())
+      : alloc_(alloc), buffer_(Allocate(capacity)), capacity_(capacity) {}
 
   ~RawMemory() { Deallocate(buffer_); }
 
   RawMemory(const RawMemory &) = delete;
   RawMemory &operator=(const RawMemory &rhs) = delete;
 
-  RawMemory(RawMemory &&other) noexcept {
+  RawMemory(RawMemory &&other) noexcept : alloc_(std::move(other.alloc_)) {
     buffer_ = std::exchange(other.buffer_, nullptr);
     capacity_ = std::exchange(other.capacity_, 0);
   }
 
+  // the allocators must be equal unless the allocator propagates on move
   RawMemory &operator=(RawMemory &&rhs) noexcept {
     Deallocate(buffer_);
+    if constexpr (AllocTraits::propagate_on_container_move_assignment::value)
+      alloc_ = std::move(rhs.alloc_);
     buffer_ = std::exchange(rhs.buffer_, nullptr);
     capacity_ = std::exchange(rhs.capacity_, 0);
     return *this;
@@ -54,10 +62,16 @@ class RawMemory {
   }
 
   void Swap(RawMemory &other) noexcept {
+    if constexpr (AllocTraits::propagate_on_container_swap::value) {
+      using std::swap;
+      swap(alloc_, other.alloc_);
+    }
     std::swap(buffer_, other.buffer_);
     std::swap(capacity_, other.capacity_);
   }
 
+  const Allocator &GetAllocator() const noexcept { return alloc_; }
+
   const T *GetAddress() const noexcept { return buffer_; }
 
   T *GetAddress() noexcept { return buffer_; }
@@ -66,33 +80,43 @@ class RawMemory {
 
  private:
   // Выделяет сырую память под n элементов и возвращает указатель на неё
-  static T *Allocate(size_t n) {
-    return n != 0 ? static_cast<T *>(operator new(n * sizeof(T))) : nullptr;
+  T *Allocate(size_t n) {
+    return n != 0 ? AllocTraits::allocate(alloc_, n) : nullptr;
   }
 
   // Освобождает сырую память, выделенную ранее по адресу buf при помощи
   // Allocate
-  static void Deallocate(T *buf) noexcept { operator delete(buf); }
+  void Deallocate(T *buf) noexcept {
+    if (buf) AllocTraits::deallocate(alloc_, buf, capacity_);
+  }
 
+  Allocator alloc_;
   T *buffer_ = nullptr;
   size_t capacity_ = 0;
 };
 
 namespace s21 {
-template <typename T>
+template <typename T, typename Allocator = std::allocator<T>>
 class vector {
+  using AllocTraits = std::allocator_traits<Allocator>;
+
  public:
+  using allocator_type = Allocator;
+
   vector() = default;
 
-  explicit vector(size_t size)
-      : data_(size),
+  explicit vector(const Allocator &alloc) : data_(alloc) {}
+
+  explicit vector(size_t size, const Allocator &alloc = Allocator())
+      : data_(size, alloc),
         size_(size)  //
   {
     std::uninitialized_value_construct_n(begin(), size);
   }
 
-  vector(std::initializer_list<T> const &items)
-      : data_(items.size()),
+  vector(std::initializer_list<T> const &items,
+         const Allocator &alloc = Allocator())
+      : data_(items.size(), alloc),
         size_(items.size())  //
   {
     std::uninitialized_value_construct_n(begin(), size_);
@@ -103,7 +127,11 @@ class vector {
   }
 
   vector(const vector &other)
-      : data_(other.size_),
+      : vector(other, AllocTraits::select_on_container_copy_construction(
+                          other.get_allocator())) {}
+
+  vector(const vector &other, const Allocator &alloc)
+      : data_(other.size_, alloc),
         size_(other.size_)  //
   {
     std::uninitialized_copy_n(other.begin(), other.size_, begin());
@@ -114,6 +142,10 @@ class vector {
 
   ~vector() { std::destroy_n(begin(), size_); }
 
+  allocator_type get_allocator() const noexcept {
+    return data_.GetAllocator();
+  }
+
   using iterator = T *;
   using const_iterator = const T *;
 
@@ -132,7 +164,7 @@ class vector {
   vector &operator=(const vector &rhs) {
     if (this != &rhs) {
       if (rhs.size_ > data_.Capacity()) {
-        vector rhs_copy(rhs);
+        vector rhs_copy(rhs, get_allocator());
         swap(rhs_copy);
       } else {
         size_t copy_size = std::min(rhs.size_, size_);
@@ -149,10 +181,23 @@ class vector {
     return *this;
   }
 
-  vector &operator=(vector &&rhs) noexcept {
+  vector &operator=(vector &&rhs) noexcept(
+      AllocTraits::propagate_on_container_move_assignment::value ||
+      AllocTraits::is_always_equal::value) {
     if (this != &rhs) {
-      data_ = std::move(rhs.data_);
-      size_ = std::exchange(rhs.size_, 0);
+      if (AllocTraits::propagate_on_container_move_assignment::value ||
+          get_allocator() == rhs.get_allocator()) {
+        std::destroy_n(begin(), size_);
+        data_ = std::move(rhs.data_);
+        size_ = std::exchange(rhs.size_, 0);
+      } else {
+        // foreign memory can not be adopted, so the elements are moved
+        vector moved(get_allocator());
+        moved.reserve(rhs.size_);
+        for (T &value : rhs) moved.push_back(std::move(value));
+        swap(moved);
+        rhs.resize(0);
+      }
     }
     return *this;
   }
@@ -163,7 +208,7 @@ class vector {
     if (new_capacity <= data_.Capacity()) {
       return;
     }
-    RawMemory<T> new_data(new_capacity);
+    RawMemory<T, Allocator> new_data(new_capacity, get_allocator());
     InitializeWithCopyMoveUninitializedN(begin(), size_, new_data.GetAddress());
     std::destroy_n(begin(), size_);
     data_.Swap(new_data);
@@ -185,7 +230,7 @@ class vector {
 
   void shrink_to_fit() {
     if (data_.Capacity() > size_) {
-      RawMemory<T> new_data(size_);
+      RawMemory<T, Allocator> new_data(size_, get_allocator());
       InitializeWithCopyMoveUninitializedN(begin(), size_,
                                            new_data.GetAddress());
       std::destroy_n(begin(), size_);
@@ -196,7 +241,8 @@ class vector {
   template <typename... Args>
   T &emplace_back(Args &&...args) {
     if (size_ == capacity()) {
-      RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+      RawMemory<T, Allocator> new_data(size_ == 0 ? 1 : size_ * 2,
+                                       get_allocator());
       new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
       InitializeWithCopyMoveUninitializedN(begin(), size_,
                                            new_data.GetAddress());
@@ -323,7 +369,8 @@ class vector {
 
   template <typename... Args>
   void EmplaceFilledVector(size_t iter, Args &&...args) {
-    RawMemory<T> new_data(size_ == 0 ? 1 : size_ * 2);
+    RawMemory<T, Allocator> new_data(size_ == 0 ? 1 : size_ * 2,
+                                     get_allocator());
     new (new_data.GetAddress() + iter) T(std::forward<Args>(args)...);
     try {
       InitializeWithCopyMoveUninitializedN(begin(), iter,
@@ -361,7 +408,12 @@ class vector {
     }
   }
 
-  RawMemory<T> data_;
+  RawMemory<T, Allocator> data_;
   size_t size_ = 0;
 };
+
+namespace pmr {
+template <typename T>
+using vector = s21::vector<T, std::pmr::polymorphic_allocator<T>>;
+}  // namespace pmr
 }  // namespace s21
@@ -235,3 +235,20 @@ TEST(vector, Erase) {
 
   EXPECT_EQ(t.front(), 2);
 }
+
+TEST(vector, PolymorphicAllocator) {
+  alignas(std::max_align_t) unsigned char buffer[4096];
+  std::pmr::monotonic_buffer_resource resource(
+      buffer, sizeof(buffer), std::pmr::null_memory_resource());
+
+  s21::pmr::vector<int> t(&resource);
+  for (int i = 0; i < 100; ++i) t.push_back(i);
+  EXPECT_EQ(t.size(), 100U);
+  EXPECT_EQ(t[99], 99);
+  EXPECT_TRUE(t.get_allocator().resource() == &resource);
+
+  s21::pmr::vector<int> moved = std::move(t);
+  EXPECT_EQ(moved.size(), 100U);
+  EXPECT_TRUE(moved.get_allocator().resource() == &resource);
+  EXPECT_THROW(moved.reserve(100000), std::bad_alloc);
+}
@@ -3,6 +3,9 @@
 #include "s21_setTests.h"
 #include "s21_vectorTests.h"
 #include "s21_arrayTests.h"
+#include "s21_btreeTests.h"
+#include "s21_flatTests.h"
+#include "s21_frozenTests.h"
 
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);